@@ -0,0 +1,197 @@
+// Copyright 2023 Seoul National University
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "band/admission_controller.h"
+
+#include <algorithm>
+
+#include "band/time.h"
+#include "band/worker.h"
+
+namespace band {
+
+AdmissionController::AdmissionController(IEngine& engine) : engine_(engine) {}
+
+void AdmissionController::Init(SheddingPolicy policy,
+                               int max_pending_jobs_per_model) {
+  policy_ = policy;
+  max_pending_jobs_per_model_ = max_pending_jobs_per_model;
+}
+
+void AdmissionController::SetModelQuota(ModelId model_id,
+                                        int max_pending_jobs) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  model_quotas_[model_id] = max_pending_jobs;
+}
+
+std::vector<JobStatus> AdmissionController::Admit(
+    const std::vector<Job>& jobs, std::map<JobId, JobStatus>& dropped_jobs) {
+  std::vector<JobStatus> statuses(jobs.size(), JobStatus::kQueued);
+  if (!IsEnabled() || jobs.empty()) {
+    return statuses;
+  }
+
+  // Estimate outside the lock, as workers and the latency estimator have
+  // their own locks
+  const size_t num_workers = engine_.GetNumWorkers();
+  std::vector<int64_t> waiting_times(num_workers, 0);
+  for (WorkerId worker_id = 0; worker_id < num_workers; worker_id++) {
+    Worker* worker = engine_.GetWorker(worker_id);
+    if (worker) {
+      waiting_times[worker_id] = worker->GetWaitingTime();
+    }
+  }
+
+  struct Estimate {
+    // Time until the earliest available worker finishes the job
+    int64_t finish_time = -1;
+    // Latency on the fastest worker
+    int64_t latency = 0;
+  };
+  std::map<ModelId, Estimate> estimates;
+  for (const Job& job : jobs) {
+    if (estimates.find(job.model_id) != estimates.end()) {
+      continue;
+    }
+    Estimate& estimate = estimates[job.model_id];
+    for (WorkerId worker_id = 0; worker_id < num_workers; worker_id++) {
+      const SubgraphKey key =
+          engine_.GetLargestSubgraphKey(job.model_id, worker_id);
+      if (!key.IsValid()) {
+        continue;
+      }
+      const int64_t latency = std::max<int64_t>(engine_.GetExpected(key), 0);
+      const int64_t finish_time = waiting_times[worker_id] + latency;
+      if (estimate.finish_time < 0 || finish_time < estimate.finish_time) {
+        estimate.finish_time = finish_time;
+      }
+      if (estimate.latency == 0 || latency < estimate.latency) {
+        estimate.latency = latency;
+      }
+    }
+  }
+
+  const int64_t current_time = time::NowMicros();
+  const int64_t num_parallel = std::max<int64_t>(num_workers, 1);
+
+  std::lock_guard<std::mutex> lock(mtx_);
+  for (size_t i = 0; i < jobs.size(); i++) {
+    const Job& job = jobs[i];
+    const Estimate& estimate = estimates[job.model_id];
+
+    const int quota = GetQuota(job.model_id);
+    if (quota > 0 && num_pending_jobs_[job.model_id] >= quota) {
+      if (policy_ != SheddingPolicy::kDropOldest) {
+        statuses[i] = JobStatus::kRejected;
+        continue;
+      }
+      // Running jobs cannot be dropped
+      auto oldest_it = std::find_if(
+          pending_jobs_.begin(), pending_jobs_.end(),
+          [&job](const std::pair<const JobId, PendingJob>& pending_job) {
+            return pending_job.second.model_id == job.model_id &&
+                   !pending_job.second.is_dispatched;
+          });
+      if (oldest_it == pending_jobs_.end()) {
+        statuses[i] = JobStatus::kRejected;
+        continue;
+      }
+      dropped_jobs[oldest_it->first] = JobStatus::kRejected;
+      Drop(oldest_it);
+    }
+
+    if (job.slo_us > 0 && estimate.finish_time >= 0) {
+      const int64_t deadline = job.enqueue_time + job.slo_us;
+      auto get_expected_finish_time = [&]() {
+        return current_time + estimate.finish_time +
+               queued_latency_us_ / num_parallel;
+      };
+      if (policy_ == SheddingPolicy::kDropOldest) {
+        // Make room with the queued jobs that miss their SLO anyway
+        auto it = pending_jobs_.begin();
+        while (it != pending_jobs_.end() &&
+               get_expected_finish_time() > deadline) {
+          const PendingJob& pending_job = it->second;
+          if (!pending_job.is_dispatched && pending_job.deadline > 0 &&
+              current_time + pending_job.expected_latency >
+                  pending_job.deadline) {
+            dropped_jobs[it->first] = JobStatus::kSLOViolation;
+            it = Drop(it);
+          } else {
+            ++it;
+          }
+        }
+      }
+      if (get_expected_finish_time() > deadline) {
+        statuses[i] = JobStatus::kSLOViolation;
+        continue;
+      }
+    }
+
+    PendingJob& pending_job = pending_jobs_[job.job_id];
+    pending_job.model_id = job.model_id;
+    pending_job.deadline = job.slo_us > 0 ? job.enqueue_time + job.slo_us : 0;
+    pending_job.expected_latency = estimate.latency;
+    pending_job.is_dispatched = false;
+    num_pending_jobs_[job.model_id]++;
+    queued_latency_us_ += pending_job.expected_latency;
+  }
+  return statuses;
+}
+
+void AdmissionController::OnDispatched(JobId job_id) {
+  if (!IsEnabled()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto it = pending_jobs_.find(job_id);
+  if (it != pending_jobs_.end() && !it->second.is_dispatched) {
+    it->second.is_dispatched = true;
+    queued_latency_us_ -= it->second.expected_latency;
+  }
+}
+
+void AdmissionController::OnFinished(JobId job_id) {
+  if (!IsEnabled()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto it = pending_jobs_.find(job_id);
+  if (it != pending_jobs_.end()) {
+    Drop(it);
+  }
+}
+
+int64_t AdmissionController::GetQueuedLatency() const {
+  std::lock_guard<std::mutex> lock(mtx_);
+  return queued_latency_us_;
+}
+
+int AdmissionController::GetQuota(ModelId model_id) const {
+  auto it = model_quotas_.find(model_id);
+  return it != model_quotas_.end() ? it->second : max_pending_jobs_per_model_;
+}
+
+std::map<JobId, AdmissionController::PendingJob>::iterator
+AdmissionController::Drop(std::map<JobId, PendingJob>::iterator it) {
+  if (!it->second.is_dispatched) {
+    queued_latency_us_ -= it->second.expected_latency;
+  }
+  if (--num_pending_jobs_[it->second.model_id] == 0) {
+    num_pending_jobs_.erase(it->second.model_id);
+  }
+  return pending_jobs_.erase(it);
+}
+
+}  // namespace band
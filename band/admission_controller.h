@@ -0,0 +1,85 @@
+/*
+ * Copyright 2023 Seoul National University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BAND_ADMISSION_CONTROLLER_H_
+#define BAND_ADMISSION_CONTROLLER_H_
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "band/common.h"
+#include "band/engine_interface.h"
+
+namespace band {
+
+// Decides at enqueue time whether a request can still be served in time, so
+// that an overloaded engine fails fast instead of queueing doomed work.
+// A request is expected to finish after the earliest available worker runs
+// it, plus the requests admitted before it that are not dispatched yet,
+// spread over the workers. Requests beyond the quota of their model are shed
+// as well. Thread-safe.
+class AdmissionController {
+ public:
+  explicit AdmissionController(IEngine& engine);
+
+  void Init(SheddingPolicy policy, int max_pending_jobs_per_model);
+  bool IsEnabled() const { return policy_ != SheddingPolicy::kNone; }
+  // Overrides the maximum number of unfinished requests of the model.
+  // -1 for unlimited.
+  void SetModelQuota(ModelId model_id, int max_pending_jobs);
+
+  // Decides the admission of new jobs with their ids assigned. Returns
+  // `JobStatus::kQueued` for an admitted job, or the status to finish a shed
+  // job with. Admitted jobs that are dropped in favor of the new ones are
+  // added to `dropped_jobs`.
+  std::vector<JobStatus> Admit(const std::vector<Job>& jobs,
+                               std::map<JobId, JobStatus>& dropped_jobs);
+  // The job is handed to a worker.
+  void OnDispatched(JobId job_id);
+  void OnFinished(JobId job_id);
+
+  // Sum of the expected latency of the admitted jobs not dispatched yet.
+  int64_t GetQueuedLatency() const;
+
+ private:
+  struct PendingJob {
+    ModelId model_id;
+    int64_t deadline;
+    // Expected latency on the fastest worker
+    int64_t expected_latency;
+    bool is_dispatched;
+  };
+
+  int GetQuota(ModelId model_id) const;
+  std::map<JobId, PendingJob>::iterator Drop(
+      std::map<JobId, PendingJob>::iterator it);
+
+  IEngine& engine_;
+  SheddingPolicy policy_ = SheddingPolicy::kNone;
+  int max_pending_jobs_per_model_ = -1;
+
+  mutable std::mutex mtx_;
+  std::map<ModelId, int> model_quotas_;
+  // Admitted and unfinished jobs, in the order of submission by job id
+  std::map<JobId, PendingJob> pending_jobs_;
+  std::map<ModelId, int> num_pending_jobs_;
+  int64_t queued_latency_us_ = 0;
+};
+
+}  // namespace band
+
+#endif  // BAND_ADMISSION_CONTROLLER_H_
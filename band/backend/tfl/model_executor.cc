@@ -36,6 +36,7 @@
 #include "absl/strings/str_format.h"
 #include "tensorflow/lite/interpreter_builder.h"
 #include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/util.h"
 
 namespace band {
 namespace tfl {
@@ -232,6 +233,144 @@ std::shared_ptr<interface::ITensorView> TfLiteModelExecutor::GetTensorView(
   return std::make_shared<TfLiteTensorView>(GetInterpreter(key)->tensor(index));
 }
 
+absl::Status TfLiteModelExecutor::BindInputTensor(
+    const SubgraphKey& key, int index, const interface::ITensor* src) {
+  tflite::Interpreter* interpreter = GetInterpreter(key);
+  if (!interpreter || !src) {
+    return absl::InternalError("Cannot find subgraph or source tensor");
+  }
+
+  TfLiteTensor* tensor = interpreter->tensor(index);
+  if (!tensor || tensor->bytes != src->GetBytes() ||
+      GetBandDataType(tensor->type) != src->GetType()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Cannot bind tensor %s to input %d of %s: type or size mismatch",
+        src->GetName(), index, key.ToString().c_str()));
+  }
+
+  const char* data = src->GetData();
+  if (reinterpret_cast<uintptr_t>(data) % tflite::kDefaultTensorAlignment !=
+      0) {
+    return absl::FailedPreconditionError(absl::StrFormat(
+        "Cannot bind tensor %s: data is not aligned to %d bytes",
+        src->GetName(), tflite::kDefaultTensorAlignment));
+  }
+
+  std::map<int, InputStorage>& storages = input_storages_[key];
+  if (storages.find(index) == storages.end()) {
+    InputStorage storage;
+    storage.Allocate(tensor->bytes);
+    storages.emplace(index, std::move(storage));
+  }
+
+  // Input tensors are read-only during the invoke.
+  TfLiteCustomAllocation allocation = {const_cast<char*>(data), tensor->bytes};
+  if (interpreter->SetCustomAllocationForTensor(index, allocation) !=
+      kTfLiteOk) {
+    return absl::InternalError(absl::StrFormat(
+        "Failed to bind tensor %s to input %d", src->GetName(), index));
+  }
+  bound_inputs_[key].insert(index);
+  // A custom allocation takes effect once the tensors are allocated again
+  if (interpreter->AllocateTensors() != kTfLiteOk) {
+    // Back to the private storage, the caller copies instead
+    interpreter->SetCustomAllocationForTensor(index,
+                                              storages.at(index).allocation);
+    bound_inputs_[key].erase(index);
+    return absl::InternalError(absl::StrFormat(
+        "Failed to allocate %s after binding input %d", key.ToString(),
+        index));
+  }
+  return absl::OkStatus();
+}
+
+void TfLiteModelExecutor::InputStorage::Allocate(size_t bytes) {
+  buffer.reset(new char[bytes + tflite::kDefaultTensorAlignment]);
+  uintptr_t address = reinterpret_cast<uintptr_t>(buffer.get());
+  address = (address + tflite::kDefaultTensorAlignment - 1) &
+            ~static_cast<uintptr_t>(tflite::kDefaultTensorAlignment - 1);
+  allocation = {reinterpret_cast<void*>(address), bytes};
+}
+
+absl::Status TfLiteModelExecutor::ReleaseInputTensors(const SubgraphKey& key) {
+  auto it = bound_inputs_.find(key);
+  if (it == bound_inputs_.end() || it->second.empty()) {
+    return absl::OkStatus();
+  }
+
+  tflite::Interpreter* interpreter = GetInterpreter(key);
+  const std::map<int, InputStorage>& storages = input_storages_[key];
+  absl::Status status = absl::OkStatus();
+  for (int index : it->second) {
+    if (interpreter->SetCustomAllocationForTensor(
+            index, storages.at(index).allocation) != kTfLiteOk) {
+      status = absl::InternalError(
+          absl::StrFormat("Failed to release input tensor %d", index));
+    }
+  }
+  it->second.clear();
+  if (interpreter->AllocateTensors() != kTfLiteOk) {
+    status = absl::InternalError(absl::StrFormat(
+        "Failed to allocate %s after releasing inputs", key.ToString()));
+  }
+  return status;
+}
+
+absl::Status TfLiteModelExecutor::ResizeBatch(const SubgraphKey& key,
+                                              int batch_size) {
+  auto batch_size_it = batch_sizes_.find(key);
+  const int current_batch_size =
+      batch_size_it == batch_sizes_.end() ? 1 : batch_size_it->second;
+  if (current_batch_size == batch_size) {
+    return absl::OkStatus();
+  }
+
+  tflite::Interpreter* interpreter = GetInterpreter(key);
+  if (!interpreter || batch_size <= 0) {
+    return absl::InternalError(absl::StrFormat(
+        "Cannot resize %s to batch size %d", key.ToString(), batch_size));
+  }
+
+  for (int index : interpreter->inputs()) {
+    const TfLiteTensor* tensor = interpreter->tensor(index);
+    if (tensor->dims->size == 0 ||
+        tensor->dims->data[0] != current_batch_size) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Input %d of %s has no leading batch dimension", index,
+          key.ToString()));
+    }
+    std::vector<int> dims(tensor->dims->data,
+                          tensor->dims->data + tensor->dims->size);
+    dims[0] = batch_size;
+    if (interpreter->ResizeInputTensor(index, dims) != kTfLiteOk) {
+      return absl::InternalError(absl::StrFormat(
+          "Failed to resize input %d of %s", index, key.ToString()));
+    }
+
+    // Private storage of a bound input should follow the new size
+    auto storage_it = input_storages_[key].find(index);
+    if (storage_it != input_storages_[key].end()) {
+      InputStorage& storage = storage_it->second;
+      storage.Allocate(storage.allocation.bytes / current_batch_size *
+                       batch_size);
+      if (interpreter->SetCustomAllocationForTensor(
+              index, storage.allocation) != kTfLiteOk) {
+        return absl::InternalError(absl::StrFormat(
+            "Failed to resize storage of input %d of %s", index,
+            key.ToString()));
+      }
+    }
+  }
+
+  if (interpreter->AllocateTensors() != kTfLiteOk) {
+    return absl::InternalError(absl::StrFormat(
+        "Failed to allocate %s with batch size %d", key.ToString(),
+        batch_size));
+  }
+  batch_sizes_[key] = batch_size;
+  return absl::OkStatus();
+}
+
 SubgraphKey TfLiteModelExecutor::GetLargestSubgraphKey() const {
   SubgraphKey largest_key;
   size_t largest_num_ops = 0;
@@ -255,6 +394,11 @@ absl::Status TfLiteModelExecutor::ExecuteSubgraph(const SubgraphKey& key) {
     return absl::InternalError("Cannot find subgraph");
   }
   absl::Status status = GetBandStatus(interpreters_[key]->Invoke());
+  // Caller memory must not be referenced after the execution
+  absl::Status release_status = ReleaseInputTensors(key);
+  if (!release_status.ok()) {
+    BAND_LOG(LogSeverity::kError, "%s", release_status.ToString().c_str());
+  }
   return status;
 }
 
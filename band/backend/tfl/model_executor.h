@@ -17,6 +17,9 @@
 #ifndef BAND_BACKEND_TFL_MODEL_EXECUTOR_H_
 #define BAND_BACKEND_TFL_MODEL_EXECUTOR_H_
 
+#include <map>
+#include <set>
+
 #include "band/interface/model_executor.h"
 #include "tensorflow/lite/interpreter.h"
 
@@ -42,6 +45,11 @@ class TfLiteModelExecutor : public interface::IModelExecutor {
 
   std::shared_ptr<interface::ITensorView> GetTensorView(const SubgraphKey& key,
                                                         int index) override;
+  absl::Status BindInputTensor(const SubgraphKey& key, int index,
+                               const interface::ITensor* src) override;
+  // Restore input tensors bound by `BindInputTensor` to private storages.
+  absl::Status ReleaseInputTensors(const SubgraphKey& key) override;
+  absl::Status ResizeBatch(const SubgraphKey& key, int batch_size) override;
   SubgraphKey GetLargestSubgraphKey() const override;
   bool HasSubgraph(const SubgraphKey& key) const override;
 
@@ -60,9 +68,25 @@ class TfLiteModelExecutor : public interface::IModelExecutor {
       std::set<int> op_indices = {});
   static absl::StatusOr<TfLiteDelegate*> GetDeviceDelegate(DeviceFlag device);
 
+  // Private storage for an input tensor that has been bound to caller memory
+  // at least once, since the original arena memory is no longer reserved for
+  // the tensor once it is switched to a custom allocation.
+  struct InputStorage {
+    // Allocate an aligned buffer of `bytes`
+    void Allocate(size_t bytes);
+
+    std::unique_ptr<char[]> buffer;
+    TfLiteCustomAllocation allocation;
+  };
+
   std::unordered_map<SubgraphKey, std::unique_ptr<tflite::Interpreter>,
                      SubgraphHash>
       interpreters_;
+  std::unordered_map<SubgraphKey, std::map<int, InputStorage>, SubgraphHash>
+      input_storages_;
+  std::unordered_map<SubgraphKey, std::set<int>, SubgraphHash> bound_inputs_;
+  // Current batch size of subgraphs resized by `ResizeBatch`
+  std::unordered_map<SubgraphKey, int, SubgraphHash> batch_sizes_;
   static std::map<DeviceFlag, tflite::Interpreter::TfLiteDelegatePtr>
       delegates_;
 };
@@ -33,6 +33,10 @@ std::vector<band::interface::ITensor*> BandTensorArrayToVec(
 BandStatus ToBandStatus(absl::Status& status) {
   if (status.code() == absl::StatusCode::kInternal) {
     return kBandErr;
+  } else if (status.code() == absl::StatusCode::kCancelled) {
+    return kBandCancelled;
+  } else if (status.code() == absl::StatusCode::kResourceExhausted) {
+    return kBandRejected;
   } else {
     return kBandOk;
   }
@@ -41,6 +45,10 @@ BandStatus ToBandStatus(absl::Status& status) {
 BandStatus ToBandStatus(absl::Status&& status) {
   if (status.code() == absl::StatusCode::kInternal) {
     return kBandErr;
+  } else if (status.code() == absl::StatusCode::kCancelled) {
+    return kBandCancelled;
+  } else if (status.code() == absl::StatusCode::kResourceExhausted) {
+    return kBandRejected;
   } else {
     return kBandOk;
   }
@@ -52,6 +60,10 @@ band::RequestOption ToRequestOption(BandRequestOption& option) {
   request_option.require_callback = option.require_callback;
   request_option.slo_scale = option.slo_scale;
   request_option.slo_us = option.slo_us;
+  request_option.zero_copy_input = option.zero_copy_input;
+  request_option.completion_queue = option.completion_queue;
+  request_option.priority_class = option.priority_class;
+  request_option.tenant_id = option.tenant_id;
   return request_option;
 }
 
@@ -175,6 +187,67 @@ void BandAddConfig(BandConfigBuilder* b, int field, int count, ...) {
       int arg = va_arg(vl, int);
       b->impl.AddCPUMask(static_cast<band::CPUMaskFlag>(arg));
     } break;
+    case BAND_TENSOR_BUFFER_INITIAL_SIZE: {
+      int arg = va_arg(vl, int);
+      b->impl.AddTensorBufferInitialSize(arg);
+    } break;
+    case BAND_TENSOR_BUFFER_MAX_SIZE: {
+      int arg = va_arg(vl, int);
+      b->impl.AddTensorBufferMaxSize(arg);
+    } break;
+    case BAND_PROFILE_BACKGROUND: {
+      bool arg = va_arg(vl, int);
+      b->impl.AddProfileBackground(arg);
+    } break;
+    case BAND_PLANNER_SHEDDING_POLICY: {
+      int arg = va_arg(vl, int);
+      b->impl.AddSheddingPolicy(static_cast<band::SheddingPolicy>(arg));
+    } break;
+    case BAND_PLANNER_MAX_PENDING_JOBS_PER_MODEL: {
+      int arg = va_arg(vl, int);
+      b->impl.AddMaxPendingJobsPerModel(arg);
+    } break;
+    case BAND_PLANNER_PRIORITY_ARBITRATION: {
+      int arg = va_arg(vl, int);
+      b->impl.AddPriorityArbitration(
+          static_cast<band::PriorityArbitration>(arg));
+    } break;
+    case BAND_PLANNER_PRIORITY_WEIGHTS: {
+      std::vector<int> priority_weights(count);
+      for (int i = 0; i < count; i++) {
+        priority_weights[i] = va_arg(vl, int);
+      }
+      b->impl.AddPriorityWeights(priority_weights);
+    } break;
+    case BAND_PLANNER_STARVATION_TIMEOUT_US: {
+      int arg = va_arg(vl, int);
+      b->impl.AddStarvationTimeout(arg);
+    } break;
+    case BAND_PLANNER_FAIR_SHARE_CONFIG: {
+      // tenant id, weight, rate limit (us per second), burst (us)
+      int tenant_id = va_arg(vl, int);
+      band::FairShareConfig fair_share_config;
+      fair_share_config.weight = va_arg(vl, int);
+      fair_share_config.rate_limit_us = va_arg(vl, int);
+      fair_share_config.burst_us = va_arg(vl, int);
+      b->impl.AddFairShareConfig(tenant_id, fair_share_config);
+    } break;
+    case BAND_PLANNER_PIPELINE_DEPTH: {
+      int arg = va_arg(vl, int);
+      b->impl.AddPipelineDepth(arg);
+    } break;
+    case BAND_PLANNER_PARALLEL_UNIT_SUBGRAPHS: {
+      bool arg = va_arg(vl, int);
+      b->impl.AddParallelUnitSubgraphs(arg);
+    } break;
+    case BAND_PROFILE_DRIFT_THRESHOLD: {
+      float arg = va_arg(vl, double);
+      b->impl.AddProfileDriftThreshold(arg);
+    } break;
+    case BAND_PLANNER_NUM_SHARDS: {
+      int arg = va_arg(vl, int);
+      b->impl.AddPlannerNumShards(arg);
+    } break;
   }
   va_end(vl);
 }
@@ -327,7 +400,9 @@ void* BandTensorGetQuantizationParams(BandTensor* tensor) {
   return tensor->impl->GetQuantization().GetParams();
 }
 
-BandRequestOption BandRequestOptionGetDefault() { return {-1, true, -1, -1.f}; }
+BandRequestOption BandRequestOptionGetDefault() {
+  return {-1, true, -1, -1.f, false, -1, -1, -1};
+}
 
 BandEngine* BandEngineCreateWithDefaultConfig() {
   BandConfig config{band::RuntimeConfigBuilder::GetDefaultConfig()};
@@ -523,7 +598,7 @@ BandRequestHandle BandEngineRequestAsyncOptions(BandEngine* engine,
 
 BandStatus BandEngineWait(BandEngine* engine, BandRequestHandle handle,
                           BandTensor** output_tensors, size_t num_outputs) {
-  if (!engine || !output_tensors) {
+  if (!engine || (!output_tensors && num_outputs)) {
     BAND_LOG(band::LogSeverity::kError,
              "BandEngine (%d) or output_tensors (%d) is null", engine,
              output_tensors);
@@ -534,6 +609,132 @@ BandStatus BandEngineWait(BandEngine* engine, BandRequestHandle handle,
       handle, BandTensorArrayToVec(output_tensors, num_outputs)));
 }
 
+BandStatus BandEngineCancel(BandEngine* engine, BandRequestHandle handle) {
+  if (!engine) {
+    BAND_LOG(band::LogSeverity::kError, "BandEngine is null");
+    return kBandErr;
+  }
+
+  auto status = engine->impl->Cancel(handle);
+  return status.ok() ? kBandOk : kBandErr;
+}
+
+BandStatus BandEngineCancelBatch(BandEngine* engine,
+                                 const BandRequestHandle* handles,
+                                 size_t num_handles) {
+  if (!engine || !handles) {
+    BAND_LOG(band::LogSeverity::kError,
+             "BandEngine (%d) or handles (%d) is null", engine, handles);
+    return kBandErr;
+  }
+
+  auto status = engine->impl->Cancel(
+      std::vector<band::JobId>(handles, handles + num_handles));
+  return status.ok() ? kBandOk : kBandErr;
+}
+
+BandStatus BandEngineLeaseOutputs(BandEngine* engine, BandRequestHandle handle,
+                                  const void** output_data,
+                                  size_t num_outputs) {
+  if (!engine || !output_data) {
+    BAND_LOG(band::LogSeverity::kError,
+             "BandEngine (%d) or output_data (%d) is null", engine,
+             output_data);
+    return kBandErr;
+  }
+
+  auto status_or_tensors = engine->impl->LeaseOutputTensors(handle);
+  if (!status_or_tensors.ok()) {
+    BAND_LOG(band::LogSeverity::kError, "%s",
+             status_or_tensors.status().ToString().c_str());
+    return kBandErr;
+  }
+
+  const std::vector<const band::interface::ITensor*>& tensors =
+      status_or_tensors.value();
+  if (tensors.size() != num_outputs) {
+    BAND_LOG(band::LogSeverity::kError,
+             "Invalid number of outputs: %d (expected %d)", num_outputs,
+             tensors.size());
+    engine->impl->ReleaseOutputTensors(handle).IgnoreError();
+    return kBandErr;
+  }
+
+  for (size_t i = 0; i < num_outputs; ++i) {
+    output_data[i] = tensors[i]->GetData();
+  }
+  return kBandOk;
+}
+
+BandStatus BandEngineReleaseOutputs(BandEngine* engine,
+                                    BandRequestHandle handle) {
+  if (!engine) {
+    BAND_LOG(band::LogSeverity::kError, "BandEngine is null");
+    return kBandErr;
+  }
+
+  return ToBandStatus(engine->impl->ReleaseOutputTensors(handle));
+}
+
+BandStatus BandEngineDiscardOutputs(BandEngine* engine,
+                                    BandRequestHandle handle) {
+  if (!engine) {
+    BAND_LOG(band::LogSeverity::kError, "BandEngine is null");
+    return kBandErr;
+  }
+
+  return ToBandStatus(engine->impl->DiscardOutputTensors(handle));
+}
+
+BandStatus BandEngineSetBatchingConfig(BandEngine* engine, BandModel* model,
+                                       int max_batch_size,
+                                       int64_t max_delay_us) {
+  if (!engine || !model) {
+    BAND_LOG(band::LogSeverity::kError,
+             "BandEngine (%d) or BandModel (%d) is null", engine, model);
+    return kBandErr;
+  }
+
+  band::BatchingConfig batching_config;
+  batching_config.max_batch_size = max_batch_size;
+  batching_config.max_delay_us = max_delay_us;
+  return engine->impl->SetBatchingConfig(model->impl->GetId(), batching_config)
+                 .ok()
+             ? kBandOk
+             : kBandErr;
+}
+
+BandCompletionQueueHandle BandEngineCreateCompletionQueue(BandEngine* engine) {
+  if (!engine) {
+    BAND_LOG(band::LogSeverity::kError, "BandEngine is null");
+    return -1;
+  }
+
+  return engine->impl->CreateCompletionQueue();
+}
+
+BandStatus BandEngineDestroyCompletionQueue(BandEngine* engine,
+                                            BandCompletionQueueHandle queue) {
+  if (!engine) {
+    BAND_LOG(band::LogSeverity::kError, "BandEngine is null");
+    return kBandErr;
+  }
+
+  return engine->impl->DestroyCompletionQueue(queue).ok() ? kBandOk : kBandErr;
+}
+
+BandRequestHandle BandEngineWaitAny(BandEngine* engine,
+                                    BandCompletionQueueHandle queue,
+                                    int64_t timeout_us) {
+  if (!engine) {
+    BAND_LOG(band::LogSeverity::kError, "BandEngine is null");
+    return -1;
+  }
+
+  auto status_or_job_id = engine->impl->WaitAny(queue, timeout_us);
+  return status_or_job_id.ok() ? status_or_job_id.value() : -1;
+}
+
 BandCallbackHandle BandEngineSetOnEndRequest(
     BandEngine* engine,
     void (*on_end_invoke)(void* user_data, int job_id, BandStatus status),
@@ -50,6 +50,7 @@ typedef struct BandTensor BandTensor;
 typedef struct BandEngine BandEngine;
 typedef int BandRequestHandle;
 typedef int BandCallbackHandle;
+typedef int BandCompletionQueueHandle;
 
 /* logging */
 BAND_CAPI_EXPORT extern void BandSetLogSeverity(BandLogSeverity severity);
@@ -127,10 +128,48 @@ BAND_CAPI_EXPORT extern BandStatus BandEngineRequestSyncOptions(
 BAND_CAPI_EXPORT extern BandRequestHandle BandEngineRequestAsyncOptions(
     BandEngine* engine, BandModel* model, BandRequestOption options,
     BandTensor** input_tensors);
+// Outputs of a request can be read only once, by either `BandEngineWait` or
+// `BandEngineLeaseOutputs`. Waiting with no `output_tensors` discards the
+// outputs. Unread outputs keep their slots until a new request of the model
+// needs one, the oldest first.
 BAND_CAPI_EXPORT extern BandStatus BandEngineWait(BandEngine* engine,
                                                   BandRequestHandle handle,
                                                   BandTensor** output_tensors,
                                                   size_t num_outputs);
+// Cancel unfinished requests. Waiting for a cancelled request returns
+// `kBandCancelled`. Returns `kBandErr` if any of the requests is unknown or
+// already finished, after cancelling the others.
+BAND_CAPI_EXPORT extern BandStatus BandEngineCancel(BandEngine* engine,
+                                                    BandRequestHandle handle);
+BAND_CAPI_EXPORT extern BandStatus BandEngineCancelBatch(
+    BandEngine* engine, const BandRequestHandle* handles, size_t num_handles);
+// Borrow the output data of a finished request without copy.
+// `output_data` must have room for `num_outputs` pointers. The data is
+// read-only and stays valid until `BandEngineReleaseOutputs` is called.
+BAND_CAPI_EXPORT extern BandStatus BandEngineLeaseOutputs(
+    BandEngine* engine, BandRequestHandle handle, const void** output_data,
+    size_t num_outputs);
+BAND_CAPI_EXPORT extern BandStatus BandEngineReleaseOutputs(
+    BandEngine* engine, BandRequestHandle handle);
+// Free the outputs of a finished request without reading them.
+BAND_CAPI_EXPORT extern BandStatus BandEngineDiscardOutputs(
+    BandEngine* engine, BandRequestHandle handle);
+// Merge queued requests of the model into a batched invocation of up to
+// `max_batch_size` requests, delaying a request at most `max_delay_us`.
+BAND_CAPI_EXPORT extern BandStatus BandEngineSetBatchingConfig(
+    BandEngine* engine, BandModel* model, int max_batch_size,
+    int64_t max_delay_us);
+// Requests with `BandRequestOption::completion_queue` are reported to the
+// queue in the order of completion.
+BAND_CAPI_EXPORT extern BandCompletionQueueHandle
+BandEngineCreateCompletionQueue(BandEngine* engine);
+BAND_CAPI_EXPORT extern BandStatus BandEngineDestroyCompletionQueue(
+    BandEngine* engine, BandCompletionQueueHandle queue);
+// Returns the handle of the next finished request of the queue, or -1 if
+// no request finished within `timeout_us`. Blocks if `timeout_us` is
+// negative, and polls if it is 0.
+BAND_CAPI_EXPORT extern BandRequestHandle BandEngineWaitAny(
+    BandEngine* engine, BandCompletionQueueHandle queue, int64_t timeout_us);
 BAND_CAPI_EXPORT extern BandCallbackHandle BandEngineSetOnEndRequest(
     BandEngine* engine,
     void (*on_end_invoke)(void* user_data, BandRequestHandle job_id,
@@ -183,6 +222,24 @@ typedef BandRequestHandle (*PFN_BandEngineRequestAsyncOptions)(
     BandEngine*, BandModel*, BandRequestOption, BandTensor**);
 typedef BandStatus (*PFN_BandEngineWait)(BandEngine*, BandRequestHandle,
                                          BandTensor**, size_t);
+typedef BandStatus (*PFN_BandEngineCancel)(BandEngine*, BandRequestHandle);
+typedef BandStatus (*PFN_BandEngineCancelBatch)(BandEngine*,
+                                                const BandRequestHandle*,
+                                                size_t);
+typedef BandStatus (*PFN_BandEngineLeaseOutputs)(BandEngine*,
+                                                 BandRequestHandle,
+                                                 const void**, size_t);
+typedef BandStatus (*PFN_BandEngineReleaseOutputs)(BandEngine*,
+                                                   BandRequestHandle);
+typedef BandStatus (*PFN_BandEngineSetBatchingConfig)(BandEngine*, BandModel*,
+                                                      int, int64_t);
+typedef BandCompletionQueueHandle (*PFN_BandEngineCreateCompletionQueue)(
+    BandEngine*);
+typedef BandStatus (*PFN_BandEngineDestroyCompletionQueue)(
+    BandEngine*, BandCompletionQueueHandle);
+typedef BandRequestHandle (*PFN_BandEngineWaitAny)(BandEngine*,
+                                                   BandCompletionQueueHandle,
+                                                   int64_t);
 typedef BandCallbackHandle (*PFN_BandEngineSetOnEndRequest)(
     BandEngine*, void (*)(void*, int, BandStatus), void*);
 typedef BandStatus (*PFN_BandEngineUnsetOnEndRequest)(BandEngine*,
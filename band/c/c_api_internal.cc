@@ -33,6 +33,14 @@ const char* BandSchedulerToString(BandSchedulerType type) {
       return "least_slack_time_first";
     case kBandHeterogeneousEarliestFinishTimeReserved:
       return "heterogeneous_earliest_finish_time_reserved";
+    case kBandFairShare:
+      return "fair_share";
+    case kBandEarliestDeadlineFirst:
+      return "earliest_deadline_first";
+    case kBandSLOSatisfying:
+      return "slo_satisfying";
+    case kBandPipeline:
+      return "pipeline";
     default: {}
   }
   return "Unknown type";
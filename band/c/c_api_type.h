@@ -40,7 +40,14 @@ typedef enum BandBackendType {
   kBandNumBackendType
 } BandBackendType;
 
-typedef enum BandStatus { kBandOk = 0, kBandErr, kBandDelegateErr } BandStatus;
+typedef enum BandStatus {
+  kBandOk = 0,
+  kBandErr,
+  kBandDelegateErr,
+  kBandCancelled,
+  // Shed by the admission control, see `BAND_PLANNER_SHEDDING_POLICY`
+  kBandRejected
+} BandStatus;
 
 typedef enum BandWorkerType {
   kBandDeviceQueue = 1 << 0,
@@ -55,9 +62,26 @@ typedef enum BandSchedulerType {
   kBandHeterogeneousEarliestFinishTime,
   kBandLeastSlackTimeFirst,
   kBandHeterogeneousEarliestFinishTimeReserved,
+  kBandFairShare,
+  kBandEarliestDeadlineFirst,
+  kBandSLOSatisfying,
+  kBandPipeline,
   kBandNumSchedulerType
 } BandSchedulerType;
 
+typedef enum BandSheddingPolicy {
+  kBandSheddingNone = 0,
+  kBandSheddingRejectNewest,
+  kBandSheddingDropOldest,
+  kBandNumSheddingPolicy
+} BandSheddingPolicy;
+
+typedef enum BandPriorityArbitration {
+  kBandPriorityStrict = 0,
+  kBandPriorityWeighted,
+  kBandNumPriorityArbitration
+} BandPriorityArbitration;
+
 typedef enum BandCPUMaskFlag {
   kBandAll = 0,
   kBandLittle,
@@ -170,6 +194,19 @@ typedef enum BandConfigField {
   BAND_MINIMUM_SUBGRAPH_SIZE,
   BAND_SUBGRAPH_PREPARATION_TYPE,
   BAND_CPU_MASK,
+  BAND_TENSOR_BUFFER_INITIAL_SIZE,
+  BAND_TENSOR_BUFFER_MAX_SIZE,
+  BAND_PROFILE_BACKGROUND,
+  BAND_PLANNER_SHEDDING_POLICY,
+  BAND_PLANNER_MAX_PENDING_JOBS_PER_MODEL,
+  BAND_PLANNER_PRIORITY_ARBITRATION,
+  BAND_PLANNER_PRIORITY_WEIGHTS,
+  BAND_PLANNER_STARVATION_TIMEOUT_US,
+  BAND_PLANNER_FAIR_SHARE_CONFIG,
+  BAND_PLANNER_PIPELINE_DEPTH,
+  BAND_PLANNER_PARALLEL_UNIT_SUBGRAPHS,
+  BAND_PROFILE_DRIFT_THRESHOLD,
+  BAND_PLANNER_NUM_SHARDS,
 } BandConfigField;
 
 typedef enum BandImageProcessorBuilderField {
@@ -187,6 +224,10 @@ typedef struct BandRequestOption {
   bool require_callback;
   int slo_us;
   float slo_scale;
+  bool zero_copy_input;
+  int completion_queue;
+  int priority_class;
+  int tenant_id;
 } BandRequestOption;
 
 #ifdef __cplusplus
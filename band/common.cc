@@ -30,9 +30,7 @@ size_t EnumLength<BackendType>() {
 
 template <>
 size_t EnumLength<SchedulerType>() {
-  return static_cast<size_t>(
-             SchedulerType::kHeterogeneousEarliestFinishTimeReserved) +
-         1;
+  return static_cast<size_t>(SchedulerType::kPipeline) + 1;
 }
 
 template <>
@@ -45,6 +43,16 @@ size_t EnumLength<SubgraphPreparationType>() {
   return static_cast<size_t>(SubgraphPreparationType::kMergeUnitSubgraph) + 1;
 }
 
+template <>
+size_t EnumLength<SheddingPolicy>() {
+  return static_cast<size_t>(SheddingPolicy::kDropOldest) + 1;
+}
+
+template <>
+size_t EnumLength<PriorityArbitration>() {
+  return static_cast<size_t>(PriorityArbitration::kWeighted) + 1;
+}
+
 template <>
 size_t EnumLength<DataType>() {
   return static_cast<size_t>(DataType::kFloat64) + 1;
@@ -127,6 +135,18 @@ const char* ToString(SchedulerType scheduler_type) {
     case SchedulerType::kHeterogeneousEarliestFinishTimeReserved: {
       return "heterogeneous_earliest_finish_time_reserved";
     } break;
+    case SchedulerType::kFairShare: {
+      return "fair_share";
+    } break;
+    case SchedulerType::kEarliestDeadlineFirst: {
+      return "earliest_deadline_first";
+    } break;
+    case SchedulerType::kSLOSatisfying: {
+      return "slo_satisfying";
+    } break;
+    case SchedulerType::kPipeline: {
+      return "pipeline";
+    } break;
     default: {
       return "Unknown scheduler type";
     } break;
@@ -154,6 +174,39 @@ const char* ToString(SubgraphPreparationType subgraph_preparation_type) {
   }
 }
 
+template <>
+const char* ToString(SheddingPolicy shedding_policy) {
+  switch (shedding_policy) {
+    case SheddingPolicy::kNone: {
+      return "none";
+    } break;
+    case SheddingPolicy::kRejectNewest: {
+      return "reject_newest";
+    } break;
+    case SheddingPolicy::kDropOldest: {
+      return "drop_oldest";
+    } break;
+    default: {
+      return "Unknown shedding policy";
+    } break;
+  }
+}
+
+template <>
+const char* ToString(PriorityArbitration priority_arbitration) {
+  switch (priority_arbitration) {
+    case PriorityArbitration::kStrict: {
+      return "strict";
+    } break;
+    case PriorityArbitration::kWeighted: {
+      return "weighted";
+    } break;
+    default: {
+      return "Unknown priority arbitration";
+    } break;
+  }
+}
+
 template <>
 const char* ToString(DataType data_type) {
   switch (data_type) {
@@ -260,6 +313,12 @@ const char* ToString(JobStatus job_status) {
     case JobStatus::kInvokeFailure: {
       return "InvokeFailure";
     } break;
+    case JobStatus::kCancelled: {
+      return "Cancelled";
+    } break;
+    case JobStatus::kRejected: {
+      return "Rejected";
+    } break;
   }
   return "Unknown job status";
 }
@@ -404,6 +463,12 @@ std::ostream& operator<<(std::ostream& os, const JobStatus& status) {
     case JobStatus::kInvokeFailure: {
       return os << "InvokeFailure";
     } break;
+    case JobStatus::kCancelled: {
+      return os << "Cancelled";
+    } break;
+    case JobStatus::kRejected: {
+      return os << "Rejected";
+    } break;
   }
   return os;
 }
@@ -500,7 +565,6 @@ std::string Job::ToJson() const {
          ",\"expected_latency\":" + std::to_string(expected_latency) +
          ",\"slo_us\":" + std::to_string(slo_us) +
          ",\"model_id\":" + std::to_string(model_id) +
-         (model_fname != "" ? ",\"model_fname\":" + model_fname : "") +
          ",\"unit_indices\":" + subgraph_key.GetUnitIndicesString() +
          ",\"job_id\":" + std::to_string(job_id) + "}";
 }
@@ -28,10 +28,15 @@
 #include <vector>
 
 namespace band {
+namespace interface {
+struct ITensor;
+}  // namespace interface
+
 typedef int WorkerId;
 typedef int ModelId;
 typedef int JobId;
 typedef int CallbackId;
+typedef int CompletionQueueId;
 
 using BitMask = std::bitset<64>;
 
@@ -81,6 +86,10 @@ enum class SchedulerType : size_t {
   kHeterogeneousEarliestFinishTime,
   kLeastSlackTimeFirst,
   kHeterogeneousEarliestFinishTimeReserved,
+  kFairShare,
+  kEarliestDeadlineFirst,
+  kSLOSatisfying,
+  kPipeline,
 };
 
 enum class CPUMaskFlag : size_t {
@@ -97,6 +106,24 @@ enum class SubgraphPreparationType : size_t {
   kMergeUnitSubgraph,
 };
 
+// How the planner sheds requests that cannot be served in time
+enum class SheddingPolicy : size_t {
+  // Admit every request
+  kNone = 0,
+  // Reject the incoming request
+  kRejectNewest,
+  // Drop the oldest queued requests in favor of the incoming one
+  kDropOldest,
+};
+
+// How the planner arbitrates between the queues of the priority classes
+enum class PriorityArbitration : size_t {
+  // The lower class schedules first
+  kStrict = 0,
+  // The class with the least service relative to its weight schedules first
+  kWeighted,
+};
+
 enum class DataType : size_t {
   kNoType = 0,
   kFloat32,
@@ -167,7 +194,9 @@ enum class JobStatus : size_t {
   kSLOViolation,
   kInputCopyFailure,
   kOutputCopyFailure,
-  kInvokeFailure
+  kInvokeFailure,
+  kCancelled,
+  kRejected
 };
 
 template <>
@@ -181,6 +210,10 @@ size_t EnumLength<CPUMaskFlag>();
 template <>
 size_t EnumLength<SubgraphPreparationType>();
 template <>
+size_t EnumLength<SheddingPolicy>();
+template <>
+size_t EnumLength<PriorityArbitration>();
+template <>
 size_t EnumLength<DataType>();
 template <>
 size_t EnumLength<BufferFormat>();
@@ -202,6 +235,10 @@ const char* ToString(CPUMaskFlag cpu_mask_flag);
 template <>
 const char* ToString(SubgraphPreparationType subgraph_preparation_type);
 template <>
+const char* ToString(SheddingPolicy shedding_policy);
+template <>
+const char* ToString(PriorityArbitration priority_arbitration);
+template <>
 const char* ToString(DataType data_type);
 template <>
 const char* ToString(BufferFormat buffer_format);
@@ -242,13 +279,34 @@ class Quantization {
 // Setting `slo_scale` will make the SLO =  slo_scale * profiled latency of
 // that model. `slo_scale` will be ignored if `slo_us` is given
 // (i.e., no reason to specify both options). [default : -1 (not specified)]
+// `zero_copy_input`: bind the caller's input tensors directly to the backend
+// instead of copying them into the engine's input buffer. The caller must
+// keep the input tensors alive and unmodified until the request finishes
+// (i.e., until `Wait` returns or the OnEndRequest callback is called).
+// [default: false]
+// `completion_queue`: report the end of the request to the completion queue
+// created by `Engine::CreateCompletionQueue`. [default: -1 (not specified)]
+// `tenant_id`: tag to account the worker time of the request to under
+// `SchedulerType::kFairShare`. Untagged requests are accounted to their model
+// with the default share, apart from the tagged tenants.
+// [default: -1 (not specified)]
+// `priority_class`: index of the planner queue (and its scheduler) to handle
+// the request, where 0 is the most urgent. If not specified, requests with an
+// SLO go to the first class and the others to the last one.
+// [default: -1 (not specified)]
 struct RequestOption {
   int target_worker;
   bool require_callback;
   int slo_us;
   float slo_scale;
+  bool zero_copy_input;
+  CompletionQueueId completion_queue;
+  int priority_class;
+  int tenant_id;
 
-  static RequestOption GetDefaultOption() { return {-1, true, -1, -1.f}; }
+  static RequestOption GetDefaultOption() {
+    return {-1, true, -1, -1.f, false, -1, -1, -1};
+  }
 };
 
 // data structure for identifying subgraphs within whole models
@@ -285,8 +343,17 @@ struct SubgraphHash {
 
 std::ostream& operator<<(std::ostream& os, const JobStatus& status);
 
+// Reference to the `JobState` of a job in the `JobArena`
+struct JobHandle {
+  int32_t index = -1;
+  uint32_t generation = 0;
+  bool IsValid() const { return index >= 0; }
+};
+
 // Job struct is the scheduling and executing unit.
 // The request can specify a model by indication the model id
+// Descriptor of a request, copied by value through the planner, schedulers
+// and workers. Anything that needs heap storage goes to `JobState`.
 struct Job {
   explicit Job() : model_id(-1) {}
   explicit Job(ModelId model_id) : model_id(model_id) {}
@@ -301,8 +368,9 @@ struct Job {
   int input_handle = -1;
   int output_handle = -1;
   JobId job_id = -1;
-  std::string model_fname;
+  JobHandle handle;
   bool require_callback = true;
+  CompletionQueueId completion_queue_id = -1;
 
   // For record (Valid after execution)
   int64_t enqueue_time = 0;
@@ -314,20 +382,32 @@ struct Job {
   int64_t expected_execution_time = 0;
   // Expected total latency
   int64_t expected_latency = 0;
-  int64_t slo_us;
+  int64_t slo_us = 0;
 
   // Target worker id (only for fixed worker request)
   WorkerId target_worker_id = -1;
+  // Index of the planner queue, -1 to route by SLO
+  int priority_class = -1;
+  // Fair share account, -1 for the model
+  int tenant_id = -1;
 
   // Current status for execution (Valid after planning)
   JobStatus status = JobStatus::kQueued;
   SubgraphKey subgraph_key;
-  std::vector<Job> following_jobs;
 
-  // Resolved unit subgraphs and executed subgraph keys
+  // Resolved unit subgraphs
   BitMask resolved_unit_subgraphs;
-  std::list<SubgraphKey> previous_subgraph_keys;
+  // Unit subgraphs of the branch this job runs in parallel with the other
+  // branches of the request, none if it runs the rest of the model. The
+  // units outside of the branch count as resolved for the schedulers.
+  BitMask branch_unit_subgraphs;
+
+  // Number of requests merged into this job by dynamic batching
+  int batch_size = 1;
 };
+static_assert(std::is_trivially_copyable<Job>::value,
+              "Job should stay a plain descriptor");
+
 // hash function to use pair<int, BitMask> as map key in cache_
 // https://stackoverflow.com/a/32685618
 struct JobIdBitMaskHash {
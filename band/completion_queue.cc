@@ -0,0 +1,59 @@
+// Copyright 2023 Seoul National University
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "band/completion_queue.h"
+
+#include <chrono>
+
+namespace band {
+
+void CompletionQueue::Push(JobId job_id) {
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (closed_) {
+      return;
+    }
+    finished_jobs_.push_back(job_id);
+  }
+  cv_.notify_one();
+}
+
+absl::StatusOr<JobId> CompletionQueue::Pop(int64_t timeout_us) {
+  std::unique_lock<std::mutex> lock(mtx_);
+  auto is_ready = [this] { return closed_ || !finished_jobs_.empty(); };
+  if (timeout_us < 0) {
+    cv_.wait(lock, is_ready);
+  } else if (!cv_.wait_for(lock, std::chrono::microseconds(timeout_us),
+                           is_ready)) {
+    return absl::DeadlineExceededError("No job finished in time");
+  }
+
+  if (closed_) {
+    return absl::CancelledError("Completion queue is closed");
+  }
+  JobId job_id = finished_jobs_.front();
+  finished_jobs_.pop_front();
+  return job_id;
+}
+
+void CompletionQueue::Close() {
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    closed_ = true;
+    finished_jobs_.clear();
+  }
+  cv_.notify_all();
+}
+
+}  // namespace band
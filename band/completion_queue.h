@@ -0,0 +1,52 @@
+/*
+ * Copyright 2023 Seoul National University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BAND_COMPLETION_QUEUE_H_
+#define BAND_COMPLETION_QUEUE_H_
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+#include "absl/status/statusor.h"
+#include "band/common.h"
+
+namespace band {
+
+// Ids of finished jobs in the order of completion.
+// Requests tagged with `RequestOption::completion_queue` are reported here
+// as soon as they finish, regardless of the order of submission.
+class CompletionQueue {
+ public:
+  void Push(JobId job_id);
+  // Pops the earliest finished job. Blocks if `timeout_us` is negative,
+  // otherwise waits at most `timeout_us` (0 to poll) and returns
+  // DeadlineExceeded if no job finished in time. Returns Cancelled once the
+  // queue is closed.
+  absl::StatusOr<JobId> Pop(int64_t timeout_us = -1);
+  // Wakes up all waiters. Finished jobs are no longer reported.
+  void Close();
+
+ private:
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  std::deque<JobId> finished_jobs_;
+  bool closed_ = false;
+};
+
+}  // namespace band
+
+#endif  // BAND_COMPLETION_QUEUE_H_
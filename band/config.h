@@ -18,6 +18,7 @@
 #define BAND_CONFIG_H_
 
 #include <limits>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -32,6 +33,23 @@ struct ProfileConfig {
   int num_runs = 1;
   std::string profile_data_path = "";
   float smoothing_factor = 0.1;
+  // Profile newly registered models in the idle gaps of the workers instead
+  // of pausing them (online only). Until a subgraph is measured, its latency
+  // comes from `profile_data_path` if available, or is left as 0.
+  bool background = false;
+  // Relative change of an expected latency that invalidates the plans cached
+  // with the previous latency
+  float drift_threshold = 0.1;
+};
+
+// Share of the worker time of a tenant under `SchedulerType::kFairShare`.
+// Worker time is split by `weight` among the tenants with queued requests.
+// With a rate limit, a tenant may use up to `rate_limit_us` of worker time
+// per second, and save up to `burst_us` while idle (a second's worth if 0).
+struct FairShareConfig {
+  int weight = 1;
+  int64_t rate_limit_us = -1;
+  int64_t burst_us = 0;
 };
 
 struct PlannerConfig {
@@ -39,6 +57,28 @@ struct PlannerConfig {
   std::vector<SchedulerType> schedulers;
   CPUMaskFlag cpu_mask = CPUMaskFlag::kAll;
   std::string log_path = "";
+  // Admission control at enqueue time. Requests that cannot meet their SLO,
+  // or beyond the number of unfinished requests allowed per model (-1 for
+  // unlimited), are shed according to the policy.
+  SheddingPolicy shedding_policy = SheddingPolicy::kNone;
+  int max_pending_jobs_per_model = -1;
+  // Each scheduler serves the queue of a priority class. Weights of the
+  // classes are used by `PriorityArbitration::kWeighted` (1 each by default).
+  // A class whose oldest request waited longer than the starvation timeout
+  // schedules first regardless of the arbitration (-1 to disable).
+  PriorityArbitration priority_arbitration = PriorityArbitration::kStrict;
+  std::vector<int> priority_weights;
+  int64_t starvation_timeout_us = -1;
+  // Per tenant (see `RequestOption::tenant_id`), 1 weight without limit by
+  // default
+  std::map<int, FairShareConfig> fair_share_configs;
+  // Requests in flight per stage of a model, for `SchedulerType::kPipeline`
+  int pipeline_depth = 2;
+  // Run independent unit subgraphs of a request in parallel
+  bool parallel_unit_subgraphs = false;
+  // Planner threads, each scheduling the priority classes `i` with
+  // `i % num_shards` equal to its index. At most the number of schedulers.
+  int num_shards = 1;
 };
 
 struct WorkerConfig {
@@ -64,9 +104,27 @@ struct SubgraphConfig {
       SubgraphPreparationType::kMergeUnitSubgraph;
 };
 
+// Capacity of the per-model input / output tensor buffers. A buffer starts
+// with `initial_size` slots and grows by the same amount on demand (i.e., to
+// the observed number of in-flight requests), up to `max_size` slots.
+struct TensorBufferConfig {
+  int initial_size = 8;
+  int max_size = 128;
+};
+
+// Dynamic batching of a model. Queued requests of the model are merged into
+// a single invocation of up to `max_batch_size` requests, and a request waits
+// at most `max_delay_us` (or less, to keep its SLO) for others to join.
+// The model should have a leading batch dimension of size 1.
+struct BatchingConfig {
+  int max_batch_size = 1;
+  int64_t max_delay_us = 0;
+};
+
 struct RuntimeConfig {
   CPUMaskFlag cpu_mask;
   SubgraphConfig subgraph_config;
+  TensorBufferConfig tensor_buffer_config;
   ProfileConfig profile_config;
   PlannerConfig planner_config;
   WorkerConfig worker_config;
@@ -32,6 +32,7 @@ absl::Status ProfileConfigBuilder::IsValid() {
   REPORT_IF_FALSE(ProfileConfigBuilder, num_runs_ > 0);
   REPORT_IF_FALSE(ProfileConfigBuilder,
                   smoothing_factor_ >= .0f && smoothing_factor_ <= 1.0f);
+  REPORT_IF_FALSE(ProfileConfigBuilder, drift_threshold_ >= .0f);
   if (online_ == false) {
     REPORT_IF_FALSE(ProfileConfigBuilder, profile_data_path_ != "");
   }
@@ -46,6 +47,30 @@ absl::Status PlannerConfigBuilder::IsValid() {
                                             cpu_mask_ == CPUMaskFlag::kLittle ||
                                             cpu_mask_ == CPUMaskFlag::kBig ||
                                             cpu_mask_ == CPUMaskFlag::kPrimary);
+  REPORT_IF_FALSE(PlannerConfigBuilder,
+                  shedding_policy_ <= SheddingPolicy::kDropOldest);
+  REPORT_IF_FALSE(PlannerConfigBuilder, max_pending_jobs_per_model_ == -1 ||
+                                            max_pending_jobs_per_model_ > 0);
+  REPORT_IF_FALSE(PlannerConfigBuilder,
+                  priority_arbitration_ <= PriorityArbitration::kWeighted);
+  REPORT_IF_FALSE(PlannerConfigBuilder,
+                  priority_weights_.empty() ||
+                      priority_weights_.size() == schedulers_.size());
+  for (int weight : priority_weights_) {
+    REPORT_IF_FALSE(PlannerConfigBuilder, weight > 0);
+  }
+  REPORT_IF_FALSE(PlannerConfigBuilder,
+                  starvation_timeout_us_ == -1 || starvation_timeout_us_ > 0);
+  for (auto& tenant_config : fair_share_configs_) {
+    const FairShareConfig& config = tenant_config.second;
+    REPORT_IF_FALSE(PlannerConfigBuilder, config.weight > 0);
+    REPORT_IF_FALSE(PlannerConfigBuilder,
+                    config.rate_limit_us == -1 || config.rate_limit_us > 0);
+    REPORT_IF_FALSE(PlannerConfigBuilder, config.burst_us >= 0);
+  }
+  REPORT_IF_FALSE(PlannerConfigBuilder, pipeline_depth_ > 0);
+  REPORT_IF_FALSE(PlannerConfigBuilder, num_shards_ > 0);
+  REPORT_IF_FALSE(PlannerConfigBuilder, num_shards_ <= schedulers_.size());
   return absl::OkStatus();
 }
 
@@ -89,6 +114,9 @@ absl::Status RuntimeConfigBuilder::IsValid() {
                                             cpu_mask_ == CPUMaskFlag::kLittle ||
                                             cpu_mask_ == CPUMaskFlag::kBig ||
                                             cpu_mask_ == CPUMaskFlag::kPrimary);
+  REPORT_IF_FALSE(RuntimeConfigBuilder, tensor_buffer_initial_size_ > 0);
+  REPORT_IF_FALSE(RuntimeConfigBuilder,
+                  tensor_buffer_max_size_ >= tensor_buffer_initial_size_);
 
   // Independent validation
   RETURN_IF_ERROR(profile_config_builder_.IsValid());
@@ -107,6 +135,8 @@ absl::StatusOr<ProfileConfig> ProfileConfigBuilder::Build() {
   profile_config.num_runs = num_runs_;
   profile_config.smoothing_factor = smoothing_factor_;
   profile_config.profile_data_path = profile_data_path_;
+  profile_config.background = background_;
+  profile_config.drift_threshold = drift_threshold_;
   return profile_config;
 }
 
@@ -118,6 +148,15 @@ absl::StatusOr<PlannerConfig> PlannerConfigBuilder::Build() {
   planner_config.schedule_window_size = schedule_window_size_;
   planner_config.schedulers = schedulers_;
   planner_config.cpu_mask = cpu_mask_;
+  planner_config.shedding_policy = shedding_policy_;
+  planner_config.max_pending_jobs_per_model = max_pending_jobs_per_model_;
+  planner_config.priority_arbitration = priority_arbitration_;
+  planner_config.priority_weights = priority_weights_;
+  planner_config.starvation_timeout_us = starvation_timeout_us_;
+  planner_config.fair_share_configs = fair_share_configs_;
+  planner_config.pipeline_depth = pipeline_depth_;
+  planner_config.parallel_unit_subgraphs = parallel_unit_subgraphs_;
+  planner_config.num_shards = num_shards_;
   return planner_config;
 }
 
@@ -139,6 +178,8 @@ absl::StatusOr<RuntimeConfig> RuntimeConfigBuilder::Build() {
   RuntimeConfig runtime_config;
   runtime_config.subgraph_config = {minimum_subgraph_size_,
                                     subgraph_preparation_type_};
+  runtime_config.tensor_buffer_config = {tensor_buffer_initial_size_,
+                                         tensor_buffer_max_size_};
 
   runtime_config.cpu_mask = cpu_mask_;
   // No need to check the return value of Build() because it has been checked
@@ -17,6 +17,7 @@
 #ifndef BAND_CONFIG_BUILDER_H_
 #define BAND_CONFIG_BUILDER_H_
 
+#include <map>
 #include <string>
 #include <vector>
 
@@ -54,6 +55,14 @@ class ProfileConfigBuilder {
     smoothing_factor_ = smoothing_factor;
     return *this;
   }
+  ProfileConfigBuilder& AddBackground(bool background) {
+    background_ = background;
+    return *this;
+  }
+  ProfileConfigBuilder& AddDriftThreshold(float drift_threshold) {
+    drift_threshold_ = drift_threshold;
+    return *this;
+  }
 
   absl::StatusOr<ProfileConfig> Build();
   absl::Status IsValid();
@@ -64,6 +73,8 @@ class ProfileConfigBuilder {
   int num_runs_ = 1;
   std::string profile_data_path_ = "";
   float smoothing_factor_ = 0.1;
+  bool background_ = false;
+  float drift_threshold_ = 0.1;
 };
 
 // Builder for creating PlannerConfig
@@ -89,6 +100,46 @@ class PlannerConfigBuilder {
     log_path_ = log_path;
     return *this;
   }
+  PlannerConfigBuilder& AddSheddingPolicy(SheddingPolicy shedding_policy) {
+    shedding_policy_ = shedding_policy;
+    return *this;
+  }
+  PlannerConfigBuilder& AddMaxPendingJobsPerModel(
+      int max_pending_jobs_per_model) {
+    max_pending_jobs_per_model_ = max_pending_jobs_per_model;
+    return *this;
+  }
+  PlannerConfigBuilder& AddPriorityArbitration(
+      PriorityArbitration priority_arbitration) {
+    priority_arbitration_ = priority_arbitration;
+    return *this;
+  }
+  PlannerConfigBuilder& AddPriorityWeights(std::vector<int> priority_weights) {
+    priority_weights_ = priority_weights;
+    return *this;
+  }
+  PlannerConfigBuilder& AddStarvationTimeout(int64_t starvation_timeout_us) {
+    starvation_timeout_us_ = starvation_timeout_us;
+    return *this;
+  }
+  PlannerConfigBuilder& AddFairShareConfig(
+      int tenant_id, FairShareConfig fair_share_config) {
+    fair_share_configs_[tenant_id] = fair_share_config;
+    return *this;
+  }
+  PlannerConfigBuilder& AddPipelineDepth(int pipeline_depth) {
+    pipeline_depth_ = pipeline_depth;
+    return *this;
+  }
+  PlannerConfigBuilder& AddParallelUnitSubgraphs(
+      bool parallel_unit_subgraphs) {
+    parallel_unit_subgraphs_ = parallel_unit_subgraphs;
+    return *this;
+  }
+  PlannerConfigBuilder& AddNumShards(int num_shards) {
+    num_shards_ = num_shards;
+    return *this;
+  }
 
   absl::StatusOr<PlannerConfig> Build();
 
@@ -99,6 +150,15 @@ class PlannerConfigBuilder {
   std::vector<SchedulerType> schedulers_;
   CPUMaskFlag cpu_mask_ = CPUMaskFlag::kAll;
   std::string log_path_ = "";
+  SheddingPolicy shedding_policy_ = SheddingPolicy::kNone;
+  int max_pending_jobs_per_model_ = -1;
+  PriorityArbitration priority_arbitration_ = PriorityArbitration::kStrict;
+  std::vector<int> priority_weights_;
+  int64_t starvation_timeout_us_ = -1;
+  std::map<int, FairShareConfig> fair_share_configs_;
+  int pipeline_depth_ = 2;
+  bool parallel_unit_subgraphs_ = false;
+  int num_shards_ = 1;
 };
 
 // Builder for creating WorkerConfig.
@@ -177,6 +237,14 @@ class RuntimeConfigBuilder {
     profile_config_builder_.AddProfileDataPath(profile_log_path);
     return *this;
   }
+  RuntimeConfigBuilder& AddProfileBackground(bool background) {
+    profile_config_builder_.AddBackground(background);
+    return *this;
+  }
+  RuntimeConfigBuilder& AddProfileDriftThreshold(float drift_threshold) {
+    profile_config_builder_.AddDriftThreshold(drift_threshold);
+    return *this;
+  }
 
   // Add PlannerConfig
   RuntimeConfigBuilder& AddPlannerLogPath(std::string planner_log_path) {
@@ -195,6 +263,47 @@ class RuntimeConfigBuilder {
     planner_config_builder_.AddCPUMask(cpu_masks);
     return *this;
   }
+  RuntimeConfigBuilder& AddSheddingPolicy(SheddingPolicy shedding_policy) {
+    planner_config_builder_.AddSheddingPolicy(shedding_policy);
+    return *this;
+  }
+  RuntimeConfigBuilder& AddMaxPendingJobsPerModel(
+      int max_pending_jobs_per_model) {
+    planner_config_builder_.AddMaxPendingJobsPerModel(
+        max_pending_jobs_per_model);
+    return *this;
+  }
+  RuntimeConfigBuilder& AddPriorityArbitration(
+      PriorityArbitration priority_arbitration) {
+    planner_config_builder_.AddPriorityArbitration(priority_arbitration);
+    return *this;
+  }
+  RuntimeConfigBuilder& AddPriorityWeights(std::vector<int> priority_weights) {
+    planner_config_builder_.AddPriorityWeights(priority_weights);
+    return *this;
+  }
+  RuntimeConfigBuilder& AddStarvationTimeout(int64_t starvation_timeout_us) {
+    planner_config_builder_.AddStarvationTimeout(starvation_timeout_us);
+    return *this;
+  }
+  RuntimeConfigBuilder& AddFairShareConfig(int tenant_id,
+                                           FairShareConfig fair_share_config) {
+    planner_config_builder_.AddFairShareConfig(tenant_id, fair_share_config);
+    return *this;
+  }
+  RuntimeConfigBuilder& AddPipelineDepth(int pipeline_depth) {
+    planner_config_builder_.AddPipelineDepth(pipeline_depth);
+    return *this;
+  }
+  RuntimeConfigBuilder& AddParallelUnitSubgraphs(
+      bool parallel_unit_subgraphs) {
+    planner_config_builder_.AddParallelUnitSubgraphs(parallel_unit_subgraphs);
+    return *this;
+  }
+  RuntimeConfigBuilder& AddPlannerNumShards(int num_shards) {
+    planner_config_builder_.AddNumShards(num_shards);
+    return *this;
+  }
 
   // Add WorkerConfig
   RuntimeConfigBuilder& AddWorkers(std::vector<DeviceFlag> workers) {
@@ -232,6 +341,14 @@ class RuntimeConfigBuilder {
     cpu_mask_ = cpu_mask;
     return *this;
   }
+  RuntimeConfigBuilder& AddTensorBufferInitialSize(int initial_size) {
+    tensor_buffer_initial_size_ = initial_size;
+    return *this;
+  }
+  RuntimeConfigBuilder& AddTensorBufferMaxSize(int max_size) {
+    tensor_buffer_max_size_ = max_size;
+    return *this;
+  }
 
   absl::StatusOr<RuntimeConfig> Build();
   static RuntimeConfig GetDefaultConfig();
@@ -246,6 +363,8 @@ class RuntimeConfigBuilder {
   SubgraphPreparationType subgraph_preparation_type_ =
       SubgraphPreparationType::kMergeUnitSubgraph;
   CPUMaskFlag cpu_mask_ = CPUMaskFlag::kAll;
+  int tensor_buffer_initial_size_ = 8;
+  int tensor_buffer_max_size_ = 128;
 };
 
 }  // namespace band
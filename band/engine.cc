@@ -15,6 +15,7 @@
 #include "band/engine.h"
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 
 #include "absl/strings/str_format.h"
@@ -30,9 +31,83 @@
 #include "band/model_spec.h"
 #include "band/planner.h"
 #include "band/tensor.h"
+#include "band/time.h"
 #include "band/worker.h"
 
 namespace band {
+namespace {
+
+// View of a single batch index of a batched tensor
+class BatchSlice : public interface::ITensor {
+ public:
+  BatchSlice(interface::ITensor* tensor, int batch_index)
+      : tensor_(tensor), dims_(tensor->GetDimsVector()) {
+    const size_t batch_size = dims_.empty() ? 1 : dims_[0];
+    if (!dims_.empty()) {
+      dims_[0] = 1;
+    }
+    offset_ = batch_index * (tensor->GetBytes() / batch_size);
+  }
+
+  DataType GetType() const override { return tensor_->GetType(); }
+  void SetType(DataType type) override {}
+  const char* GetData() const override { return tensor_->GetData() + offset_; }
+  char* GetData() override { return tensor_->GetData() + offset_; }
+  const int* GetDims() const override { return dims_.data(); }
+  size_t GetNumDims() const override { return dims_.size(); }
+  void SetDims(const std::vector<int>& dims) override {}
+  const char* GetName() const override { return tensor_->GetName(); }
+  Quantization GetQuantization() const override {
+    return tensor_->GetQuantization();
+  }
+  absl::Status SetQuantization(Quantization quantization) override {
+    return absl::UnimplementedError("Cannot set quantization of a slice");
+  }
+
+ private:
+  interface::ITensor* tensor_;
+  std::vector<int> dims_;
+  size_t offset_;
+};
+
+// Depth of the model table lock held by this thread. Engine methods call
+// each other, so only the outermost one takes the lock.
+thread_local int model_lock_depth = 0;
+
+class ModelReadLock {
+ public:
+  explicit ModelReadLock(std::shared_mutex& mtx) : mtx_(mtx) {
+    if (model_lock_depth++ == 0) {
+      mtx_.lock_shared();
+    }
+  }
+  ~ModelReadLock() {
+    if (--model_lock_depth == 0) {
+      mtx_.unlock_shared();
+    }
+  }
+
+ private:
+  std::shared_mutex& mtx_;
+};
+
+class ModelWriteLock {
+ public:
+  explicit ModelWriteLock(std::shared_mutex& mtx) : mtx_(mtx) {
+    assert(model_lock_depth == 0);
+    mtx_.lock();
+    model_lock_depth++;
+  }
+  ~ModelWriteLock() {
+    model_lock_depth--;
+    mtx_.unlock();
+  }
+
+ private:
+  std::shared_mutex& mtx_;
+};
+
+}  // anonymous namespace
 
 Engine::~Engine() {
   for (auto& model_executor : model_executors_) {
@@ -67,200 +142,237 @@ absl::Status Engine::RegisterModel(Model* model) {
   const ModelId model_id = model->GetId();
 
   for (BackendType backend_type : model->GetSupportedBackends()) {
-    // Analyze model & generate subgraphs per backend type
-    ModelAnalyzer analyzer(*this, planner_->NeedFallbackSubgraphs(),
-                           subgraph_config_, model, backend_type);
-
-    const auto status_or_result = analyzer.CreateSubgraphs();
-    if (!status_or_result.ok()) {
+    // Everything is built aside and published at once at the end, so that
+    // requests of the other models are served in the meantime.
+    auto status = RegisterBackendModel(model, backend_type);
+    if (!status.ok()) {
       // TODO(BAND-49): unregister for specific backend
-      auto status = UnregisterModel(model);
-      if (!status.ok()) {
+      auto unregister_status = UnregisterModel(model);
+      if (!unregister_status.ok()) {
         BAND_LOG(LogSeverity::kError, "Failed to unregister model %d: %s",
-                 model_id, status.ToString().c_str());
-      }
-      return status_or_result.status();
-    }
-
-    const auto result = analyzer.CreateSubgraphs().value();
-    const ModelSpec model_spec = std::get<0>(result);
-    const std::vector<SubgraphDef> subgraph_defs = std::get<1>(result);
-
-    // Create internal model_executor per each supported backends
-    {
-      bool added_once = false;
-      for (WorkerId worker_id = 0; worker_id < workers_.size(); worker_id++) {
-        if (model_spec.unavailable_devices.find(GetWorkerDevice(worker_id)) ==
-            model_spec.unavailable_devices.end()) {
-          const Worker* worker = workers_[worker_id].get();
-          std::unique_ptr<interface::IModelExecutor> model_executor(
-              BackendFactory::CreateModelExecutor(
-                  backend_type, model_id, worker_id, GetWorkerDevice(worker_id),
-                  worker->GetWorkerThreadAffinity(), worker->GetNumThreads()));
-          model_executors_[{model_id, worker_id}] = std::move(model_executor);
-          added_once = true;
-          BAND_LOG(LogSeverity::kInternal,
-                   "Create model executor for model %d worker %s", model_id,
-                   ToString(GetWorkerDevice(worker_id)));
-        }
+                 model_id, unregister_status.ToString().c_str());
       }
+      return status;
+    }
 
-      if (!added_once) {
-        // TODO(BAND-49): unregister for specific backend
-        auto status = UnregisterModel(model);
-        if (!status.ok()) {
-          BAND_LOG(LogSeverity::kError, "Failed to unregister model %d: %s",
-                   model_id, status.ToString().c_str());
-        }
-        return absl::InternalError(
-            "Failed to create model executor on all worker types");
-      }
+    status = latency_estimator_->ProfileModel(model_id);
+    if (!status.ok()) {
+      return status;
     }
+  }
+
+  return absl::OkStatus();
+}
 
-    model_specs_.insert({model_id, model_spec});
+absl::Status Engine::RegisterBackendModel(Model* model,
+                                          BackendType backend_type) {
+  const ModelId model_id = model->GetId();
 
-    // Prepare execution of subgraph definitions per each model_executor
-    {
-      for (const SubgraphDef& subgraph_def : subgraph_defs) {
-        const std::pair<ModelId, WorkerId> model_executor_key = {
-            model_id, subgraph_def.worker_id};
-        const SubgraphKey key = {model_id, subgraph_def.worker_id,
-                                 subgraph_def.unit_subgraph_indices};
+  // Analyze model & generate subgraphs per backend type
+  ModelAnalyzer analyzer(*this, planner_->NeedFallbackSubgraphs(),
+                         subgraph_config_, model, backend_type);
 
-        if (model_executors_.find(model_executor_key) ==
-            model_executors_.end()) {
-          return absl::InternalError(
-              absl::StrFormat("Subgraph logic created a subgraph for worker %d "
-                              "that does not supports model %d",
-                              subgraph_def.worker_id, model_id));
-        } else {
-          auto& model_executor =
-              model_executors_[{model_id, subgraph_def.worker_id}];
-          absl::Status status = model_executor->PrepareSubgraph(
-              model->GetBackendModel(backend_type), subgraph_def.op_indices,
-              subgraph_def.unit_subgraph_indices);
-          if (status.ok()) {
-            // Verify generated subgraphs
-            if (model_executor->HasSubgraph(key) == false) {
-              return absl::InternalError(absl::StrFormat(
-                  "A subgraph for worker %d that does not exists",
-                  subgraph_def.worker_id));
-            }
-            const std::set<int> inputs =
-                model_spec.GetPureInputTensors(subgraph_def.op_indices);
-            const std::set<int> all_outputs =
-                model_spec.GetOutputTensors(subgraph_def.op_indices);
-
-            if (!std::equal(model_executor->GetInputs(key).begin(),
-                            model_executor->GetInputs(key).end(),
-                            inputs.begin())) {
-              return absl::InternalError(
-                  absl::StrFormat("Input format is not correct for worker %d",
-                                  subgraph_def.worker_id));
-            }
-            if (!std::includes(all_outputs.begin(), all_outputs.end(),
-                               model_executor->GetOutputs(key).begin(),
-                               model_executor->GetOutputs(key).end())) {
-              return absl::InternalError(
-                  absl::StrFormat("Output format is not correct for worker %d",
-                                  subgraph_def.worker_id));
-            }
-            unit_subgraphs_to_subgraph_keys_
-                [model_id][*subgraph_def.unit_subgraph_indices.begin()]
-                [*subgraph_def.unit_subgraph_indices.rbegin()]
-                    .push_back(key);
-          }
-        }
+  const auto status_or_result = analyzer.CreateSubgraphs();
+  if (!status_or_result.ok()) {
+    return status_or_result.status();
+  }
+
+  const auto result = status_or_result.value();
+  const ModelSpec model_spec = std::get<0>(result);
+  const std::vector<SubgraphDef> subgraph_defs = std::get<1>(result);
+
+  // Create internal model_executor per each supported backends
+  std::map<WorkerId, std::shared_ptr<interface::IModelExecutor>>
+      model_executors;
+  for (WorkerId worker_id = 0; worker_id < workers_.size(); worker_id++) {
+    if (model_spec.unavailable_devices.find(GetWorkerDevice(worker_id)) ==
+        model_spec.unavailable_devices.end()) {
+      const Worker* worker = workers_[worker_id].get();
+      model_executors[worker_id].reset(BackendFactory::CreateModelExecutor(
+          backend_type, model_id, worker_id, GetWorkerDevice(worker_id),
+          worker->GetWorkerThreadAffinity(), worker->GetNumThreads()));
+      BAND_LOG(LogSeverity::kInternal,
+               "Create model executor for model %d worker %s", model_id,
+               ToString(GetWorkerDevice(worker_id)));
+    }
+  }
+
+  if (model_executors.empty()) {
+    return absl::InternalError(
+        "Failed to create model executor on all worker types");
+  }
+
+  // Prepare execution of subgraph definitions per each model_executor
+  std::map<int, std::map<int, std::vector<SubgraphKey>>>
+      unit_subgraphs_to_subgraph_keys;
+  for (const SubgraphDef& subgraph_def : subgraph_defs) {
+    const SubgraphKey key = {model_id, subgraph_def.worker_id,
+                             subgraph_def.unit_subgraph_indices};
+
+    auto model_executor_it = model_executors.find(subgraph_def.worker_id);
+    if (model_executor_it == model_executors.end()) {
+      return absl::InternalError(
+          absl::StrFormat("Subgraph logic created a subgraph for worker %d "
+                          "that does not supports model %d",
+                          subgraph_def.worker_id, model_id));
+    }
+    auto& model_executor = model_executor_it->second;
+    absl::Status status = model_executor->PrepareSubgraph(
+        model->GetBackendModel(backend_type), subgraph_def.op_indices,
+        subgraph_def.unit_subgraph_indices);
+    if (status.ok()) {
+      // Verify generated subgraphs
+      if (model_executor->HasSubgraph(key) == false) {
+        return absl::InternalError(
+            absl::StrFormat("A subgraph for worker %d that does not exists",
+                            subgraph_def.worker_id));
+      }
+      const std::set<int> inputs =
+          model_spec.GetPureInputTensors(subgraph_def.op_indices);
+      const std::set<int> all_outputs =
+          model_spec.GetOutputTensors(subgraph_def.op_indices);
+
+      if (!std::equal(model_executor->GetInputs(key).begin(),
+                      model_executor->GetInputs(key).end(), inputs.begin())) {
+        return absl::InternalError(
+            absl::StrFormat("Input format is not correct for worker %d",
+                            subgraph_def.worker_id));
+      }
+      if (!std::includes(all_outputs.begin(), all_outputs.end(),
+                         model_executor->GetOutputs(key).begin(),
+                         model_executor->GetOutputs(key).end())) {
+        return absl::InternalError(
+            absl::StrFormat("Output format is not correct for worker %d",
+                            subgraph_def.worker_id));
       }
+      unit_subgraphs_to_subgraph_keys
+          [*subgraph_def.unit_subgraph_indices.begin()]
+          [*subgraph_def.unit_subgraph_indices.rbegin()]
+              .push_back(key);
+    }
+  }
 
-      // Verify equality of all tensor pairs
-      for (const SubgraphDef& lhs : subgraph_defs) {
-        auto& lhs_model_executor = model_executors_[{model_id, lhs.worker_id}];
-        const SubgraphKey lhs_key = {model_id, lhs.worker_id,
-                                     lhs.unit_subgraph_indices};
-
-        std::set<int> lhs_outputs{
-            lhs_model_executor->GetOutputs(lhs_key).begin(),
-            lhs_model_executor->GetOutputs(lhs_key).end()};
-
-        for (const SubgraphDef& rhs : subgraph_defs) {
-          auto& rhs_model_executor =
-              model_executors_[{model_id, rhs.worker_id}];
-          const SubgraphKey rhs_key = {model_id, rhs.worker_id,
-                                       rhs.unit_subgraph_indices};
-          if ((lhs.worker_id != rhs.worker_id) && (&lhs != &rhs)) {
-            std::set<int> rhs_inputs{
-                rhs_model_executor->GetInputs(rhs_key).begin(),
-                rhs_model_executor->GetInputs(rhs_key).end()};
-
-            std::set<int> common_tensors;
-            std::set_intersection(
-                lhs_outputs.begin(), lhs_outputs.end(), rhs_inputs.begin(),
-                rhs_inputs.end(),
-                std::inserter(common_tensors, common_tensors.end()));
-
-            for (int common_tensor_index : common_tensors) {
-              if (!(*lhs_model_executor->GetTensorView(lhs_key,
-                                                       common_tensor_index) ==
-                    *rhs_model_executor->GetTensorView(rhs_key,
-                                                       common_tensor_index))) {
-                return absl::InternalError(absl::StrFormat(
-                    "%s %s %d != %s %s %d",
-                    ToString(GetWorkerDevice(lhs.worker_id)),
-                    lhs.ToString().c_str(), common_tensor_index,
-                    ToString(GetWorkerDevice(rhs.worker_id)),
-                    rhs.ToString().c_str(), common_tensor_index));
-              }
-            }
+  // Verify equality of all tensor pairs
+  for (const SubgraphDef& lhs : subgraph_defs) {
+    auto& lhs_model_executor = model_executors[lhs.worker_id];
+    const SubgraphKey lhs_key = {model_id, lhs.worker_id,
+                                 lhs.unit_subgraph_indices};
+
+    std::set<int> lhs_outputs{lhs_model_executor->GetOutputs(lhs_key).begin(),
+                              lhs_model_executor->GetOutputs(lhs_key).end()};
+
+    for (const SubgraphDef& rhs : subgraph_defs) {
+      auto& rhs_model_executor = model_executors[rhs.worker_id];
+      const SubgraphKey rhs_key = {model_id, rhs.worker_id,
+                                   rhs.unit_subgraph_indices};
+      if ((lhs.worker_id != rhs.worker_id) && (&lhs != &rhs)) {
+        std::set<int> rhs_inputs{rhs_model_executor->GetInputs(rhs_key).begin(),
+                                 rhs_model_executor->GetInputs(rhs_key).end()};
+
+        std::set<int> common_tensors;
+        std::set_intersection(
+            lhs_outputs.begin(), lhs_outputs.end(), rhs_inputs.begin(),
+            rhs_inputs.end(),
+            std::inserter(common_tensors, common_tensors.end()));
+
+        for (int common_tensor_index : common_tensors) {
+          if (!(*lhs_model_executor->GetTensorView(lhs_key,
+                                                   common_tensor_index) ==
+                *rhs_model_executor->GetTensorView(rhs_key,
+                                                   common_tensor_index))) {
+            return absl::InternalError(absl::StrFormat(
+                "%s %s %d != %s %s %d",
+                ToString(GetWorkerDevice(lhs.worker_id)),
+                lhs.ToString().c_str(), common_tensor_index,
+                ToString(GetWorkerDevice(rhs.worker_id)),
+                rhs.ToString().c_str(), common_tensor_index));
           }
         }
       }
+    }
+  }
 
-      // todo: connect prev / next && unit indices
+  // todo: connect prev / next && unit indices
 
-      // Initialize tensor ring buffer
-      // Assumption: each backend model in band::Model has the same input /
-      // output tensor shapes
-      {
-        std::vector<std::shared_ptr<interface::ITensor>> input_tensors;
-        std::vector<std::shared_ptr<interface::ITensor>> output_tensors;
+  // Initialize tensor ring buffer
+  // Assumption: each backend model in band::Model has the same input /
+  // output tensor shapes
+  std::unique_ptr<TensorRingBuffer> input_buffer;
+  std::unique_ptr<TensorRingBuffer> output_buffer;
+  {
+    std::vector<std::shared_ptr<interface::ITensor>> input_tensors;
+    std::vector<std::shared_ptr<interface::ITensor>> output_tensors;
+
+    auto primary_model_executor_it =
+        model_executors.find(GetDeviceWorkerId(DeviceFlag::kCPU));
+    if (primary_model_executor_it == model_executors.end()) {
+      return absl::InternalError(absl::StrFormat(
+          "Failed to find a CPU model executor of model %d", model_id));
+    }
+    interface::IModelExecutor* primary_model_executor =
+        primary_model_executor_it->second.get();
+    auto model_subgraph_key = primary_model_executor->GetLargestSubgraphKey();
 
-        auto model_subgraph_key = GetLargestSubgraphKey(
-            model_id, GetDeviceWorkerId(DeviceFlag::kCPU));
-        interface::IModelExecutor* primary_model_executor =
-            GetModelExecutor(model_subgraph_key);
+    for (int input_tensor : model_spec.input_tensors) {
+      input_tensors.push_back(primary_model_executor->GetTensorView(
+          model_subgraph_key, input_tensor));
+    }
 
-        for (int input_tensor : model_spec.input_tensors) {
-          input_tensors.push_back(primary_model_executor->GetTensorView(
-              model_subgraph_key, input_tensor));
-        }
+    for (int output_tensor : model_spec.output_tensors) {
+      output_tensors.push_back(primary_model_executor->GetTensorView(
+          model_subgraph_key, output_tensor));
+    }
 
-        for (int output_tensor : model_spec.output_tensors) {
-          output_tensors.push_back(primary_model_executor->GetTensorView(
-              model_subgraph_key, output_tensor));
-        }
+    const std::vector<int> input_indices{model_spec.input_tensors.begin(),
+                                         model_spec.input_tensors.end()};
+    const std::vector<int> output_indices{model_spec.output_tensors.begin(),
+                                          model_spec.output_tensors.end()};
+
+    input_buffer = std::make_unique<TensorRingBuffer>(
+        input_tensors, input_indices, tensor_buffer_config_.initial_size,
+        tensor_buffer_config_.max_size);
+    output_buffer = std::make_unique<TensorRingBuffer>(
+        output_tensors, output_indices, tensor_buffer_config_.initial_size,
+        tensor_buffer_config_.max_size);
+  }
 
-        const std::vector<int> input_indices{model_spec.input_tensors.begin(),
-                                             model_spec.input_tensors.end()};
-        const std::vector<int> output_indices{model_spec.output_tensors.begin(),
-                                              model_spec.output_tensors.end()};
-
-        model_input_buffer_.emplace(
-            model->GetId(),
-            std::make_unique<TensorRingBuffer>(input_tensors, input_indices));
-        model_output_buffer_.emplace(
-            model_id,
-            std::make_unique<TensorRingBuffer>(output_tensors, output_indices));
-      }
+  // Publish the model
+  ModelWriteLock lock(model_mtx_);
+  for (auto& worker_model_executor : model_executors) {
+    model_executors_[{model_id, worker_model_executor.first}] =
+        std::move(worker_model_executor.second);
+  }
+  model_specs_.insert({model_id, model_spec});
+  UnitSubgraphTable& table = unit_subgraph_tables_[model_id];
+  for (auto& worker_model_executor : model_executors_) {
+    if (worker_model_executor.first.first != model_id) {
+      continue;
     }
-    {
-      auto status = latency_estimator_->ProfileModel(model_id);
-      if (!status.ok()) {
-        return status;
+    worker_model_executor.second->ForEachSubgraph([&](const SubgraphKey& key) {
+      bool is_begin = true;
+      for (int unit_index : key.GetUnitIndicesSet()) {
+        is_begin &= model_spec.GetUnitSubgraphDependency(unit_index).none();
       }
+      table.candidates.push_back(key);
+      table.external_dependencies.push_back(
+          model_spec.GetUnitSubgraphDependency(key.GetUnitIndices()));
+      table.is_begin.push_back(is_begin);
+    });
+  }
+  const size_t num_unit_subgraphs = model_spec.GetNumUnitSubgraphs();
+  table.num_unit_subgraphs = num_unit_subgraphs;
+  table.spans.assign(num_unit_subgraphs * num_unit_subgraphs, {0, 0});
+  for (auto& start_keys : unit_subgraphs_to_subgraph_keys) {
+    for (auto& end_keys : start_keys.second) {
+      const uint32_t begin = table.keys.size();
+      table.keys.insert(table.keys.end(), end_keys.second.begin(),
+                        end_keys.second.end());
+      table.spans[start_keys.first * num_unit_subgraphs + end_keys.first] = {
+          begin, table.keys.size()};
     }
   }
-
+  model_input_buffer_.emplace(model_id, std::move(input_buffer));
+  model_output_buffer_.emplace(model_id, std::move(output_buffer));
   return absl::OkStatus();
 }
 
@@ -269,29 +381,134 @@ absl::Status Engine::UnregisterModel(Model* model) {
     return absl::InternalError("Failed to unregister null model.");
   }
 
-  for (auto it = model_executors_.begin(); it != model_executors_.end();) {
-    (it->first.second == model->GetId()) ? model_executors_.erase(it++)
-                                         : (++it);
+  // Stop routing new requests to the model, then wait for the admitted ones
+  std::set<ModelId> versions = {model->GetId()};
+  {
+    ModelWriteLock lock(model_mtx_);
+    auto it = model_versions_.find(model->GetId());
+    if (it != model_versions_.end()) {
+      versions.insert(it->second);
+      model_versions_.erase(it);
+    }
+    for (auto it = model_versions_.begin(); it != model_versions_.end();) {
+      (it->second == model->GetId()) ? model_versions_.erase(it++) : (++it);
+    }
   }
 
-  for (auto it = model_specs_.begin(); it != model_specs_.end();) {
-    (it->first == model->GetId()) ? model_specs_.erase(it++) : (++it);
+  for (ModelId version : versions) {
+    WaitForModelDrain(version);
+    ReleaseModel(version);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status Engine::ReplaceModel(Model* model, Model* new_model) {
+  if (!model || !new_model) {
+    return absl::InvalidArgumentError("Failed to replace null model.");
+  }
+  if (model->GetId() == new_model->GetId()) {
+    return absl::InvalidArgumentError("Cannot replace a model with itself.");
   }
 
-  for (auto it = model_input_buffer_.begin();
-       it != model_input_buffer_.end();) {
-    (it->first == model->GetId()) ? model_input_buffer_.erase(it++) : (++it);
+  ModelId old_version;
+  std::vector<int> input_indices;
+  std::vector<int> output_indices;
+  {
+    ModelReadLock lock(model_mtx_);
+    old_version = GetModelVersion(model->GetId());
+    if (model_specs_.find(old_version) == model_specs_.end()) {
+      return absl::NotFoundError(
+          absl::StrFormat("Model %d is not registered", model->GetId()));
+    }
+    input_indices = GetInputTensorIndices(old_version);
+    output_indices = GetOutputTensorIndices(old_version);
   }
 
-  for (auto it = model_output_buffer_.begin();
-       it != model_output_buffer_.end();) {
-    (it->first == model->GetId()) ? model_output_buffer_.erase(it++) : (++it);
+  RETURN_IF_ERROR(RegisterModel(new_model));
+  if (GetInputTensorIndices(new_model->GetId()).size() !=
+          input_indices.size() ||
+      GetOutputTensorIndices(new_model->GetId()).size() !=
+          output_indices.size()) {
+    UnregisterModel(new_model).IgnoreError();
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Model %d has different inputs / outputs from model %d",
+        new_model->GetId(), model->GetId()));
   }
 
+  {
+    // New requests go to the new version from now on
+    ModelWriteLock lock(model_mtx_);
+    for (auto& version : model_versions_) {
+      if (version.second == old_version) {
+        version.second = new_model->GetId();
+      }
+    }
+    model_versions_[model->GetId()] = new_model->GetId();
+  }
+
+  // Admitted requests finish on the previous version
+  WaitForModelDrain(old_version);
+  ReleaseModel(old_version);
   return absl::OkStatus();
 }
 
+ModelId Engine::GetModelVersion(ModelId model_id) const {
+  auto it = model_versions_.find(model_id);
+  return it != model_versions_.end() ? it->second : model_id;
+}
+
+void Engine::WaitForModelDrain(ModelId model_id) {
+  std::unique_lock<std::mutex> lock(num_inflight_jobs_mtx_);
+  model_drained_.wait(lock, [this, model_id]() {
+    auto it = num_inflight_jobs_.find(model_id);
+    return it == num_inflight_jobs_.end() || it->second == 0;
+  });
+}
+
+void Engine::ReleaseModel(ModelId model_id) {
+  // Drop the batching config first, the planner calls back into the engine
+  planner_->SetBatchingConfig(model_id, BatchingConfig()).IgnoreError();
+  planner_->OnModelReleased(model_id);
+  // Measured latencies are kept, pending profiles and estimates are not
+  if (latency_estimator_) {
+    latency_estimator_->OnModelReleased(model_id);
+  }
+
+  ModelWriteLock lock(model_mtx_);
+  for (auto it = model_executors_.begin(); it != model_executors_.end();) {
+    (it->first.first == model_id) ? model_executors_.erase(it++) : (++it);
+  }
+  model_specs_.erase(model_id);
+  model_input_buffer_.erase(model_id);
+  unit_subgraph_tables_.erase(model_id);
+  {
+    std::lock_guard<std::mutex> cache_lock(cache_mtx_);
+    auto is_model = [model_id](const std::pair<ModelId, BitMask>& key) {
+      return key.first == model_id;
+    };
+    cache_.EraseIf(is_model);
+    candidate_cache_.EraseIf(is_model);
+  }
+
+  // Outputs of the finished jobs stay readable until they are consumed.
+  retired_models_.insert(model_id);
+  for (auto it = retired_models_.begin(); it != retired_models_.end();) {
+    auto output_buffer_it = model_output_buffer_.find(*it);
+    if (output_buffer_it == model_output_buffer_.end() ||
+        output_buffer_it->second->GetNumInUse() == 0) {
+      if (output_buffer_it != model_output_buffer_.end()) {
+        model_output_buffer_.erase(output_buffer_it);
+      }
+      it = retired_models_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
 Tensor* Engine::CreateTensor(ModelId model_id, int tensor_index) {
+  ModelReadLock lock(model_mtx_);
+  model_id = GetModelVersion(model_id);
   // TODO: What if there are multiple backends?
   SubgraphKey model_subgraph_key =
       GetLargestSubgraphKey(model_id, GetDeviceWorkerId(DeviceFlag::kCPU));
@@ -306,8 +523,9 @@ Tensor* Engine::CreateTensor(ModelId model_id, int tensor_index) {
 }
 
 std::vector<int> Engine::GetOutputTensorIndices(ModelId model_id) const {
-  SubgraphKey model_subgraph_key =
-      GetLargestSubgraphKey(model_id, GetDeviceWorkerId(DeviceFlag::kCPU));
+  ModelReadLock lock(model_mtx_);
+  SubgraphKey model_subgraph_key = GetLargestSubgraphKey(
+      GetModelVersion(model_id), GetDeviceWorkerId(DeviceFlag::kCPU));
   const interface::IModelExecutor* model_executor =
       GetModelExecutor(model_subgraph_key);
   return model_executor ? model_executor->GetOutputs(model_subgraph_key)
@@ -315,8 +533,9 @@ std::vector<int> Engine::GetOutputTensorIndices(ModelId model_id) const {
 }
 
 std::vector<int> Engine::GetInputTensorIndices(ModelId model_id) const {
-  SubgraphKey model_subgraph_key =
-      GetLargestSubgraphKey(model_id, GetDeviceWorkerId(DeviceFlag::kCPU));
+  ModelReadLock lock(model_mtx_);
+  SubgraphKey model_subgraph_key = GetLargestSubgraphKey(
+      GetModelVersion(model_id), GetDeviceWorkerId(DeviceFlag::kCPU));
   const interface::IModelExecutor* model_executor =
       GetModelExecutor(model_subgraph_key);
   return model_executor ? model_executor->GetInputs(model_subgraph_key)
@@ -380,54 +599,173 @@ absl::StatusOr<std::vector<JobId>> Engine::RequestAsync(
                         model_ids.size(), options.size()));
   }
 
+  ModelReadLock lock(model_mtx_);
   for (size_t i = 0; i < model_ids.size(); i++) {
-    // TODO(BAND-33): explicit job life cycle
-    Job job(model_ids[i]);
-    job.require_callback = options[i].require_callback;
-
-    int target_slo_us = options[i].slo_us;
-    // TODO(widiba03304): absl::optional for implicit slo_scale default.
-    if (options[i].slo_scale != -1) {
-      if (options[i].slo_scale <= 0) {
-        return absl::InternalError(absl::StrFormat(
-            "Specified slo_scale is invalid (%f <= 0)", options[i].slo_scale));
+    const Tensors* job_inputs = i < inputs.size() ? &inputs[i] : nullptr;
+    auto status_or_job = CreateJob(model_ids[i], options[i], job_inputs);
+    if (!status_or_job.ok()) {
+      // A request is admitted all at once or not at all
+      for (const Job& job : jobs) {
+        DiscardJob(job);
       }
+      return status_or_job.status();
+    }
+    jobs.push_back(status_or_job.value());
+  }
+
+  {
+    // Admitted jobs hold their model version until they finish
+    std::lock_guard<std::mutex> inflight_lock(num_inflight_jobs_mtx_);
+    for (const Job& job : jobs) {
+      num_inflight_jobs_[job.model_id]++;
+    }
+  }
+  return EnqueueBatch(jobs);
+}
+
+absl::StatusOr<Job> Engine::CreateJob(ModelId requested_model_id,
+                                      const RequestOption& option,
+                                      const Tensors* inputs) {
+  // Requests are served by the current version of the model
+  const ModelId model_id = GetModelVersion(requested_model_id);
+  if (model_specs_.find(model_id) == model_specs_.end()) {
+    return absl::NotFoundError(
+        absl::StrFormat("Model %d is not registered", requested_model_id));
+  }
+
+  // TODO(BAND-33): explicit job life cycle
+  Job job(model_id);
+  job.require_callback = option.require_callback;
 
-      target_slo_us = GetWorst(model_ids[i]) * options[i].slo_scale;
+  if (option.completion_queue != -1) {
+    if (planner_->GetCompletionQueue(option.completion_queue) == nullptr) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Request assigned to invalid completion queue (%d)",
+                          option.completion_queue));
     }
+    job.completion_queue_id = option.completion_queue;
+  }
 
-    // override, if `slo_us` is specified
-    if (options[i].slo_us != -1) {
-      target_slo_us = options[i].slo_us;
+  int target_slo_us = option.slo_us;
+  // TODO(widiba03304): absl::optional for implicit slo_scale default.
+  if (option.slo_scale != -1) {
+    if (option.slo_scale <= 0) {
+      return absl::InternalError(absl::StrFormat(
+          "Specified slo_scale is invalid (%f <= 0)", option.slo_scale));
     }
 
-    job.slo_us = target_slo_us;
+    target_slo_us = GetWorst(model_id) * option.slo_scale;
+  }
 
-    if (options[i].target_worker != -1) {
-      Worker* target_worker = GetWorker(options[i].target_worker);
-      if (target_worker == nullptr) {
-        return absl::InternalError(
-            absl::StrFormat("Request assigned to invalid worker id (%d)",
-                            options[i].target_worker));
-      }
-      job.target_worker_id = options[i].target_worker;
+  // override, if `slo_us` is specified
+  if (option.slo_us != -1) {
+    target_slo_us = option.slo_us;
+  }
+
+  job.slo_us = target_slo_us;
+
+  if (option.target_worker != -1) {
+    Worker* target_worker = GetWorker(option.target_worker);
+    if (target_worker == nullptr) {
+      return absl::InternalError(
+          absl::StrFormat("Request assigned to invalid worker id (%d)",
+                          option.target_worker));
     }
+    job.target_worker_id = option.target_worker;
+  }
 
-    if (i < inputs.size()) {
-      int input_handle = model_input_buffer_[model_ids[i]]->Alloc();
-      if (!model_input_buffer_[model_ids[i]]
-               ->PutTensorsToHandle(inputs[i], input_handle)
-               .ok()) {
-        return absl::InternalError(
-            absl::StrFormat("Input copy failure for model %d", model_ids[i]));
-      }
-      job.input_handle = input_handle;
-      job.output_handle = model_output_buffer_[model_ids[i]]->Alloc();
+  if (option.priority_class < -1 ||
+      option.priority_class >= planner_->GetNumPriorityClasses()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Request assigned to invalid priority class (%d), expected < %d",
+        option.priority_class, planner_->GetNumPriorityClasses()));
+  }
+  job.priority_class = option.priority_class;
+
+  if (option.tenant_id < -1) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Invalid tenant id (%d)", option.tenant_id));
+  }
+  job.tenant_id = option.tenant_id;
+
+  if (inputs && option.zero_copy_input) {
+    if (inputs->size() != GetInputTensorIndices(model_id).size()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Zero-copy request for model %d requires %d input tensors, got %d",
+          requested_model_id, GetInputTensorIndices(model_id).size(),
+          inputs->size()));
+    }
+    // Inputs are read from the caller's tensors by the worker
+    job.handle = planner_->GetJobArena().Allocate();
+    if (!job.handle.IsValid()) {
+      return absl::ResourceExhaustedError("Too many jobs in flight");
+    }
+    planner_->GetJobArena().Get(job.handle)->bound_inputs = *inputs;
+  } else if (inputs) {
+    TensorRingBuffer* input_buffer = model_input_buffer_[model_id].get();
+    absl::StatusOr<int> status_or_input_handle = input_buffer->Alloc();
+    if (!status_or_input_handle.ok()) {
+      return absl::ResourceExhaustedError(absl::StrFormat(
+          "All input slots of model %d are in use", requested_model_id));
+    }
+    const int input_handle = status_or_input_handle.value();
+    if (!input_buffer->PutTensorsToHandle(*inputs, input_handle).ok()) {
+      input_buffer->Release(input_handle).IgnoreError();
+      return absl::InternalError(absl::StrFormat(
+          "Input copy failure for model %d", requested_model_id));
+    }
+    job.input_handle = input_handle;
+  }
+
+  if (inputs) {
+    absl::StatusOr<int> status_or_output_handle =
+        model_output_buffer_[model_id]->Alloc();
+    // Unread outputs give way to new requests, the oldest first
+    while (!status_or_output_handle.ok() &&
+           EvictOldestUnreadOutputs(model_id)) {
+      status_or_output_handle = model_output_buffer_[model_id]->Alloc();
     }
+    if (!status_or_output_handle.ok()) {
+      DiscardJob(job);
+      return absl::ResourceExhaustedError(absl::StrFormat(
+          "All output slots of model %d are in use or leased",
+          requested_model_id));
+    }
+    job.output_handle = status_or_output_handle.value();
+  }
+
+  return job;
+}
 
-    jobs.push_back(job);
+bool Engine::EvictOldestUnreadOutputs(ModelId model_id) {
+  std::lock_guard<std::mutex> lock(outputs_mtx_);
+  // Job ids increase with submission, so the first one is the oldest
+  auto it = std::find_if(
+      unread_outputs_.begin(), unread_outputs_.end(),
+      [model_id](const std::pair<const JobId, std::pair<ModelId, int>>&
+                     unread_output) {
+        return unread_output.second.first == model_id;
+      });
+  if (it == unread_outputs_.end()) {
+    return false;
   }
-  return EnqueueBatch(jobs);
+  model_output_buffer_.at(model_id)
+      ->Release(it->second.second)
+      .IgnoreError();
+  unread_outputs_.erase(it);
+  return true;
+}
+
+void Engine::DiscardJob(const Job& job) {
+  if (job.input_handle >= 0) {
+    model_input_buffer_[job.model_id]->Release(job.input_handle).IgnoreError();
+  }
+  if (job.output_handle >= 0) {
+    model_output_buffer_[job.model_id]
+        ->Release(job.output_handle)
+        .IgnoreError();
+  }
+  planner_->GetJobArena().Free(job.handle);
 }
 
 absl::Status Engine::Wait(JobId job_id, Tensors outputs) {
@@ -441,54 +779,133 @@ absl::Status Engine::Wait(JobId job_id, Tensors outputs) {
 absl::Status Engine::Wait(std::vector<JobId> job_ids,
                           std::vector<Tensors> outputs) {
   planner_->Wait(job_ids);
-  for (size_t i = 0; i < outputs.size(); i++) {
-    auto status = GetOutputTensors(job_ids[i], outputs[i]);
-    if (!status.ok()) {
-      return status;
+  absl::Status status = absl::OkStatus();
+  for (size_t i = 0; i < job_ids.size(); i++) {
+    if (i < outputs.size()) {
+      auto output_status = GetOutputTensors(job_ids[i], outputs[i]);
+      if (status.ok()) {
+        status = output_status;
+      }
+    } else {
+      // Nobody asked for the outputs
+      DiscardOutputTensors(job_ids[i]).IgnoreError();
     }
   }
-  return absl::OkStatus();
+  return status;
 }
 
 void Engine::WaitAll() { planner_->WaitAll(); }
 
-absl::Status Engine::GetOutputTensors(JobId job_id, Tensors outputs) {
-  Job job = planner_->GetFinishedJob(job_id);
+absl::Status Engine::Cancel(JobId job_id) {
+  return Cancel(std::vector<JobId>({job_id}));
+}
+
+absl::Status Engine::Cancel(std::vector<JobId> job_ids) {
+  return planner_->Cancel(job_ids);
+}
 
+absl::Status Engine::GetOutputTensors(JobId job_id, Tensors outputs) {
   if (outputs.empty() || job_id == -1) {
     return absl::InternalError(
         absl::StrFormat("Invalid job id / num outputs to copy: (%d, %d)",
                         job_id, outputs.size()));
   }
 
-  // Not finished or invalidated
-  if (job.job_id == -1) {
-    return absl::InternalError("Invalid job id / not finished or invalidated.");
+  auto status_or_job = GetFinishedJobWithOutputs(job_id);
+  if (!status_or_job.ok()) {
+    return status_or_job.status();
   }
+  const Job& job = status_or_job.value();
 
-  if (job.output_handle == -1) {
-    return absl::InternalError(
-        absl::StrFormat("Invalid output handle : %d", job.output_handle));
+  ModelReadLock model_lock(model_mtx_);
+  {
+    std::lock_guard<std::mutex> lock(outputs_mtx_);
+    auto it = unread_outputs_.find(job_id);
+    if (it == unread_outputs_.end()) {
+      return absl::InternalError(absl::StrFormat(
+          "Outputs of job %d are already read, discarded or evicted",
+          job_id));
+    }
+    unread_outputs_.erase(it);
   }
 
-  if (job.status == JobStatus::kSLOViolation) {
-    return absl::DeadlineExceededError("SLO violation");
-  } else if (job.status != JobStatus::kSuccess) {
+  // Outputs are consumed, free the slot after the copy
+  auto output_buffer = model_output_buffer_.at(job.model_id).get();
+  auto status = output_buffer->GetTensorsFromHandle(outputs, job.output_handle);
+  output_buffer->Release(job.output_handle).IgnoreError();
+  return status;
+}
+
+absl::StatusOr<std::vector<const interface::ITensor*>>
+Engine::LeaseOutputTensors(JobId job_id) {
+  auto status_or_job = GetFinishedJobWithOutputs(job_id);
+  if (!status_or_job.ok()) {
+    return status_or_job.status();
+  }
+  const Job& job = status_or_job.value();
+
+  ModelReadLock model_lock(model_mtx_);
+  std::lock_guard<std::mutex> lock(outputs_mtx_);
+  if (output_leases_.find(job_id) != output_leases_.end()) {
     return absl::InternalError(
-        absl::StrFormat("Job failed with status : %s", ToString(job.status)));
+        absl::StrFormat("Outputs of job %d are already leased", job_id));
+  }
+  auto it = unread_outputs_.find(job_id);
+  if (it == unread_outputs_.end()) {
+    return absl::InternalError(absl::StrFormat(
+        "Outputs of job %d are already read, discarded or evicted",
+        job_id));
   }
 
-  if (model_output_buffer_.find(job.model_id) == model_output_buffer_.end()) {
+  // The lease takes over the slot from the finished job
+  TensorRingBuffer* output_buffer = model_output_buffer_.at(job.model_id).get();
+  auto status_or_tensors = output_buffer->Lease(job.output_handle);
+  if (status_or_tensors.ok()) {
+    output_buffer->Release(job.output_handle).IgnoreError();
+    unread_outputs_.erase(it);
+    output_leases_[job_id] = {job.model_id, job.output_handle};
+  }
+  return status_or_tensors;
+}
+
+absl::Status Engine::ReleaseOutputTensors(JobId job_id) {
+  ModelReadLock model_lock(model_mtx_);
+  std::lock_guard<std::mutex> lock(outputs_mtx_);
+  auto it = output_leases_.find(job_id);
+  if (it == output_leases_.end()) {
     return absl::InternalError(
-        absl::StrFormat("Invalid model id : %d", job.model_id));
+        absl::StrFormat("Outputs of job %d are not leased", job_id));
   }
 
-  auto status = model_output_buffer_.at(job.model_id)
-                    ->GetTensorsFromHandle(outputs, job.output_handle);
-  if (!status.ok()) {
-    return status;
+  const ModelId model_id = it->second.first;
+  const int output_handle = it->second.second;
+  output_leases_.erase(it);
+
+  if (model_output_buffer_.find(model_id) == model_output_buffer_.end()) {
+    // The model is unregistered while its outputs are leased
+    return absl::OkStatus();
   }
-  return absl::OkStatus();
+  return model_output_buffer_.at(model_id)->Release(output_handle);
+}
+
+absl::Status Engine::DiscardOutputTensors(JobId job_id) {
+  ModelReadLock model_lock(model_mtx_);
+  std::lock_guard<std::mutex> lock(outputs_mtx_);
+  auto it = unread_outputs_.find(job_id);
+  if (it == unread_outputs_.end()) {
+    return absl::InternalError(absl::StrFormat(
+        "Outputs of job %d are already read, discarded or evicted",
+        job_id));
+  }
+
+  const ModelId model_id = it->second.first;
+  const int output_handle = it->second.second;
+  unread_outputs_.erase(it);
+
+  if (model_output_buffer_.find(model_id) == model_output_buffer_.end()) {
+    return absl::OkStatus();
+  }
+  return model_output_buffer_.at(model_id)->Release(output_handle);
 }
 
 CallbackId Engine::SetOnEndRequest(
@@ -500,7 +917,56 @@ absl::Status Engine::UnsetOnEndRequest(CallbackId callback_id) {
   return planner_->UnsetOnEndRequest(callback_id);
 }
 
+absl::Status Engine::SetBatchingConfig(ModelId model_id,
+                                       const BatchingConfig& batching_config) {
+  ModelId version;
+  {
+    ModelReadLock lock(model_mtx_);
+    version = GetModelVersion(model_id);
+    if (model_specs_.find(version) == model_specs_.end()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Model %d is not registered", model_id));
+    }
+  }
+  return planner_->SetBatchingConfig(version, batching_config);
+}
+
+absl::Status Engine::SetAdmissionQuota(ModelId model_id,
+                                       int max_pending_jobs) {
+  ModelId version;
+  {
+    ModelReadLock lock(model_mtx_);
+    version = GetModelVersion(model_id);
+    if (model_specs_.find(version) == model_specs_.end()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Model %d is not registered", model_id));
+    }
+  }
+  return planner_->SetAdmissionQuota(version, max_pending_jobs);
+}
+
+CompletionQueueId Engine::CreateCompletionQueue() {
+  return planner_->CreateCompletionQueue();
+}
+
+absl::Status Engine::DestroyCompletionQueue(CompletionQueueId queue_id) {
+  return planner_->DestroyCompletionQueue(queue_id);
+}
+
+absl::StatusOr<JobId> Engine::WaitAny(CompletionQueueId queue_id,
+                                      int64_t timeout_us) {
+  std::shared_ptr<CompletionQueue> completion_queue =
+      planner_->GetCompletionQueue(queue_id);
+  if (completion_queue == nullptr) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Completion queue %d not found.", queue_id));
+  }
+  return completion_queue->Pop(timeout_us);
+}
+
 absl::Status Engine::Init(const RuntimeConfig& config) {
+  tensor_buffer_config_ = config.tensor_buffer_config;
+
   planner_ = std::make_unique<Planner>(*this);
   auto status = planner_->Init(config.planner_config);
   if (!status.ok()) {
@@ -551,8 +1017,12 @@ absl::Status Engine::Init(const RuntimeConfig& config) {
         worker = std::make_unique<GlobalQueueWorker>(this, workers_.size(),
                                                      device_flag);
       } else {
-        worker = std::make_unique<DeviceQueueWorker>(this, workers_.size(),
-                                                     device_flag);
+        auto device_queue_worker = std::make_unique<DeviceQueueWorker>(
+            this, workers_.size(), device_flag);
+        if (config.worker_config.allow_worksteal) {
+          device_queue_worker->AllowWorkSteal();
+        }
+        worker = std::move(device_queue_worker);
       }
 
       if (!worker->Init(config.worker_config).ok()) {
@@ -564,25 +1034,33 @@ absl::Status Engine::Init(const RuntimeConfig& config) {
                ToString(device_flag));
       worker->Start();
       workers_.push_back(std::move(worker));
-      workers_waiting_[i] = 0;
       BAND_TRACER_ADD_WORKER(device_flag, workers_.back()->GetId());
     } else {
       BAND_LOG(LogSeverity::kWarning, "%s worker is not created.",
                ToString(device_flag));
     }
   }
+  workers_waiting_ = std::vector<std::atomic<int64_t>>(workers_.size());
 
   return absl::OkStatus();
 }
 
 void Engine::UpdateWorkersWaiting() const {
-  for (WorkerId worker_id = 0; worker_id < workers_.size(); worker_id++) {
-    workers_waiting_[worker_id] = workers_[worker_id]->GetWaitingTime();
+  for (WorkerId worker_id = 0; worker_id < workers_waiting_.size();
+       worker_id++) {
+    workers_waiting_[worker_id].store(workers_[worker_id]->GetWaitingTime(),
+                                      std::memory_order_relaxed);
   }
 }
 
 WorkerWaitingTime Engine::GetWorkerWaitingTime() const {
-  return workers_waiting_;
+  WorkerWaitingTime workers_waiting;
+  for (WorkerId worker_id = 0; worker_id < workers_waiting_.size();
+       worker_id++) {
+    workers_waiting[worker_id] =
+        workers_waiting_[worker_id].load(std::memory_order_relaxed);
+  }
+  return workers_waiting;
 }
 
 std::set<int> Engine::GetIdleWorkers() const {
@@ -598,6 +1076,7 @@ std::set<int> Engine::GetIdleWorkers() const {
 
 SubgraphKey Engine::GetLargestSubgraphKey(ModelId model_id,
                                           WorkerId worker_id) const {
+  ModelReadLock lock(model_mtx_);
   auto model_executor_it = model_executors_.find({model_id, worker_id});
   if (model_executor_it != model_executors_.end()) {
     return model_executor_it->second->GetLargestSubgraphKey();
@@ -607,6 +1086,7 @@ SubgraphKey Engine::GetLargestSubgraphKey(ModelId model_id,
 }
 
 const ModelSpec* Engine::GetModelSpec(ModelId model_id) const {
+  ModelReadLock lock(model_mtx_);
   if (model_specs_.find(model_id) == model_specs_.end()) {
     return nullptr;
   } else {
@@ -642,7 +1122,19 @@ bool Engine::IsEnd(const SubgraphKey& key) const {
           key.GetUnitIndices().none());
 }
 
+bool Engine::IsLast(const SubgraphKey& key,
+                    const BitMask& resolved_unit_subgraphs) const {
+  if (IsEnd(key)) {
+    return true;
+  }
+  const ModelSpec* model_spec = GetModelSpec(key.GetModelId());
+  return model_spec &&
+         (resolved_unit_subgraphs | key.GetUnitIndices()).count() >=
+             model_spec->GetNumUnitSubgraphs();
+}
+
 bool Engine::HasSubgraph(const SubgraphKey& key) const {
+  ModelReadLock lock(model_mtx_);
   auto model_executor_it =
       model_executors_.find({key.GetModelId(), key.GetWorkerId()});
   return model_executor_it != model_executors_.end() &&
@@ -651,23 +1143,31 @@ bool Engine::HasSubgraph(const SubgraphKey& key) const {
 
 void Engine::ForEachSubgraph(
     std::function<void(const SubgraphKey&)> visitor) const {
+  ModelReadLock lock(model_mtx_);
   for (auto& model_executor : model_executors_) {
     model_executor.second->ForEachSubgraph(visitor);
   }
 }
 
 absl::Status Engine::Invoke(const SubgraphKey& key) {
-  auto model_executor_it =
-      model_executors_.find({key.GetModelId(), key.GetWorkerId()});
-  if (model_executor_it == model_executors_.end()) {
-    return absl::InternalError("Failed to find a subgraph key");
+  // Run without the lock, the executor is kept alive by the reference
+  std::shared_ptr<interface::IModelExecutor> model_executor;
+  {
+    ModelReadLock lock(model_mtx_);
+    auto model_executor_it =
+        model_executors_.find({key.GetModelId(), key.GetWorkerId()});
+    if (model_executor_it == model_executors_.end()) {
+      return absl::InternalError("Failed to find a subgraph key");
+    }
+    model_executor = model_executor_it->second;
   }
-  return model_executor_it->second->ExecuteSubgraph(key);
+  return model_executor->ExecuteSubgraph(key);
 }
 
 std::pair<SubgraphKey, int64_t> Engine::GetShortestLatency(
     ModelId model_id, BitMask resolved_unit_subgraphs, int64_t start_time,
     const std::map<WorkerId, int64_t>& worker_waiting) const {
+  ModelReadLock lock(model_mtx_);
   // lookup key for cache
   std::pair<ModelId, BitMask> cache_key = {model_id, resolved_unit_subgraphs};
 
@@ -681,14 +1181,20 @@ std::pair<SubgraphKey, int64_t> Engine::GetShortestLatency(
     }
   }
 
+  // plans cached before the latencies drifted are discarded
+  const uint64_t epoch = GetLatencyEpoch();
   if (wait_time_is_stale) {
-    auto it = cache_.find(cache_key);
-    if (it != cache_.end()) {
-      auto& pair = it->second;
+    std::lock_guard<std::mutex> cache_lock(cache_mtx_);
+    if (cache_epoch_ != epoch) {
+      cache_.Clear();
+      cache_epoch_ = epoch;
+    }
+    const std::pair<SubgraphKey, int64_t>* pair = cache_.Get(cache_key);
+    if (pair) {
       // the stored latency value assumes a start_time of 0,
       // so we need to add our own start_time to the stored value to get the
       // correct return value
-      return {pair.first, pair.second + start_time};
+      return {pair->first, pair->second + start_time};
     }
   }
 
@@ -715,7 +1221,7 @@ std::pair<SubgraphKey, int64_t> Engine::GetShortestLatency(
         GetShortestSubgraphKey(it.second, start_time, worker_waiting);
 
     std::pair<SubgraphKey, int64_t> local_min;
-    if (IsEnd(target_subgraph.first)) {
+    if (IsLast(target_subgraph.first, resolved_unit_subgraphs)) {
       local_min = target_subgraph;
     } else {
       local_min = GetShortestLatency(
@@ -734,16 +1240,18 @@ std::pair<SubgraphKey, int64_t> Engine::GetShortestLatency(
     }
   }
 
-  if (wait_time_is_stale) {
-    // if we've reached this point, then there shouldn't be an entry
-    // for this key in the cache
-    assert(cache_.find(cache_key) == cache_.end());
+  // a search without any plan is not cached, so that it is retried
+  if (wait_time_is_stale && subgraph_min_latency.first.IsValid()) {
     // we are going to store the latency value for start_time == 0,
     // so do a sanity check for latency - start_time
     assert(subgraph_min_latency.second >= start_time);
 
-    cache_[cache_key] = {subgraph_min_latency.first,
-                         subgraph_min_latency.second - start_time};
+    // skip if the latencies drifted during the search
+    std::lock_guard<std::mutex> cache_lock(cache_mtx_);
+    if (cache_epoch_ == epoch) {
+      cache_.Put(cache_key, {subgraph_min_latency.first,
+                             subgraph_min_latency.second - start_time});
+    }
   }
 
   return subgraph_min_latency;
@@ -753,71 +1261,88 @@ std::pair<std::vector<SubgraphKey>, int64_t>
 Engine::GetShortestLatencyWithUnitSubgraph(
     ModelId model_id, int start_unit_idx,
     const std::map<WorkerId, int64_t>& worker_waiting) const {
-  const ModelSpec* model_spec = GetModelSpec(model_id);
-  // vector for memoization during scheduling.
-  // Each element is a pair of subgraph indices list and shortest latency.
-  std::vector<std::pair<std::vector<SubgraphKey>, int64_t>> memo;
-  const size_t num_unit_subgraphs = model_spec->GetNumUnitSubgraphs();
-  memo.resize(num_unit_subgraphs);
-
+  ModelReadLock lock(model_mtx_);
+  auto table_it = unit_subgraph_tables_.find(model_id);
+  if (table_it == unit_subgraph_tables_.end()) {
+    return {{}, -1};
+  }
+  UnitSubgraphTable& table = table_it->second;
+  const int num_unit_subgraphs = table.num_unit_subgraphs;
+  constexpr int kMaxUnitSubgraphs = BitMask().size();
   assert(start_unit_idx < num_unit_subgraphs);
-
-  // Initialize memo.
-  for (int i = 0; i < num_unit_subgraphs; ++i) {
-    memo[i] = std::make_pair<std::vector<SubgraphKey>, int64_t>(
-        {}, std::numeric_limits<int>::max());
+  assert(num_unit_subgraphs <= kMaxUnitSubgraphs);
+
+  std::lock_guard<std::mutex> expected_lock(table.expected_mtx);
+  const uint64_t epoch =
+      latency_estimator_ ? latency_estimator_->GetEpoch() : 0;
+  if (table.epoch != epoch) {
+    if (latency_estimator_) {
+      latency_estimator_->GetExpected(table.keys, table.expected);
+    } else {
+      table.expected.assign(table.keys.size(), 0);
+    }
+    table.epoch = epoch;
   }
 
   // `i` and `j` refer to an unit subgraph idx.
   // A subgraph(i, j) consists of the unit subgraphs in [i, j].
   // The goal of the algorithm is to find the minimum expected latency;
-  // `memo[k].second` is the minimum expected latency of the
-  // subgraph(start_unit_idx, k). `memo[k].first` is the list of subgraph
-  // indices of the best execution plan. So, the shortest expected latency of a
+  // `memo[k]` is the minimum expected latency of the
+  // subgraph(start_unit_idx, k), or -1 if no plan covers it. The last
+  // subgraph of the plan is `keys[last_key[k]]`, which starts at
+  // `last_start[k]`. So, the shortest expected latency of a
   // subgraph(start_unit_idx, num_unit_subgraphs - 1) is
-  // `memo[num_unit_subgraphs - 1].second`.
+  // `memo[num_unit_subgraphs - 1]`.
+  std::array<int64_t, kMaxUnitSubgraphs> memo;
+  std::array<uint32_t, kMaxUnitSubgraphs> last_key;
+  std::array<int, kMaxUnitSubgraphs> last_start;
   for (int j = start_unit_idx; j < num_unit_subgraphs; ++j) {
-    std::pair<std::vector<SubgraphKey>, int64_t> local_min =
-        std::make_pair<std::vector<SubgraphKey>, int64_t>({}, -1);
+    memo[j] = -1;
     for (int i = j; i >= start_unit_idx; --i) {
+      const std::pair<uint32_t, uint32_t>& span =
+          table.spans[i * num_unit_subgraphs + j];
       // Check if the subgraph(i, j) is valid.
-      if (unit_subgraphs_to_subgraph_keys_.find(model_id) ==
-          unit_subgraphs_to_subgraph_keys_.end()) {
-        continue;
-      }
-      if (unit_subgraphs_to_subgraph_keys_.at(model_id).find(i) ==
-          unit_subgraphs_to_subgraph_keys_.at(model_id).end()) {
-        continue;
-      }
-      if (unit_subgraphs_to_subgraph_keys_.at(model_id).at(i).find(j) ==
-          unit_subgraphs_to_subgraph_keys_.at(model_id).at(i).end()) {
+      if (span.first == span.second ||
+          (i > start_unit_idx && memo[i - 1] == -1)) {
         continue;
       }
 
       // Search from the profile result of the unit subgraph.
-      const auto& subgraph_keys =
-          unit_subgraphs_to_subgraph_keys_.at(model_id).at(i).at(j);
-
-      int64_t start = i > start_unit_idx ? memo[i - 1].second : 0;
-      std::pair<SubgraphKey, int64_t> target_subgraph =
-          GetShortestSubgraphKey(subgraph_keys, start, worker_waiting);
-
-      if (local_min.second == -1 || target_subgraph.second < local_min.second) {
-        if (i > start_unit_idx) {
-          local_min.first = memo[i - 1].first;
-          local_min.first.push_back(target_subgraph.first);
-          local_min.second = target_subgraph.second;
-        } else {
-          local_min.first.clear();
-          local_min.first.push_back(target_subgraph.first);
-          local_min.second = target_subgraph.second;
+      const int64_t start = i > start_unit_idx ? memo[i - 1] : 0;
+      int64_t min_latency = std::numeric_limits<int64_t>::max();
+      uint32_t min_key = span.first;
+      for (uint32_t k = span.first; k < span.second; ++k) {
+        // TODO: safety check to avoid contention with profiler?
+        const int64_t waiting_time =
+            worker_waiting.at(table.keys[k].GetWorkerId());
+        const int64_t total =
+            table.expected[k] + std::max(waiting_time, start);
+        if (min_latency >= total) {
+          min_latency = total;
+          min_key = k;
         }
       }
+
+      if (memo[j] == -1 || min_latency < memo[j]) {
+        memo[j] = min_latency;
+        last_key[j] = min_key;
+        last_start[j] = i;
+      }
     }
-    memo[j] = local_min;
   }
 
-  return memo[num_unit_subgraphs - 1];
+  // Follow the back pointers from the last unit subgraph
+  std::pair<std::vector<SubgraphKey>, int64_t> ret = {
+      {}, memo[num_unit_subgraphs - 1]};
+  if (ret.second == -1) {
+    return ret;
+  }
+  for (int j = num_unit_subgraphs - 1; j >= start_unit_idx;
+       j = last_start[j] - 1) {
+    ret.first.push_back(table.keys[last_key[j]]);
+  }
+  std::reverse(ret.first.begin(), ret.first.end());
+  return ret;
 }
 
 std::pair<std::vector<SubgraphKey>, int64_t>
@@ -840,6 +1365,12 @@ Engine::GetSubgraphWithShortestLatency(
         start_unit_idx = i + 1;
       }
     }
+    if (job.resolved_unit_subgraphs.count() != start_unit_idx) {
+      // The contiguous search only covers a resolved prefix, not a branch
+      auto pair = GetShortestLatency(
+          job.model_id, job.resolved_unit_subgraphs, 0, worker_waiting);
+      return {{pair.first}, pair.second};
+    }
     return GetShortestLatencyWithUnitSubgraph(job.model_id, start_unit_idx,
                                               worker_waiting);
   }
@@ -848,45 +1379,86 @@ Engine::GetSubgraphWithShortestLatency(
 SubgraphKey Engine::GetSubgraphIdxSatisfyingSLO(
     const Job& job, const std::map<WorkerId, int64_t>& worker_waiting,
     const std::set<WorkerId>& idle_workers) const {
-  // TODO: implement this with SLO-based scheduler e.g., LSF
-  BAND_NOT_IMPLEMENTED;
-  return {};
+  if (job.slo_us <= 0) {
+    return {};
+  }
+  // Waiting times are relative to now, and so is the time left
+  const int64_t time_left = job.enqueue_time + job.slo_us - time::NowMicros();
+  if (time_left <= 0) {
+    return {};
+  }
+
+  ModelReadLock lock(model_mtx_);
+  // Among the plans that meet the deadline, take the one that finishes the
+  // latest, which leaves faster or less contended workers to tighter jobs
+  SubgraphKey satisfying_key = {};
+  int64_t satisfying_latency = -1;
+  for (const SubgraphKey& key :
+       GetSubgraphCandidates(job.model_id, job.resolved_unit_subgraphs)) {
+    if (idle_workers.find(key.GetWorkerId()) == idle_workers.end()) {
+      continue;
+    }
+    auto waiting_it = worker_waiting.find(key.GetWorkerId());
+    int64_t latency =
+        (waiting_it != worker_waiting.end() ? waiting_it->second : 0) +
+        GetExpected(key);
+    if (!IsLast(key, job.resolved_unit_subgraphs)) {
+      latency = GetShortestLatency(
+                    job.model_id,
+                    job.resolved_unit_subgraphs | key.GetUnitIndices(),
+                    latency, worker_waiting)
+                    .second;
+    }
+    if (latency <= time_left && latency > satisfying_latency) {
+      satisfying_key = key;
+      satisfying_latency = latency;
+    }
+  }
+  return satisfying_key;
 }
 
 std::vector<SubgraphKey> Engine::GetSubgraphCandidates(
     ModelId model_id, BitMask resolved_unit_subgraphs) const {
+  ModelReadLock lock(model_mtx_);
+  const std::pair<ModelId, BitMask> cache_key = {model_id,
+                                                 resolved_unit_subgraphs};
+  {
+    std::lock_guard<std::mutex> cache_lock(cache_mtx_);
+    const std::vector<SubgraphKey>* cached_candidates =
+        candidate_cache_.Get(cache_key);
+    if (cached_candidates) {
+      return *cached_candidates;
+    }
+  }
+
   std::vector<SubgraphKey> candidates;
-  if (resolved_unit_subgraphs.none()) {
-    for (const auto& model_executor : model_executors_) {
-      if (model_executor.first.first == model_id) {
-        model_executor.second->ForEachSubgraph(
-            [this, &candidates](const SubgraphKey& key) {
-              if (IsBegin(key)) {
-                candidates.push_back(key);
-              }
-            });
+  auto table_it = unit_subgraph_tables_.find(model_id);
+  if (table_it == unit_subgraph_tables_.end()) {
+    return candidates;
+  }
+  const UnitSubgraphTable& table = table_it->second;
+  for (size_t i = 0; i < table.candidates.size(); i++) {
+    const SubgraphKey& key = table.candidates[i];
+    if (resolved_unit_subgraphs.none()) {
+      if (table.is_begin[i]) {
+        candidates.push_back(key);
       }
+      continue;
     }
-  } else {
-    for (const auto& model_executor : model_executors_) {
-      if (model_executor.first.first == model_id) {
-        model_executor.second->ForEachSubgraph([&](const SubgraphKey& key) {
-          // skip if already executed
-          if ((key.GetUnitIndices() & resolved_unit_subgraphs).any()) {
-            return;
-          }
-          const BitMask external_dependencies =
-              GetModelSpec(model_id)->GetUnitSubgraphDependency(
-                  key.GetUnitIndices());
-          // include if all external dependencies are resolved
-          if (external_dependencies ==
-              (external_dependencies & resolved_unit_subgraphs)) {
-            candidates.push_back(key);
-          }
-        });
-      }
+    // skip if already executed
+    if ((key.GetUnitIndices() & resolved_unit_subgraphs).any()) {
+      continue;
+    }
+    // include if all external dependencies are resolved
+    const BitMask& external_dependencies = table.external_dependencies[i];
+    if (external_dependencies ==
+        (external_dependencies & resolved_unit_subgraphs)) {
+      candidates.push_back(key);
     }
   }
+
+  std::lock_guard<std::mutex> cache_lock(cache_mtx_);
+  candidate_cache_.Put(cache_key, candidates);
   return candidates;
 }
 
@@ -915,6 +1487,10 @@ void Engine::UpdateLatency(const SubgraphKey& key, int64_t latency) {
   if (latency_estimator_) latency_estimator_->UpdateLatency(key, latency);
 }
 
+bool Engine::ProfileStep(WorkerId worker_id) {
+  return latency_estimator_->ProfileStep(worker_id);
+}
+
 int64_t Engine::GetProfiled(const SubgraphKey& key) const {
   return latency_estimator_ ? latency_estimator_->GetProfiled(key) : 0;
 }
@@ -923,6 +1499,10 @@ int64_t Engine::GetExpected(const SubgraphKey& key) const {
   return latency_estimator_ ? latency_estimator_->GetExpected(key) : 0;
 }
 
+uint64_t Engine::GetLatencyEpoch() const {
+  return latency_estimator_ ? latency_estimator_->GetDriftEpoch() : 0;
+}
+
 int64_t Engine::GetWorst(ModelId model_id) const {
   // requires nullity check for schedulers without profile
   return latency_estimator_ ? latency_estimator_->GetWorst(model_id) : 0;
@@ -968,19 +1548,42 @@ Worker* Engine::GetWorker(WorkerId id) {
 }
 
 absl::Status Engine::TryCopyInputTensors(const Job& job) {
+  ModelReadLock lock(model_mtx_);
+  const SubgraphKey& key = job.subgraph_key;
+  auto model_executor = GetModelExecutor(job.subgraph_key);
+
+  {
+    // Resize the batch dimension for (or back from) dynamic batching
+    auto status = model_executor->ResizeBatch(key, job.batch_size);
+    if (!status.ok() &&
+        (job.batch_size > 1 || !absl::IsUnimplemented(status))) {
+      return status;
+    }
+  }
+
+  if (job.batch_size > 1) {
+    return CopyBatchedInputTensors(job);
+  }
+
+  static const JobState empty_state;
+  const JobState* state = planner_->GetJobArena().Get(job.handle);
+  if (state == nullptr) {
+    state = &empty_state;
+  }
+
   // Skip all tensor communication for compute only case.
-  if (job.input_handle < 0) {
+  if (job.input_handle < 0 && state->bound_inputs.empty()) {
     return absl::OkStatus();
   }
 
-  const SubgraphKey& key = job.subgraph_key;
-  auto model_executor = GetModelExecutor(job.subgraph_key);
   std::set<int> unresolved_tensors(model_executor->GetInputs(key).begin(),
                                    model_executor->GetInputs(key).end());
 
-  // Intermediate tensor communication
-  for (auto subgraph_it = job.previous_subgraph_keys.cbegin();
-       subgraph_it != job.previous_subgraph_keys.cend(); ++subgraph_it) {
+  // Intermediate tensor communication. Other branches of the job may add
+  // their subgraphs meanwhile.
+  std::unique_lock<std::mutex> state_lock(state->mtx);
+  for (auto subgraph_it = state->previous_subgraph_keys.cbegin();
+       subgraph_it != state->previous_subgraph_keys.cend(); ++subgraph_it) {
     SubgraphKey preceded_subgraph_key = *subgraph_it;
     auto preceded_model_executor = GetModelExecutor(preceded_subgraph_key);
 
@@ -1003,6 +1606,37 @@ absl::Status Engine::TryCopyInputTensors(const Job& job) {
       }
     }
   }
+  state_lock.unlock();
+
+  // Bind caller-owned model inputs, or copy directly from them if the
+  // backend cannot use the memory as is
+  if (!state->bound_inputs.empty()) {
+    const std::set<int>& input_tensors =
+        model_specs_.at(job.model_id).input_tensors;
+    size_t input_index = 0;
+    for (int tensor_index : input_tensors) {
+      const interface::ITensor* src = state->bound_inputs[input_index++];
+      if (unresolved_tensors.find(tensor_index) == unresolved_tensors.end()) {
+        continue;
+      }
+      if (!model_executor->BindInputTensor(key, tensor_index, src).ok() &&
+          !model_executor->GetTensorView(key, tensor_index)
+               ->CopyDataFrom(src)
+               .ok()) {
+        // The execution is skipped, so nothing releases the bound inputs
+        model_executor->ReleaseInputTensors(key).IgnoreError();
+        return absl::InternalError(
+            absl::StrFormat("Failed to bind input tensor %d for model %d",
+                            tensor_index, job.model_id));
+      }
+      unresolved_tensors.erase(tensor_index);
+    }
+    if (!unresolved_tensors.empty()) {
+      model_executor->ReleaseInputTensors(key).IgnoreError();
+      return absl::InternalError("Some tensors fail to be resolved.");
+    }
+    return absl::OkStatus();
+  }
 
   if (model_input_buffer_.find(job.model_id) == model_input_buffer_.end()) {
     return absl::InternalError(absl::StrFormat(
@@ -1039,7 +1673,11 @@ absl::Status Engine::TryCopyInputTensors(const Job& job) {
 }
 
 absl::Status Engine::TryCopyOutputTensors(const Job& job) {
+  ModelReadLock lock(model_mtx_);
   // TODO: Subgraph execution
+  if (job.batch_size > 1) {
+    return CopyBatchedOutputTensors(job);
+  }
 
   // Compute only.
   if (job.output_handle < 0) {
@@ -1072,6 +1710,166 @@ absl::Status Engine::TryCopyOutputTensors(const Job& job) {
   return absl::OkStatus();
 }
 
+absl::Status Engine::CopyBatchedInputTensors(const Job& job) {
+  const SubgraphKey& key = job.subgraph_key;
+  if (!IsBegin(key) || !IsEnd(key)) {
+    return absl::InternalError(absl::StrFormat(
+        "Batched job %d should run the whole model", job.job_id));
+  }
+  auto model_executor = GetModelExecutor(key);
+  auto input_buffer_it = model_input_buffer_.find(job.model_id);
+  if (input_buffer_it == model_input_buffer_.end()) {
+    return absl::InternalError(absl::StrFormat(
+        "Failed to find input tensor ring buffer for model %d", job.model_id));
+  }
+  TensorRingBuffer* input_buffer = input_buffer_it->second.get();
+  const JobState* state = planner_->GetJobArena().Get(job.handle);
+  if (state == nullptr || state->batched_jobs.size() + 1 !=
+                              static_cast<size_t>(job.batch_size)) {
+    return absl::InternalError(
+        absl::StrFormat("Invalid batch state of job %d", job.job_id));
+  }
+
+  size_t input_index = 0;
+  for (int tensor_index : model_specs_.at(job.model_id).input_tensors) {
+    std::shared_ptr<interface::ITensorView> dst =
+        model_executor->GetTensorView(key, tensor_index);
+    for (int batch_index = 0; batch_index < job.batch_size; batch_index++) {
+      const Job& batched_job =
+          batch_index == 0 ? job : state->batched_jobs[batch_index - 1];
+      const JobState* batched_state =
+          batch_index == 0 ? state
+                           : planner_->GetJobArena().Get(batched_job.handle);
+      BatchSlice slice(dst.get(), batch_index);
+      absl::Status status = absl::OkStatus();
+      if (batched_state && !batched_state->bound_inputs.empty()) {
+        status = slice.CopyDataFrom(batched_state->bound_inputs[input_index]);
+      } else if (batched_job.input_handle >= 0) {
+        status = input_buffer->GetTensorFromHandle(&slice, tensor_index,
+                                                   batched_job.input_handle);
+      }
+      if (!status.ok()) {
+        return absl::InternalError(absl::StrFormat(
+            "Failed to copy input tensor %d for batched job %d",
+            tensor_index, batched_job.job_id));
+      }
+    }
+    input_index++;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status Engine::CopyBatchedOutputTensors(const Job& job) {
+  const SubgraphKey& key = job.subgraph_key;
+  auto model_executor = GetModelExecutor(key);
+  auto output_buffer_it = model_output_buffer_.find(job.model_id);
+  if (output_buffer_it == model_output_buffer_.end()) {
+    return absl::InternalError(absl::StrFormat(
+        "Failed to find output tensor ring buffer for model %d", job.model_id));
+  }
+  TensorRingBuffer* output_buffer = output_buffer_it->second.get();
+  const JobState* state = planner_->GetJobArena().Get(job.handle);
+  if (state == nullptr || state->batched_jobs.size() + 1 !=
+                              static_cast<size_t>(job.batch_size)) {
+    return absl::InternalError(
+        absl::StrFormat("Invalid batch state of job %d", job.job_id));
+  }
+
+  for (int tensor_index : model_executor->GetOutputs(key)) {
+    if (!output_buffer->IsTensorIndexValid(tensor_index)) {
+      continue;
+    }
+    std::shared_ptr<interface::ITensorView> src =
+        model_executor->GetTensorView(key, tensor_index);
+    for (int batch_index = 0; batch_index < job.batch_size; batch_index++) {
+      const Job& batched_job =
+          batch_index == 0 ? job : state->batched_jobs[batch_index - 1];
+      if (batched_job.output_handle < 0) {
+        continue;
+      }
+      BatchSlice slice(src.get(), batch_index);
+      if (!output_buffer
+               ->PutTensorToHandle(&slice, tensor_index,
+                                   batched_job.output_handle)
+               .ok()) {
+        return absl::InternalError(absl::StrFormat(
+            "Failed to copy output tensor %d for batched job %d",
+            tensor_index, batched_job.job_id));
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+void Engine::ReleaseJobTensors(const Job& job) {
+  {
+    std::lock_guard<std::mutex> lock(num_inflight_jobs_mtx_);
+    if (--num_inflight_jobs_[job.model_id] <= 0) {
+      num_inflight_jobs_.erase(job.model_id);
+      model_drained_.notify_all();
+    }
+  }
+
+  ModelReadLock lock(model_mtx_);
+  if (job.input_handle >= 0 &&
+      model_input_buffer_.find(job.model_id) != model_input_buffer_.end()) {
+    model_input_buffer_.at(job.model_id)
+        ->Release(job.input_handle)
+        .IgnoreError();
+  }
+  // Keep the outputs until they are read or discarded.
+  // Nobody reads the outputs of a failed, cancelled or shed job.
+  if (job.output_handle >= 0 &&
+      model_output_buffer_.find(job.model_id) != model_output_buffer_.end()) {
+    if (job.status != JobStatus::kSuccess) {
+      model_output_buffer_.at(job.model_id)
+          ->Release(job.output_handle)
+          .IgnoreError();
+    } else {
+      std::lock_guard<std::mutex> outputs_lock(outputs_mtx_);
+      unread_outputs_[job.job_id] = {job.model_id, job.output_handle};
+    }
+  }
+}
+
+absl::StatusOr<Job> Engine::GetFinishedJobWithOutputs(JobId job_id) const {
+  if (job_id == -1) {
+    return absl::InternalError("Invalid job id");
+  }
+
+  Job job = planner_->GetFinishedJob(job_id);
+
+  // Not finished or invalidated
+  if (job.job_id == -1) {
+    return absl::InternalError("Invalid job id / not finished or invalidated.");
+  }
+
+  if (job.output_handle == -1) {
+    return absl::InternalError(
+        absl::StrFormat("Invalid output handle : %d", job.output_handle));
+  }
+
+  if (job.status == JobStatus::kSLOViolation) {
+    return absl::DeadlineExceededError("SLO violation");
+  } else if (job.status == JobStatus::kCancelled) {
+    return absl::CancelledError(absl::StrFormat("Job %d is cancelled", job_id));
+  } else if (job.status == JobStatus::kRejected) {
+    return absl::ResourceExhaustedError(
+        absl::StrFormat("Job %d is rejected by admission control", job_id));
+  } else if (job.status != JobStatus::kSuccess) {
+    return absl::InternalError(
+        absl::StrFormat("Job failed with status : %s", ToString(job.status)));
+  }
+
+  ModelReadLock lock(model_mtx_);
+  if (model_output_buffer_.find(job.model_id) == model_output_buffer_.end()) {
+    return absl::InternalError(
+        absl::StrFormat("Invalid model id : %d", job.model_id));
+  }
+
+  return job;
+}
+
 WorkerId Engine::GetDeviceWorkerId(DeviceFlag flag) const {
   for (WorkerId worker_id = 0; worker_id < workers_.size(); worker_id++) {
     if (workers_[worker_id]->GetDeviceFlag() == flag) {
@@ -1084,12 +1882,14 @@ WorkerId Engine::GetDeviceWorkerId(DeviceFlag flag) const {
 }
 
 interface::IModelExecutor* Engine::GetModelExecutor(const SubgraphKey& key) {
+  ModelReadLock lock(model_mtx_);
   auto it = model_executors_.find({key.GetModelId(), key.GetWorkerId()});
   return it != model_executors_.end() ? it->second.get() : nullptr;
 }
 
 const interface::IModelExecutor* Engine::GetModelExecutor(
     const SubgraphKey& key) const {
+  ModelReadLock lock(model_mtx_);
   auto it = model_executors_.find({key.GetModelId(), key.GetWorkerId()});
   return it != model_executors_.end() ? it->second.get() : nullptr;
 }
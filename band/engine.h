@@ -17,10 +17,15 @@
 #ifndef BAND_ENGINE_H_
 #define BAND_ENGINE_H_
 
+#include <atomic>
+#include <condition_variable>
 #include <deque>
 #include <functional>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <set>
+#include <shared_mutex>
 #include <vector>
 
 #include "band/common.h"
@@ -28,6 +33,7 @@
 #include "band/engine_interface.h"
 #include "band/interface/model_executor.h"
 #include "band/interface/tensor.h"
+#include "band/lru_cache.h"
 #include "band/tensor_ring_buffer.h"
 
 namespace band {
@@ -69,7 +75,13 @@ class Engine : public IEngine {
   static std::unique_ptr<Engine> Create(const RuntimeConfig& config);
 
   absl::Status RegisterModel(Model* model);
+  // Stops accepting requests of the model and waits for the admitted ones
+  // before releasing it.
   absl::Status UnregisterModel(Model* model);
+  // Routes the requests of `model` to the newly registered `new_model` at
+  // once. Requests keep using the id of `model`, and the ones admitted before
+  // the switch finish on the previous version, which is released after them.
+  absl::Status ReplaceModel(Model* model, Model* new_model);
 
   Tensor* CreateTensor(ModelId model_id, int tensor_index);
   std::vector<int> GetOutputTensorIndices(ModelId model_id) const;
@@ -86,6 +98,8 @@ class Engine : public IEngine {
                            std::vector<RequestOption> options = {},
                            std::vector<Tensors> inputs = {},
                            std::vector<Tensors> outputs = {});
+  // If `RequestOption::zero_copy_input` is set, `inputs` are read in place by
+  // the backend and must stay valid until the request finishes.
   absl::StatusOr<JobId> RequestAsync(
       ModelId model_id,
       RequestOption options = RequestOption::GetDefaultOption(),
@@ -94,19 +108,58 @@ class Engine : public IEngine {
       std::vector<ModelId> model_ids, std::vector<RequestOption> options = {},
       std::vector<Tensors> inputs = {});
 
+  // Waits for the jobs and copies their outputs. The outputs of the jobs
+  // without `outputs` are discarded.
   absl::Status Wait(JobId job_id, Tensors outputs = {});
   absl::Status Wait(std::vector<JobId> job_ids,
                     std::vector<Tensors> outputs = {});
   void WaitAll();
+  // Cancel unfinished requests. Queued requests are dropped and the remaining
+  // subgraphs of a running request are skipped. Waiting for a cancelled
+  // request returns Cancelled.
+  absl::Status Cancel(JobId job_id);
+  absl::Status Cancel(std::vector<JobId> job_ids);
+  // Copy the outputs of a finished job. The outputs can be read only once,
+  // by either a copy or a lease, and a second read fails.
   absl::Status GetOutputTensors(JobId job_id, Tensors outputs = {});
+  // Borrow the output tensors of a finished job without copy. The tensors are
+  // read-only and never reused by other jobs until `ReleaseOutputTensors`.
+  absl::StatusOr<std::vector<const interface::ITensor*>> LeaseOutputTensors(
+      JobId job_id);
+  absl::Status ReleaseOutputTensors(JobId job_id);
+  // Free the outputs of a finished job without reading them. Unread outputs
+  // keep their slots until they are read or discarded, until the finished
+  // job is evicted, or until a new request of the model needs the slot. The
+  // oldest unread outputs give way first, and requests of the model fail
+  // with ResourceExhausted only while all of its output slots are in use or
+  // leased.
+  absl::Status DiscardOutputTensors(JobId job_id) override;
+
+  // Merge queued requests of the model into a batched invocation.
+  absl::Status SetBatchingConfig(ModelId model_id,
+                                 const BatchingConfig& batching_config);
+  // Overrides `PlannerConfig::max_pending_jobs_per_model` for the model.
+  // Fails with FailedPrecondition without a shedding policy.
+  absl::Status SetAdmissionQuota(ModelId model_id, int max_pending_jobs);
 
   // Sets the callback function pointer to report the end of invoke.
   CallbackId SetOnEndRequest(
       std::function<void(int, absl::Status)> on_end_request);
   absl::Status UnsetOnEndRequest(CallbackId callback_id);
 
+  // Completion queue for requests with `RequestOption::completion_queue`.
+  CompletionQueueId CreateCompletionQueue();
+  // Pending and future waiters of the queue return Cancelled.
+  absl::Status DestroyCompletionQueue(CompletionQueueId queue_id);
+  // Returns the id of the next finished job of the queue in the order of
+  // completion. Blocks if `timeout_us` is negative, otherwise returns
+  // DeadlineExceeded if no job finished within `timeout_us` (0 to poll).
+  absl::StatusOr<JobId> WaitAny(CompletionQueueId queue_id,
+                                int64_t timeout_us = -1);
+
   int64_t GetProfiled(const SubgraphKey& key) const override;
   int64_t GetExpected(const SubgraphKey& key) const override;
+  uint64_t GetLatencyEpoch() const override;
   SubgraphKey GetLargestSubgraphKey(ModelId model_id,
                                     WorkerId worker_id) const override;
 
@@ -151,9 +204,15 @@ class Engine : public IEngine {
   std::pair<SubgraphKey, int64_t> GetShortestSubgraphKey(
       const std::vector<SubgraphKey>& subgraph_keys, int64_t start_time,
       const std::map<WorkerId, int64_t>& worker_waiting) const;
+  // Returns true if nothing is left to run after the key for a job with the
+  // resolved unit subgraphs. The last key of a branch may not be the end of
+  // the model.
+  bool IsLast(const SubgraphKey& key,
+              const BitMask& resolved_unit_subgraphs) const;
 
   /* latency estimator */
   void UpdateLatency(const SubgraphKey& key, int64_t latency) override;
+  bool ProfileStep(WorkerId worker_id) override;
   int64_t GetWorst(ModelId model_id) const;
 
   /* planner */
@@ -171,8 +230,26 @@ class Engine : public IEngine {
   /* tensor communication */
   absl::Status TryCopyInputTensors(const Job& job) override;
   absl::Status TryCopyOutputTensors(const Job& job) override;
+  void ReleaseJobTensors(const Job& job) override;
 
   /* helper functions */
+  absl::Status RegisterBackendModel(Model* model, BackendType backend_type);
+  // Allocates the slots of a request. Requires `model_mtx_`.
+  absl::StatusOr<Job> CreateJob(ModelId requested_model_id,
+                                const RequestOption& option,
+                                const Tensors* inputs);
+  // Frees the slots of a request that is not enqueued.
+  void DiscardJob(const Job& job);
+  // Frees the slot of the oldest unread outputs of the model. Returns false
+  // if the model has no unread outputs. Requires `model_mtx_`.
+  bool EvictOldestUnreadOutputs(ModelId model_id);
+  // Current version of the model. Requires `model_mtx_`.
+  ModelId GetModelVersion(ModelId model_id) const;
+  void WaitForModelDrain(ModelId model_id);
+  void ReleaseModel(ModelId model_id);
+  absl::Status CopyBatchedInputTensors(const Job& job);
+  absl::Status CopyBatchedOutputTensors(const Job& job);
+  absl::StatusOr<Job> GetFinishedJobWithOutputs(JobId job_id) const;
   WorkerId GetDeviceWorkerId(DeviceFlag flag) const;
   interface::IModelExecutor* GetModelExecutor(const SubgraphKey& key);
   const interface::IModelExecutor* GetModelExecutor(
@@ -185,12 +262,17 @@ class Engine : public IEngine {
   Engine& operator=(const Engine&&) = delete;
 
   SubgraphConfig subgraph_config_;
+  TensorBufferConfig tensor_buffer_config_;
+
+  // Guards the model tables against (un)registration while serving
+  mutable std::shared_mutex model_mtx_;
 
   std::map<std::pair<ModelId, WorkerId>,
-           std::unique_ptr<interface::IModelExecutor>>
+           std::shared_ptr<interface::IModelExecutor>>
       model_executors_;
   std::vector<std::unique_ptr<Worker>> workers_;
-  mutable WorkerWaitingTime workers_waiting_;
+  // Waiting time per worker id, shared by the planner threads without a lock
+  mutable std::vector<std::atomic<int64_t>> workers_waiting_;
   std::unique_ptr<LatencyEstimator> latency_estimator_;
   std::unique_ptr<Planner> planner_;
 
@@ -200,18 +282,55 @@ class Engine : public IEngine {
   std::map<ModelId, ModelSpec> model_specs_;
   std::map<ModelId, std::unique_ptr<TensorRingBuffer>> model_input_buffer_;
   std::map<ModelId, std::unique_ptr<TensorRingBuffer>> model_output_buffer_;
+  // Requested model id to the id of its current version
+  std::map<ModelId, ModelId> model_versions_;
+  // Released versions whose outputs are not consumed yet
+  std::set<ModelId> retired_models_;
+  // Admitted jobs per model version, to drain a version before release
+  std::mutex num_inflight_jobs_mtx_;
+  std::condition_variable model_drained_;
+  std::map<ModelId, int> num_inflight_jobs_;
+  // Output slots of finished jobs, by job id
+  std::mutex outputs_mtx_;
+  std::map<JobId, std::pair<ModelId, int>> unread_outputs_;
+  // Output slots borrowed by `LeaseOutputTensors`
+  std::map<JobId, std::pair<ModelId, int>> output_leases_;
 
   // Scheduling
-  // cache for GetShortestLatency()
-  mutable std::unordered_map<std::pair<ModelId, BitMask>,
-                             std::pair<SubgraphKey, int64_t>, JobIdBitMaskHash>
-      cache_;
-
-  // Find subgraph indices with the (model_id, start_unit_idx, end_unit_idx).
+  // Bounds the entries of each cache below
+  static constexpr size_t kMaxCacheEntries = 4096;
+  mutable std::mutex cache_mtx_;
+  // cache for GetShortestLatency() with idle workers, valid as long as the
+  // latency estimator drift epoch is `cache_epoch_`
+  mutable LruCache<std::pair<ModelId, BitMask>,
+                   std::pair<SubgraphKey, int64_t>, JobIdBitMaskHash>
+      cache_{kMaxCacheEntries};
+  mutable uint64_t cache_epoch_ = 0;
+  // cache for GetSubgraphCandidates()
+  mutable LruCache<std::pair<ModelId, BitMask>, std::vector<SubgraphKey>,
+                   JobIdBitMaskHash>
+      candidate_cache_{kMaxCacheEntries};
+
+  // Subgraphs of a model by their (start_unit_idx, end_unit_idx), flattened
+  // for the unit-level search.
   // NOTE: we assume every subgraph consists of unit subgraphs with the
   // continuous unit subgraph indices.
-  std::map<int, std::map<int, std::map<int, std::vector<SubgraphKey>>>>
-      unit_subgraphs_to_subgraph_keys_;
+  struct UnitSubgraphTable {
+    size_t num_unit_subgraphs = 0;
+    // Range of `keys` for the subgraph (i, j) at `i * num_unit_subgraphs + j`
+    std::vector<std::pair<uint32_t, uint32_t>> spans;
+    std::vector<SubgraphKey> keys;
+    // All subgraphs in the order of the model executors, with the unit
+    // subgraphs they depend on outside of themselves
+    std::vector<SubgraphKey> candidates;
+    std::vector<BitMask> external_dependencies;
+    std::vector<bool> is_begin;
+    // Expected latency of each key, as of the latency estimator `epoch`
+    std::mutex expected_mtx;
+    std::vector<int64_t> expected;
+    uint64_t epoch = std::numeric_limits<uint64_t>::max();
+  };
+  mutable std::map<ModelId, UnitSubgraphTable> unit_subgraph_tables_;
 };  // namespace band
 }  // namespace band
 
@@ -101,6 +101,9 @@ class IEngine {
       const Job& job,
       const std::map<WorkerId, int64_t>& worker_waiting) const = 0;
 
+  // Return the first subgraph of the plan that finishes the latest while
+  // still meeting the SLO of the job, among the plans that start on one of
+  // the idle workers. An invalid key if no such plan exists.
   virtual SubgraphKey GetSubgraphIdxSatisfyingSLO(
       const Job& job, const std::map<WorkerId, int64_t>& worker_waiting,
       const std::set<WorkerId>& idle_workers) const = 0;
@@ -109,6 +112,11 @@ class IEngine {
   virtual void UpdateLatency(const SubgraphKey& key, int64_t latency) = 0;
   virtual int64_t GetProfiled(const SubgraphKey& key) const = 0;
   virtual int64_t GetExpected(const SubgraphKey& key) const = 0;
+  // Advances whenever the expected latencies drift
+  virtual uint64_t GetLatencyEpoch() const = 0;
+  // Runs one pending background profile invocation on the worker thread.
+  // Returns true if the worker has more to profile.
+  virtual bool ProfileStep(WorkerId worker_id) = 0;
 
   /* planner */
   virtual void Trigger() = 0;
@@ -129,6 +137,10 @@ class IEngine {
   /* tensor communication */
   virtual absl::Status TryCopyInputTensors(const Job& job) = 0;
   virtual absl::Status TryCopyOutputTensors(const Job& job) = 0;
+  // Return the tensor slots of a finished job to the model's buffers
+  virtual void ReleaseJobTensors(const Job& job) = 0;
+  // Free the unread outputs of a finished job
+  virtual absl::Status DiscardOutputTensors(JobId job_id) = 0;
 };
 }  // namespace band
 
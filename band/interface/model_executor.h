@@ -36,6 +36,7 @@ namespace interface {
   Model executor for specific <IModel, Worker>
 */
 
+struct ITensor;
 class ITensorView;
 class IModelExecutor : public IBackendSpecific {
  public:
@@ -64,6 +65,25 @@ class IModelExecutor : public IBackendSpecific {
 
   virtual std::shared_ptr<ITensorView> GetTensorView(const SubgraphKey& key,
                                                      int index) = 0;
+  // Use the memory of `src` as the input tensor `index` of the subgraph for
+  // the next `ExecuteSubgraph(key)` only. The binding is released after the
+  // execution. Returns an error if the backend cannot use the memory as is
+  // (e.g., unsupported or misaligned), then the caller should copy instead.
+  virtual absl::Status BindInputTensor(const SubgraphKey& key, int index,
+                                       const ITensor* src) {
+    return absl::UnimplementedError("Zero-copy input is not supported");
+  }
+  // Release the inputs bound by `BindInputTensor` without an execution, e.g.,
+  // when the execution is skipped after a failed input copy.
+  virtual absl::Status ReleaseInputTensors(const SubgraphKey& key) {
+    return absl::OkStatus();
+  }
+
+  // Resize the leading (batch) dimension of the subgraph inputs to
+  // `batch_size` for dynamic batching. The size stays until the next call.
+  virtual absl::Status ResizeBatch(const SubgraphKey& key, int batch_size) {
+    return absl::UnimplementedError("Dynamic batching is not supported");
+  }
 
   virtual bool HasSubgraph(const SubgraphKey& key) const = 0;
   virtual SubgraphKey GetLargestSubgraphKey() const = 0;
@@ -16,6 +16,8 @@
 
 package org.mrsnu.band;
 
+import java.nio.ByteBuffer;
+import java.util.Collections;
 import java.util.List;
 
 public class Engine {
@@ -55,10 +57,61 @@ public class Engine {
     return wrapper.requestAsyncBatch(models, inputTensorLists);
   }
 
+  /**
+   * Waits for the request and copies its outputs. The outputs of a request can
+   * be read only once, by either this or {@link #leaseOutputs(Request)}, and
+   * an empty {@code outputTensors} discards them.
+   */
   public void wait(Request request, List<Tensor> outputTensors) {
     wrapper.wait(request, outputTensors);
   }
 
+  /**
+   * Cancels an unfinished request. A queued request is dropped, and the
+   * remaining subgraphs of a running request are skipped.
+   *
+   * @throws IllegalStateException if the request is unknown or already
+   *     finished.
+   */
+  public void cancel(Request request) {
+    wrapper.cancel(Collections.singletonList(request));
+  }
+
+  public void cancel(List<Request> requests) {
+    wrapper.cancel(requests);
+  }
+
+  /**
+   * Borrows the outputs of a finished request without copy. The buffers are
+   * read-only and valid until {@link #releaseOutputs(Request)} is called.
+   *
+   * @throws IllegalStateException if the request is not finished, or its
+   *     outputs are already read or leased.
+   */
+  public List<ByteBuffer> leaseOutputs(Request request) {
+    return wrapper.leaseOutputs(request);
+  }
+
+  /**
+   * Returns the leased outputs of the request to the engine.
+   *
+   * @throws IllegalStateException if the outputs are not leased.
+   */
+  public void releaseOutputs(Request request) {
+    wrapper.releaseOutputs(request);
+  }
+
+  /**
+   * Frees the outputs of a finished request without reading them. Unread
+   * outputs are otherwise kept until a new request of the model needs room.
+   *
+   * @throws IllegalStateException if the outputs are already read, discarded
+   *     or evicted.
+   */
+  public void discardOutputs(Request request) {
+    wrapper.discardOutputs(request);
+  }
+
   public Tensor createInputTensor(Model model, int index) {
     return wrapper.createInputTensor(model, index);
   }
@@ -16,6 +16,8 @@
 
 package org.mrsnu.band;
 
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
 import java.util.ArrayList;
 import java.util.List;
 
@@ -80,6 +82,33 @@ class NativeEngineWrapper implements AutoCloseable {
     wait(nativeHandle, request.getJobId(), outputTensors);
   }
 
+  public void cancel(List<Request> requests) {
+    int[] jobIds = new int[requests.size()];
+    for (int i = 0; i < requests.size(); i++) {
+      jobIds[i] = requests.get(i).getJobId();
+    }
+    cancel(nativeHandle, jobIds);
+  }
+
+  public List<ByteBuffer> leaseOutputs(Request request) {
+    List<ByteBuffer> ret = new ArrayList<>();
+    ByteBuffer[] buffers = leaseOutputs(nativeHandle, request.getJobId());
+    if (buffers != null) {
+      for (ByteBuffer buffer : buffers) {
+        ret.add(buffer.asReadOnlyBuffer().order(ByteOrder.nativeOrder()));
+      }
+    }
+    return ret;
+  }
+
+  public void releaseOutputs(Request request) {
+    releaseOutputs(nativeHandle, request.getJobId());
+  }
+
+  public void discardOutputs(Request request) {
+    discardOutputs(nativeHandle, request.getJobId());
+  }
+
   private static native long createEngineWithDefaultConfig();
 
   private static native long createEngine(Config config);
@@ -105,4 +134,12 @@ class NativeEngineWrapper implements AutoCloseable {
       long engineHandle, List<Model> models, List<List<Tensor>> inputTensorsList);
 
   private static native void wait(long engineHandle, int jobId, List<Tensor> outputTensors);
+
+  private static native void cancel(long engineHandle, int[] jobIds);
+
+  private static native ByteBuffer[] leaseOutputs(long engineHandle, int jobId);
+
+  private static native void releaseOutputs(long engineHandle, int jobId);
+
+  private static native void discardOutputs(long engineHandle, int jobId);
 }
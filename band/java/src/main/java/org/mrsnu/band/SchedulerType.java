@@ -23,7 +23,11 @@ public enum SchedulerType {
   FIXED_DEVICE_GLOBAL_QUEUE(3),
   HETEROGENEOUS_EARLIEST_FINISH_TIME(4),
   LEAST_SLACK_TIME_FRIST(5),
-  HETEROGENEOUS_EARLIEST_FINISH_TIME_RESERVED(6);
+  HETEROGENEOUS_EARLIEST_FINISH_TIME_RESERVED(6),
+  FAIR_SHARE(7),
+  EARLIEST_DEADLINE_FIRST(8),
+  SLO_SATISFYING(9),
+  PIPELINE(10);
   
   private final int value;
   SchedulerType(int value) {
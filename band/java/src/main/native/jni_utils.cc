@@ -24,6 +24,7 @@ namespace jni {
 
 const char kIllegalArgumentException[] = "java/lang/IllegalArgumentException";
 const char kNullPointerException[] = "java/lang/NullPointerException";
+const char kIllegalStateException[] = "java/lang/IllegalStateException";
 
 void ThrowException(JNIEnv* env, const char* clazz, const char* fmt, ...) {
   va_list args;
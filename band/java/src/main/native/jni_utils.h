@@ -50,6 +50,7 @@ namespace jni {
 
 extern const char kIllegalArgumentException[];
 extern const char kNullPointerException[];
+extern const char kIllegalStateException[];
 
 struct JNIRuntimeConfig {
   JNIRuntimeConfig(RuntimeConfig config) : impl(config) {}
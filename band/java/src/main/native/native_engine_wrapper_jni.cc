@@ -15,6 +15,7 @@
 #include <jni.h>
 
 #include <algorithm>
+#include <vector>
 
 #include "band/config.h"
 #include "band/config_builder.h"
@@ -37,6 +38,8 @@ using band::jni::ConvertLongToEngine;
 using band::jni::ConvertLongToJobId;
 using band::jni::ConvertLongToModel;
 using band::jni::ConvertLongToTensor;
+using band::jni::kIllegalStateException;
+using band::jni::ThrowException;
 
 namespace {
 
@@ -228,4 +231,66 @@ JNIEXPORT void JNICALL Java_org_mrsnu_band_NativeEngineWrapper_wait(
   }
 }
 
+JNIEXPORT void JNICALL Java_org_mrsnu_band_NativeEngineWrapper_cancel(
+    JNIEnv* env, jclass clazz, jlong engineHandle, jintArray jobIds) {
+  Engine* engine = ConvertLongToEngine(env, engineHandle);
+  const jsize num_jobs = env->GetArrayLength(jobIds);
+  std::vector<band::JobId> job_ids(num_jobs);
+  env->GetIntArrayRegion(jobIds, 0, num_jobs,
+                         reinterpret_cast<jint*>(job_ids.data()));
+  auto status = engine->Cancel(job_ids);
+  if (!status.ok()) {
+    ThrowException(env, kIllegalStateException, "%s",
+                   status.ToString().c_str());
+  }
+}
+
+JNIEXPORT jobjectArray JNICALL
+Java_org_mrsnu_band_NativeEngineWrapper_leaseOutputs(JNIEnv* env,
+                                                     jclass clazz,
+                                                     jlong engineHandle,
+                                                     jint jobId) {
+  Engine* engine = ConvertLongToEngine(env, engineHandle);
+  auto status_or_tensors = engine->LeaseOutputTensors(jobId);
+  if (!status_or_tensors.ok()) {
+    ThrowException(env, kIllegalStateException, "%s",
+                   status_or_tensors.status().ToString().c_str());
+    return nullptr;
+  }
+
+  const std::vector<const band::interface::ITensor*>& tensors =
+      status_or_tensors.value();
+  JNI_DEFINE_CLS(byte_buffer, "java/nio/ByteBuffer");
+  jobjectArray buffers =
+      env->NewObjectArray(tensors.size(), byte_buffer_cls, nullptr);
+  for (size_t i = 0; i < tensors.size(); i++) {
+    // Exposed as read-only buffers on the Java side
+    jobject buffer = env->NewDirectByteBuffer(
+        const_cast<char*>(tensors[i]->GetData()), tensors[i]->GetBytes());
+    env->SetObjectArrayElement(buffers, i, buffer);
+    env->DeleteLocalRef(buffer);
+  }
+  return buffers;
+}
+
+JNIEXPORT void JNICALL Java_org_mrsnu_band_NativeEngineWrapper_releaseOutputs(
+    JNIEnv* env, jclass clazz, jlong engineHandle, jint jobId) {
+  Engine* engine = ConvertLongToEngine(env, engineHandle);
+  auto status = engine->ReleaseOutputTensors(jobId);
+  if (!status.ok()) {
+    ThrowException(env, kIllegalStateException, "%s",
+                   status.ToString().c_str());
+  }
+}
+
+JNIEXPORT void JNICALL Java_org_mrsnu_band_NativeEngineWrapper_discardOutputs(
+    JNIEnv* env, jclass clazz, jlong engineHandle, jint jobId) {
+  Engine* engine = ConvertLongToEngine(env, engineHandle);
+  auto status = engine->DiscardOutputTensors(jobId);
+  if (!status.ok()) {
+    ThrowException(env, kIllegalStateException, "%s",
+                   status.ToString().c_str());
+  }
+}
+
 }  // extern "C"
\ No newline at end of file
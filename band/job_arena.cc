@@ -0,0 +1,104 @@
+// Copyright 2023 Seoul National University
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "band/job_arena.h"
+
+#include "band/logger.h"
+
+namespace band {
+
+JobArena::JobArena() {
+  for (auto& chunk : chunks_) {
+    chunk.store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+JobArena::~JobArena() {
+  for (auto& chunk : chunks_) {
+    delete[] chunk.load(std::memory_order_relaxed);
+  }
+}
+
+JobHandle JobArena::Allocate() {
+  std::lock_guard<std::mutex> lock(mtx_);
+  if (free_slots_.empty()) {
+    if (num_chunks_ == kMaxChunks) {
+      BAND_LOG(LogSeverity::kError, "Job arena is full (%zu jobs)",
+               kMaxChunks * kChunkSize);
+      return JobHandle();
+    }
+    chunks_[num_chunks_].store(new Slot[kChunkSize],
+                               std::memory_order_release);
+    // Pop the lowest index first
+    for (size_t i = kChunkSize; i > 0; i--) {
+      free_slots_.push_back(num_chunks_ * kChunkSize + i - 1);
+    }
+    num_chunks_++;
+  }
+
+  JobHandle handle;
+  handle.index = free_slots_.back();
+  free_slots_.pop_back();
+  handle.generation = GetSlot(handle)->generation.load();
+  num_allocated_++;
+  return handle;
+}
+
+JobState* JobArena::Get(const JobHandle& handle) {
+  Slot* slot = GetSlot(handle);
+  if (slot == nullptr ||
+      slot->generation.load(std::memory_order_acquire) != handle.generation) {
+    return nullptr;
+  }
+  return &slot->state;
+}
+
+const JobState* JobArena::Get(const JobHandle& handle) const {
+  return const_cast<JobArena*>(this)->Get(handle);
+}
+
+void JobArena::Free(const JobHandle& handle) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  Slot* slot = GetSlot(handle);
+  if (slot == nullptr || slot->generation.load() != handle.generation) {
+    return;
+  }
+  // Keep the capacity for the next job of the slot
+  slot->state.previous_subgraph_keys.clear();
+  slot->state.bound_inputs.clear();
+  slot->state.batched_jobs.clear();
+  slot->state.resolved_unit_subgraphs.reset();
+  slot->state.num_running_branches = 0;
+  slot->state.branch_status = JobStatus::kSuccess;
+  slot->generation.fetch_add(1, std::memory_order_release);
+  free_slots_.push_back(handle.index);
+  num_allocated_--;
+}
+
+size_t JobArena::GetNumAllocated() const {
+  std::lock_guard<std::mutex> lock(mtx_);
+  return num_allocated_;
+}
+
+JobArena::Slot* JobArena::GetSlot(const JobHandle& handle) const {
+  if (handle.index < 0 ||
+      static_cast<size_t>(handle.index) >= kMaxChunks * kChunkSize) {
+    return nullptr;
+  }
+  Slot* chunk = chunks_[handle.index / kChunkSize].load(
+      std::memory_order_acquire);
+  return chunk == nullptr ? nullptr : &chunk[handle.index % kChunkSize];
+}
+
+}  // namespace band
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2023 Seoul National University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef BAND_JOB_ARENA_H_
+#define BAND_JOB_ARENA_H_
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "band/common.h"
+
+namespace band {
+
+// Per-job state that is not trivially copyable. It lives in the arena for the
+// whole life of the job, so the `Job` descriptors passed through the queues
+// and schedulers stay plain values.
+struct JobState {
+  // Subgraphs executed so far, to resolve intermediate tensors
+  std::vector<SubgraphKey> previous_subgraph_keys;
+  // Caller-owned input tensors for zero-copy requests (see RequestOption)
+  std::vector<interface::ITensor*> bound_inputs;
+  // Jobs of the same model merged into this job by dynamic batching.
+  // This job is the batch index 0 and `batched_jobs[i]` is the index i + 1.
+  std::vector<Job> batched_jobs;
+
+  // Branches of the job running in parallel. While they run, `mtx` guards
+  // these and `previous_subgraph_keys`.
+  mutable std::mutex mtx;
+  // Unit subgraphs resolved by all branches, none if the job never forked
+  BitMask resolved_unit_subgraphs;
+  int num_running_branches = 0;
+  // The first failure of the branches
+  JobStatus branch_status = JobStatus::kSuccess;
+};
+
+// Pool of `JobState` with stable addresses.
+// Slots are recycled with their capacity, so a steady stream of requests
+// does not allocate. A handle carries the generation of its slot, so a handle
+// of a freed job never resolves to a later job in the same slot.
+// `Allocate` and `Free` are thread-safe. `Get` is lock-free, and the state of
+// a job is accessed only by the thread that currently owns the job.
+class JobArena {
+ public:
+  JobArena();
+  ~JobArena();
+
+  JobHandle Allocate();
+  // Returns nullptr if the handle is invalid or already freed.
+  JobState* Get(const JobHandle& handle);
+  const JobState* Get(const JobHandle& handle) const;
+  void Free(const JobHandle& handle);
+
+  size_t GetNumAllocated() const;
+
+ private:
+  struct Slot {
+    std::atomic<uint32_t> generation{0};
+    JobState state;
+  };
+
+  static constexpr size_t kChunkSize = 256;
+  static constexpr size_t kMaxChunks = 4096;
+  Slot* GetSlot(const JobHandle& handle) const;
+
+  // Chunks are never moved or freed before destruction
+  std::array<std::atomic<Slot*>, kMaxChunks> chunks_;
+
+  mutable std::mutex mtx_;
+  size_t num_chunks_ = 0;
+  std::vector<int32_t> free_slots_;
+  size_t num_allocated_ = 0;
+};
+
+}  // namespace band
+
+#endif  // BAND_JOB_ARENA_H_
@@ -0,0 +1,97 @@
+// Copyright 2023 Seoul National University
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "band/job_completion_store.h"
+
+namespace band {
+
+JobCompletionStore::JobCompletionStore(size_t max_finished_records)
+    : max_finished_records_(max_finished_records) {}
+
+void JobCompletionStore::Register(JobId job_id) {
+  Shard& shard = GetShard(job_id);
+  std::lock_guard<std::mutex> lock(shard.mtx);
+  shard.records.emplace(job_id, std::make_shared<Record>());
+}
+
+JobId JobCompletionStore::Complete(const Job& job) {
+  {
+    Shard& shard = GetShard(job.job_id);
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    std::shared_ptr<Record>& record = shard.records[job.job_id];
+    if (!record) {
+      record = std::make_shared<Record>();
+    }
+    record->job = job;
+    record->finished = true;
+    record->finished_cv.notify_all();
+  }
+
+  JobId evicted_job_id = -1;
+  {
+    std::lock_guard<std::mutex> lock(finished_order_mtx_);
+    finished_order_.push_back(job.job_id);
+    if (finished_order_.size() > max_finished_records_) {
+      evicted_job_id = finished_order_.front();
+      finished_order_.pop_front();
+    }
+  }
+
+  if (evicted_job_id != -1) {
+    Shard& shard = GetShard(evicted_job_id);
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    shard.records.erase(evicted_job_id);
+  }
+  return evicted_job_id;
+}
+
+void JobCompletionStore::Wait(JobId job_id) {
+  Shard& shard = GetShard(job_id);
+  std::unique_lock<std::mutex> lock(shard.mtx);
+  auto it = shard.records.find(job_id);
+  if (it == shard.records.end()) {
+    return;
+  }
+  // Keep the record alive even if it is evicted while waiting
+  std::shared_ptr<Record> record = it->second;
+  record->finished_cv.wait(lock, [&record] { return record->finished; });
+}
+
+Job JobCompletionStore::GetFinishedJob(JobId job_id) const {
+  const Shard& shard = GetShard(job_id);
+  std::lock_guard<std::mutex> lock(shard.mtx);
+  auto it = shard.records.find(job_id);
+  if (it == shard.records.end() || !it->second->finished) {
+    return Job();
+  }
+  return it->second->job;
+}
+
+bool JobCompletionStore::IsPending(JobId job_id) const {
+  const Shard& shard = GetShard(job_id);
+  std::lock_guard<std::mutex> lock(shard.mtx);
+  auto it = shard.records.find(job_id);
+  return it != shard.records.end() && !it->second->finished;
+}
+
+JobCompletionStore::Shard& JobCompletionStore::GetShard(JobId job_id) {
+  return shards_[static_cast<size_t>(job_id) % kNumShards];
+}
+
+const JobCompletionStore::Shard& JobCompletionStore::GetShard(
+    JobId job_id) const {
+  return shards_[static_cast<size_t>(job_id) % kNumShards];
+}
+
+}  // namespace band
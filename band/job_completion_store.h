@@ -0,0 +1,82 @@
+/*
+ * Copyright 2023 Seoul National University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BAND_JOB_COMPLETION_STORE_H_
+#define BAND_JOB_COMPLETION_STORE_H_
+
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "band/common.h"
+
+namespace band {
+
+// Finished job records with a wait handle per job.
+// Waiters of a job are woken only when that job finishes, and a job id is
+// resolved exactly instead of by a fixed-size window, so an unknown or
+// evicted id never aliases another job.
+// Finished records are evicted in the order of completion once there are
+// more than `max_finished_records` of them.
+class JobCompletionStore {
+ public:
+  explicit JobCompletionStore(size_t max_finished_records = 1000);
+
+  // Start tracking a submitted job.
+  void Register(JobId job_id);
+  // Record the finished job and wake up its waiters. Returns the id of the
+  // finished job evicted to make room, or -1.
+  JobId Complete(const Job& job);
+  // Blocks until the job finishes. Returns immediately for an unknown or
+  // evicted job id.
+  void Wait(JobId job_id);
+  // Returns the finished job, or a default `Job` with job id -1 if the job is
+  // unknown, evicted or not finished yet.
+  Job GetFinishedJob(JobId job_id) const;
+  // Returns true if the job is submitted and not finished yet.
+  bool IsPending(JobId job_id) const;
+
+ private:
+  struct Record {
+    bool finished = false;
+    Job job;
+    std::condition_variable finished_cv;
+  };
+
+  // Records are sharded by job id to keep submissions from different
+  // threads off a single lock.
+  struct Shard {
+    mutable std::mutex mtx;
+    std::unordered_map<JobId, std::shared_ptr<Record>> records;
+  };
+
+  static constexpr size_t kNumShards = 16;
+  Shard& GetShard(JobId job_id);
+  const Shard& GetShard(JobId job_id) const;
+
+  const size_t max_finished_records_;
+  std::array<Shard, kNumShards> shards_;
+
+  std::mutex finished_order_mtx_;
+  std::deque<JobId> finished_order_;
+};
+
+}  // namespace band
+
+#endif  // BAND_JOB_COMPLETION_STORE_H_
@@ -14,12 +14,16 @@
 
 #include "band/latency_estimator.h"
 
+#include <algorithm>
+#include <cstdlib>
+
 #include "absl/strings/str_format.h"
 #include "band/engine_interface.h"
 #include "band/json_util.h"
 #include "band/logger.h"
 #include "band/model_spec.h"
 #include "band/profiler.h"
+#include "band/time.h"
 #include "band/worker.h"
 
 namespace band {
@@ -27,7 +31,8 @@ LatencyEstimator::LatencyEstimator(IEngine* engine) : engine_(engine) {}
 
 absl::Status LatencyEstimator::Init(const ProfileConfig& config) {
   profile_data_path_ = config.profile_data_path;
-  if (!config.online) {
+  if (!config.online ||
+      (config.background && !config.profile_data_path.empty())) {
     profile_database_json_ = json::LoadFromFile(config.profile_data_path);
   }
   // we cannot convert the model name strings to integer ids yet,
@@ -39,17 +44,27 @@ absl::Status LatencyEstimator::Init(const ProfileConfig& config) {
   profile_num_warmups_ = config.num_warmups;
   profile_num_runs_ = config.num_runs;
   profile_smoothing_factor_ = config.smoothing_factor;
+  drift_threshold_ = config.drift_threshold;
+  profile_background_ = config.background;
 
   return absl::OkStatus();
 }
 
 void LatencyEstimator::UpdateLatency(const SubgraphKey& key, int64_t latency) {
+  std::lock_guard<std::mutex> lock(profile_database_mtx_);
   auto it = profile_database_.find(key);
   if (it != profile_database_.end()) {
+    if (unmeasured_keys_.erase(key)) {
+      // The first measurement replaces the estimate
+      it->second = {latency, latency};
+      OnLatencyUpdated(key, latency);
+      return;
+    }
     int64_t prev_latency = it->second.moving_averaged;
     profile_database_[key].moving_averaged =
         profile_smoothing_factor_ * latency +
         (1 - profile_smoothing_factor_) * prev_latency;
+    OnLatencyUpdated(key, it->second.moving_averaged);
   } else {
     BAND_LOG(LogSeverity::kWarning,
              "[LatencyEstimator::UpdateLatency] The given SubgraphKey %s "
@@ -59,7 +74,9 @@ void LatencyEstimator::UpdateLatency(const SubgraphKey& key, int64_t latency) {
 }
 
 absl::Status LatencyEstimator::ProfileModel(ModelId model_id) {
-  if (profile_online_) {
+  if (profile_online_ && profile_background_) {
+    ScheduleBackgroundProfile(model_id);
+  } else if (profile_online_) {
     for (WorkerId worker_id = 0; worker_id < engine_->GetNumWorkers();
          worker_id++) {
       Worker* worker = engine_->GetWorker(worker_id);
@@ -111,7 +128,9 @@ absl::Status LatencyEstimator::ProfileModel(ModelId model_id) {
             const int64_t latency =
                 average_profiler
                     .GetAverageElapsedTime<std::chrono::microseconds>();
+            std::lock_guard<std::mutex> lock(profile_database_mtx_);
             profile_database_[subgraph_key] = {latency, latency};
+            OnLatencyUpdated(subgraph_key, latency);
           }
         });
         return absl::OkStatus();
@@ -127,7 +146,12 @@ absl::Status LatencyEstimator::ProfileModel(ModelId model_id) {
       const std::string model_name = engine_->GetModelSpec(model_id)->path;
       auto model_profile = JsonToModelProfile(model_name, model_id);
       if (model_profile.size() > 0) {
+        std::lock_guard<std::mutex> lock(profile_database_mtx_);
         profile_database_.insert(model_profile.begin(), model_profile.end());
+        for (const auto& key_latency : model_profile) {
+          OnLatencyUpdated(key_latency.first,
+                           key_latency.second.moving_averaged);
+        }
         BAND_LOG_DEBUG(
             "Successfully found %d profile entries for model (%s, %d).",
             model_profile.size(), model_name.c_str(), model_id);
@@ -141,7 +165,129 @@ absl::Status LatencyEstimator::ProfileModel(ModelId model_id) {
   return absl::OkStatus();
 }
 
+bool LatencyEstimator::ProfileStep(WorkerId worker_id) {
+  SubgraphKey key;
+  {
+    std::lock_guard<std::mutex> lock(profile_database_mtx_);
+    auto it = pending_profiles_.find(worker_id);
+    if (it == pending_profiles_.end() || it->second.empty()) {
+      return false;
+    }
+    key = it->second.front().key;
+  }
+
+  const int64_t start_time = time::NowMicros();
+  const absl::Status status = engine_->Invoke(key);
+  const int64_t latency = time::NowMicros() - start_time;
+
+  std::lock_guard<std::mutex> lock(profile_database_mtx_);
+  std::deque<PendingProfile>& pending = pending_profiles_[worker_id];
+  if (pending.empty() || !(pending.front().key == key)) {
+    // The model is released while unlocked
+    return !pending.empty();
+  }
+  PendingProfile& profile = pending.front();
+  if (!status.ok()) {
+    BAND_LOG(LogSeverity::kError, "Profiler failed to invoke subgraph %s: %s",
+             key.ToString().c_str(), status.ToString().c_str());
+    pending.pop_front();
+    return !pending.empty();
+  }
+
+  if (unmeasured_keys_.erase(key)) {
+    profile_database_[key] = {latency, latency};
+    OnLatencyUpdated(key, latency);
+  }
+  if (profile.num_warmups > 0) {
+    profile.num_warmups--;
+  } else {
+    profile.total_latency += latency;
+    if (++profile.num_runs >= profile_num_runs_) {
+      const int64_t average = profile.total_latency / profile.num_runs;
+      profile_database_[key] = {average, average};
+      OnLatencyUpdated(key, average);
+      pending.pop_front();
+    }
+  }
+  return !pending.empty();
+}
+
+void LatencyEstimator::ScheduleBackgroundProfile(ModelId model_id) {
+  // Previous results are the estimates until the first measurement
+  std::map<SubgraphKey, Latency> model_profile;
+  const ModelSpec* model_spec = engine_->GetModelSpec(model_id);
+  if (model_spec && !profile_database_json_.empty()) {
+    model_profile = JsonToModelProfile(model_spec->path, model_id);
+  }
+
+  std::set<WorkerId> worker_ids;
+  {
+    std::lock_guard<std::mutex> lock(profile_database_mtx_);
+    // Otherwise the slowest measured subgraph of the worker, or of any
+    // worker if the worker has none
+    std::map<WorkerId, int64_t> worst_latencies;
+    int64_t worst_latency = 0;
+    for (const auto& key_latency : profile_database_) {
+      if (unmeasured_keys_.find(key_latency.first) != unmeasured_keys_.end()) {
+        continue;
+      }
+      const int64_t latency = key_latency.second.moving_averaged;
+      int64_t& worker_worst = worst_latencies[key_latency.first.GetWorkerId()];
+      worker_worst = std::max(worker_worst, latency);
+      worst_latency = std::max(worst_latency, latency);
+    }
+
+    engine_->ForEachSubgraph([&](const SubgraphKey& key) {
+      if (key.GetModelId() != model_id) {
+        return;
+      }
+      auto it = model_profile.find(key);
+      if (it != model_profile.end()) {
+        profile_database_[key] = it->second;
+      } else {
+        auto worst_it = worst_latencies.find(key.GetWorkerId());
+        const int64_t estimate =
+            worst_it != worst_latencies.end() ? worst_it->second
+                                              : worst_latency;
+        profile_database_[key] = {estimate, estimate};
+      }
+      OnLatencyUpdated(key, profile_database_[key].moving_averaged);
+      unmeasured_keys_.insert(key);
+      pending_profiles_[key.GetWorkerId()].push_back(
+          {key, profile_num_warmups_});
+      worker_ids.insert(key.GetWorkerId());
+    });
+  }
+
+  for (WorkerId worker_id : worker_ids) {
+    engine_->GetWorker(worker_id)->NotifyPendingProfile();
+  }
+}
+
+void LatencyEstimator::OnModelReleased(ModelId model_id) {
+  std::lock_guard<std::mutex> lock(profile_database_mtx_);
+  for (auto& worker_profiles : pending_profiles_) {
+    std::deque<PendingProfile>& pending = worker_profiles.second;
+    pending.erase(std::remove_if(pending.begin(), pending.end(),
+                                 [model_id](const PendingProfile& profile) {
+                                   return profile.key.GetModelId() ==
+                                          model_id;
+                                 }),
+                  pending.end());
+  }
+  for (auto it = unmeasured_keys_.begin(); it != unmeasured_keys_.end();) {
+    if (it->GetModelId() == model_id) {
+      profile_database_.erase(*it);
+      drift_references_.erase(*it);
+      it = unmeasured_keys_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
 int64_t LatencyEstimator::GetProfiled(const SubgraphKey& key) const {
+  std::lock_guard<std::mutex> lock(profile_database_mtx_);
   auto it = profile_database_.find(key);
   if (it != profile_database_.end()) {
     return it->second.profiled;
@@ -154,6 +300,33 @@ int64_t LatencyEstimator::GetProfiled(const SubgraphKey& key) const {
 }
 
 int64_t LatencyEstimator::GetExpected(const SubgraphKey& key) const {
+  std::lock_guard<std::mutex> lock(profile_database_mtx_);
+  return GetExpectedLocked(key);
+}
+
+void LatencyEstimator::GetExpected(const std::vector<SubgraphKey>& keys,
+                                   std::vector<int64_t>& latencies) const {
+  latencies.resize(keys.size());
+  std::lock_guard<std::mutex> lock(profile_database_mtx_);
+  for (size_t i = 0; i < keys.size(); i++) {
+    latencies[i] = GetExpectedLocked(keys[i]);
+  }
+}
+
+void LatencyEstimator::OnLatencyUpdated(const SubgraphKey& key,
+                                        int64_t latency) {
+  epoch_++;
+  // Small changes of a moving average accumulate until they drift far enough
+  // from the latency of the last drift
+  auto it = drift_references_.find(key);
+  if (it == drift_references_.end() ||
+      std::abs(latency - it->second) > drift_threshold_ * it->second) {
+    drift_references_[key] = latency;
+    drift_epoch_++;
+  }
+}
+
+int64_t LatencyEstimator::GetExpectedLocked(const SubgraphKey& key) const {
   auto it = profile_database_.find(key);
   if (it != profile_database_.end()) {
     return it->second.moving_averaged;
@@ -166,6 +339,7 @@ int64_t LatencyEstimator::GetExpected(const SubgraphKey& key) const {
 }
 
 int64_t LatencyEstimator::GetWorst(ModelId model_id) const {
+  std::lock_guard<std::mutex> lock(profile_database_mtx_);
   int64_t worst_model_latency = 0;
   for (auto it : profile_database_) {
     if (it.first.GetModelId() == model_id) {
@@ -177,7 +351,12 @@ int64_t LatencyEstimator::GetWorst(ModelId model_id) const {
 }
 
 absl::Status LatencyEstimator::DumpProfile() {
-  return json::WriteToFile(ProfileToJson(), profile_data_path_);
+  Json::Value profile;
+  {
+    std::lock_guard<std::mutex> lock(profile_database_mtx_);
+    profile = ProfileToJson();
+  }
+  return json::WriteToFile(profile, profile_data_path_);
 }
 
 size_t LatencyEstimator::GetProfileHash() const {
@@ -263,6 +442,10 @@ Json::Value LatencyEstimator::ProfileToJson() {
   name_profile["hash"] = GetProfileHash();
   for (auto& pair : profile_database_) {
     SubgraphKey key = pair.first;
+    // Estimates are not measurements
+    if (unmeasured_keys_.find(key) != unmeasured_keys_.end()) {
+      continue;
+    }
     const int model_id = key.GetModelId();
     const int64_t profiled_latency = pair.second.profiled;
 
@@ -19,8 +19,12 @@
 
 #include <json/json.h>
 
+#include <atomic>
 #include <chrono>
+#include <deque>
+#include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "absl/status/status.h"
 #include "band/common.h"
@@ -34,9 +38,26 @@ class LatencyEstimator {
   absl::Status Init(const ProfileConfig& config);
   void UpdateLatency(const SubgraphKey& key, int64_t latency);
 
+  // Profiles the subgraphs of the model. With `ProfileConfig::background`,
+  // only queues them to be measured by `ProfileStep` of each worker.
   absl::Status ProfileModel(ModelId model_id);
+  // Runs one pending profile invocation on the calling worker thread.
+  // Returns true if the worker has more to profile.
+  bool ProfileStep(WorkerId worker_id);
+  // Drops the pending profiles and the estimates of the model. Measured
+  // latencies are kept.
+  void OnModelReleased(ModelId model_id);
   int64_t GetProfiled(const SubgraphKey& key) const;
   int64_t GetExpected(const SubgraphKey& key) const;
+  // Looks up the expected latencies of the keys at once.
+  void GetExpected(const std::vector<SubgraphKey>& keys,
+                   std::vector<int64_t>& latencies) const;
+  // Changes whenever a latency changes, to validate derived caches.
+  uint64_t GetEpoch() const { return epoch_.load(); }
+  // Changes only when a latency drifts more than
+  // `ProfileConfig::drift_threshold` since its last drift, for caches that
+  // tolerate small changes.
+  uint64_t GetDriftEpoch() const { return drift_epoch_.load(); }
   int64_t GetWorst(ModelId model_id) const;
 
   absl::Status DumpProfile();
@@ -49,6 +70,10 @@ class LatencyEstimator {
 
  private:
   size_t GetProfileHash() const;
+  int64_t GetExpectedLocked(const SubgraphKey& key) const;
+  // Bumps the epochs after a change of `profile_database_`
+  void OnLatencyUpdated(const SubgraphKey& key, int64_t latency);
+  void ScheduleBackgroundProfile(ModelId model_id);
 
   // Convert entries in the json value to ModelDeviceToLatency format,
   // for the given model name and target model id.
@@ -70,10 +95,32 @@ class LatencyEstimator {
   // because the model name --> int mapping is not available at init time.
   Json::Value profile_database_json_;
 
+  mutable std::mutex profile_database_mtx_;
   std::unordered_map<SubgraphKey, Latency, SubgraphHash> profile_database_;
   float profile_smoothing_factor_ = 0.05f;
+  // Incremented on every update of `profile_database_`
+  std::atomic<uint64_t> epoch_{0};
+  // Latency of each subgraph as of its last drift
+  std::unordered_map<SubgraphKey, int64_t, SubgraphHash> drift_references_;
+  float drift_threshold_ = 0.1f;
+  std::atomic<uint64_t> drift_epoch_{0};
+
+  // Background profiling (guarded by `profile_database_mtx_`)
+  struct PendingProfile {
+    SubgraphKey key;
+    int num_warmups;
+    int num_runs = 0;
+    int64_t total_latency = 0;
+  };
+  std::map<WorkerId, std::deque<PendingProfile>> pending_profiles_;
+  // Subgraphs with an estimated latency, replaced by the first measurement.
+  // Without a previous result, a subgraph is estimated as the slowest
+  // measured subgraph of its worker, so that schedulers do not see a new
+  // model as free.
+  std::unordered_set<SubgraphKey, SubgraphHash> unmeasured_keys_;
 
   bool profile_online_;
+  bool profile_background_ = false;
   int profile_num_warmups_;
   int profile_num_runs_;
 
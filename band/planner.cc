@@ -14,6 +14,7 @@
 
 #include "band/planner.h"
 
+#include <algorithm>
 #include <fstream>
 
 #include "absl/strings/str_format.h"
@@ -21,42 +22,70 @@
 #include "band/job_tracer.h"
 #include "band/logger.h"
 #include "band/model_spec.h"
+#include "band/scheduler/earliest_deadline_first_scheduler.h"
+#include "band/scheduler/fair_share_scheduler.h"
 #include "band/scheduler/fixed_worker_scheduler.h"
 #include "band/scheduler/heterogeneous_earliest_finish_time_scheduler.h"
 #include "band/scheduler/least_slack_first_scheduler.h"
+#include "band/scheduler/pipeline_scheduler.h"
 #include "band/scheduler/round_robin_scheduler.h"
 #include "band/scheduler/shortest_expected_latency_scheduler.h"
+#include "band/scheduler/slo_satisfying_scheduler.h"
 #include "band/time.h"
 
 namespace band {
 
-Planner::Planner(IEngine& engine) : num_submitted_jobs_(0), engine_(engine) {
-  planner_thread_ = std::thread([this] {
-    auto status = this->Plan();
-    if (!status.ok()) {
-      BAND_LOG(LogSeverity::kError, "Planner thread failed: %s",
-               status.ToString().c_str());
-    }
-  });
+Planner::Planner(IEngine& engine)
+    : admission_controller_(engine), num_submitted_jobs_(0), engine_(engine) {
+  AddShard();
 }
 
 Planner::~Planner() {
   if (log_path_.size()) {
     BAND_TRACER_DUMP(log_path_);
   }
-  planner_safe_bool_.terminate();
-  planner_thread_.join();
+  for (auto& shard : shards_) {
+    shard->safe_bool.terminate();
+  }
+  for (auto& shard : shards_) {
+    shard->thread.join();
+  }
+}
+
+void Planner::AddShard() {
+  shards_.emplace_back(new Shard);
+  Shard* shard = shards_.back().get();
+  shard->index = shards_.size() - 1;
+  shard->thread = std::thread([this, shard] {
+    auto status = this->Plan(*shard);
+    if (!status.ok()) {
+      BAND_LOG(LogSeverity::kError, "Planner thread %d failed: %s",
+               shard->index, status.ToString().c_str());
+    }
+  });
 }
 
 absl::Status Planner::Init(const PlannerConfig& config) {
   schedule_window_size_ = config.schedule_window_size;
+  parallel_unit_subgraphs_ = config.parallel_unit_subgraphs;
   log_path_ = config.log_path;
+  admission_controller_.Init(config.shedding_policy,
+                             config.max_pending_jobs_per_model);
 
   auto& schedulers = config.schedulers;
-  if (schedulers.size() == 0 || schedulers.size() > 2) {
+  if (schedulers.size() == 0) {
     return absl::InternalError(absl::StrFormat(
-        "[Planner] Not supported for %d schedulers", schedulers_.size()));
+        "[Planner] Not supported for %d schedulers", schedulers.size()));
+  }
+  if (!config.priority_weights.empty() &&
+      config.priority_weights.size() != schedulers.size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "[Planner] %d priority weights for %d schedulers",
+        config.priority_weights.size(), schedulers.size()));
   }
+  RETURN_IF_ERROR(SetPriorityArbitration(config.priority_arbitration,
+                                         config.priority_weights,
+                                         config.starvation_timeout_us));
 
   bool allow_fallback = false;
   local_queues_.resize(schedulers.size());
@@ -82,6 +111,18 @@ absl::Status Planner::Init(const PlannerConfig& config) {
                SchedulerType::kHeterogeneousEarliestFinishTimeReserved) {
       schedulers_.emplace_back(
           new HEFTScheduler(engine_, schedule_window_size_, true));
+    } else if (schedulers[i] == SchedulerType::kEarliestDeadlineFirst) {
+      schedulers_.emplace_back(
+          new EarliestDeadlineFirstScheduler(engine_, schedule_window_size_));
+    } else if (schedulers[i] == SchedulerType::kSLOSatisfying) {
+      schedulers_.emplace_back(
+          new SLOSatisfyingScheduler(engine_, schedule_window_size_));
+    } else if (schedulers[i] == SchedulerType::kPipeline) {
+      schedulers_.emplace_back(
+          new PipelineScheduler(engine_, config.pipeline_depth));
+    } else if (schedulers[i] == SchedulerType::kFairShare) {
+      schedulers_.emplace_back(
+          new FairShareScheduler(engine_, config.fair_share_configs));
     } else {
       return absl::InternalError("[Planner] Unsupported scheduler type.");
     }
@@ -104,10 +145,13 @@ absl::Status Planner::Init(const PlannerConfig& config) {
     return absl::InternalError(
         "All schedulers must have the same worker type.");
   }
+  RETURN_IF_ERROR(SetNumShards(config.num_shards));
 
   if (config.cpu_mask != CPUMaskFlag::kAll) {
     cpu_set_ = BandCPUMaskGetSet(config.cpu_mask);
-    need_cpu_update_ = true;
+    for (auto& shard : shards_) {
+      shard->need_cpu_update = true;
+    }
   }
 
   return absl::OkStatus();
@@ -123,6 +167,28 @@ absl::Status Planner::AddScheduler(std::unique_ptr<IScheduler> scheduler) {
              : absl::OkStatus();
 }
 
+absl::Status Planner::SetNumShards(int num_shards) {
+  if (num_shards < 1 || num_shards > GetNumPriorityClasses()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("[Planner] %d shards for %d priority classes",
+                        num_shards, GetNumPriorityClasses()));
+  }
+  if (shards_.size() != 1 && shards_.size() != num_shards) {
+    return absl::FailedPreconditionError(absl::StrFormat(
+        "[Planner] Already running %d shards", shards_.size()));
+  }
+  while (shards_.size() < num_shards) {
+    AddShard();
+  }
+  return absl::OkStatus();
+}
+
+void Planner::Trigger() {
+  for (auto& shard : shards_) {
+    shard->safe_bool.notify();
+  }
+}
+
 JobId Planner::EnqueueRequest(Job job, bool push_front) {
   return EnqueueBatch({job}, push_front)[0];
 }
@@ -130,89 +196,448 @@ JobId Planner::EnqueueRequest(Job job, bool push_front) {
 std::vector<JobId> Planner::EnqueueBatch(std::vector<Job> jobs,
                                          bool push_front) {
   std::vector<JobId> job_ids(jobs.size());
-  {
-    std::unique_lock<std::mutex> request_lock(requests_.mtx);
-    auto enqueue_time = time::NowMicros();
+  int num_new_jobs = 0;
+  for (const Job& job : jobs) {
+    num_new_jobs += job.job_id == -1;
+  }
+  // Reserve a contiguous range of ids, so that ids within a batch are
+  // monotonic regardless of the other producers. Another producer may push
+  // its batch with larger ids first.
+  JobId next_job_id =
+      num_new_jobs ? num_submitted_jobs_.fetch_add(num_new_jobs) : 0;
+
+  auto enqueue_time = time::NowMicros();
+  std::vector<bool> is_new_job(jobs.size(), false);
+  std::vector<Job> failed_jobs;
+  for (int i = 0; i < jobs.size(); i++) {
+    Job& job = jobs[i];
+    if (job.enqueue_time == 0) {
+      // job.enqueue_time may already be set if this model contains a fallback
+      // op, in which case we do not overwrite the set value
+      job.enqueue_time = enqueue_time;
+    }
+    if (job.job_id == -1) {
+      job.job_id = next_job_id++;
+      finished_jobs_.Register(job.job_id);
+      is_new_job[i] = true;
+    }
+    job_ids[i] = job.job_id;
+    if (!job.handle.IsValid()) {
+      job.handle = job_arena_.Allocate();
+      if (!job.handle.IsValid()) {
+        // Too many jobs in flight
+        job.status = JobStatus::kEnqueueFailed;
+        failed_jobs.push_back(job);
+      }
+    }
+  }
+
+  if (!failed_jobs.empty()) {
+    std::vector<Job> allocated_jobs;
+    std::vector<bool> is_new_allocated_job;
     for (int i = 0; i < jobs.size(); i++) {
-      Job& job = jobs[i];
-      if (job.enqueue_time == 0) {
-        // job.enqueue_time may already be set if this model contains a fallback
-        // op, in which case we do not overwrite the set value
-        job.enqueue_time = enqueue_time;
+      if (jobs[i].handle.IsValid()) {
+        allocated_jobs.push_back(std::move(jobs[i]));
+        is_new_allocated_job.push_back(is_new_job[i]);
+      } else {
+        num_new_jobs -= is_new_job[i];
       }
-      if (job.job_id == -1) {
-        job.job_id = num_submitted_jobs_++;
+    }
+    jobs = std::move(allocated_jobs);
+    is_new_job = std::move(is_new_allocated_job);
+    // Fail fast, without ever reaching the queue
+    for (Job& job : failed_jobs) {
+      job.invoke_time = -1;
+      job.end_time = time::NowMicros();
+      EnqueueFinishedJob(job);
+    }
+    if (jobs.empty()) {
+      return job_ids;
+    }
+  }
+
+  if (admission_controller_.IsEnabled() && num_new_jobs) {
+    std::vector<Job> new_jobs;
+    for (int i = 0; i < jobs.size(); i++) {
+      if (is_new_job[i]) {
+        new_jobs.push_back(jobs[i]);
+      }
+    }
+    std::map<JobId, JobStatus> dropped_jobs;
+    const std::vector<JobStatus> statuses =
+        admission_controller_.Admit(new_jobs, dropped_jobs);
+
+    std::vector<Job> admitted_jobs;
+    std::vector<Job> shed_jobs;
+    size_t new_job_index = 0;
+    for (int i = 0; i < jobs.size(); i++) {
+      const JobStatus status =
+          is_new_job[i] ? statuses[new_job_index++] : JobStatus::kQueued;
+      if (status == JobStatus::kQueued) {
+        admitted_jobs.push_back(jobs[i]);
+      } else {
+        jobs[i].status = status;
+        shed_jobs.push_back(jobs[i]);
       }
-      job_ids[i] = job.job_id;
     }
+    jobs = std::move(admitted_jobs);
 
-    auto insert_position =
-        push_front ? requests_.queue.begin() : requests_.queue.end();
-    requests_.queue.insert(insert_position, jobs.begin(), jobs.end());
+    if (!jobs.empty()) {
+      PushRequests(std::move(jobs), push_front);
+    }
+    if (!dropped_jobs.empty()) {
+      Abort(dropped_jobs);
+    }
+    // Fail fast, without ever reaching the queue
+    for (Job& job : shed_jobs) {
+      job.invoke_time = -1;
+      job.end_time = time::NowMicros();
+      EnqueueFinishedJob(job);
+    }
+    return job_ids;
   }
-  planner_safe_bool_.notify();
+
+  PushRequests(std::move(jobs), push_front);
   return job_ids;
 }
 
-void Planner::Wait(std::vector<int> job_ids) {
-  if (job_ids.size() == 0) {
+void Planner::PushRequests(std::vector<Job> jobs, bool push_front) {
+  if (shards_.size() == 1) {
+    shards_[0]->requests.Push(std::move(jobs), push_front);
+    shards_[0]->safe_bool.notify();
     return;
   }
 
-  std::unique_lock<std::mutex> finished_lock(job_finished_mtx_);
-  end_invoke_.wait(finished_lock, [this, job_ids] {
-    for (int job_id : job_ids) {
-      if (!IsJobIdValid(job_id)) {
-        continue;
-      }
-      if (jobs_finished_record_[GetJobRecordIndex(job_id)].job_id != job_id) {
-        return false;
-      }
+  std::vector<std::vector<Job>> shard_jobs(shards_.size());
+  for (Job& job : jobs) {
+    shard_jobs[GetShardIndex(GetPriorityClass(job))].push_back(
+        std::move(job));
+  }
+  for (size_t i = 0; i < shards_.size(); i++) {
+    if (!shard_jobs[i].empty()) {
+      shards_[i]->requests.Push(std::move(shard_jobs[i]), push_front);
+      shards_[i]->safe_bool.notify();
     }
-    return true;
-  });
-  finished_lock.unlock();
+  }
+}
+
+void Planner::Wait(std::vector<int> job_ids) {
+  for (int job_id : job_ids) {
+    finished_jobs_.Wait(job_id);
+  }
 }
 
 void Planner::WaitAll() {
   std::unique_lock<std::mutex> finished_lock(job_finished_mtx_);
-  end_invoke_.wait(finished_lock, [this]() {
+  all_jobs_finished_.wait(finished_lock, [this]() {
     return num_finished_jobs_ >= num_submitted_jobs_;
   });
-
-  finished_lock.unlock();
 }
 
 void Planner::EnqueueFinishedJob(Job& job) {
-  std::unique_lock<std::mutex> finished_lock(job_finished_mtx_);
-  const bool is_finished =
-      engine_.IsEnd(job.subgraph_key) || job.status != JobStatus::kSuccess;
+  ReportWorkerTime(job);
+  FinishJob(job);
+}
+
+void Planner::ReportWorkerTime(const Job& job) {
+  const int64_t worker_time_us = job.invoke_time > 0 && job.end_time > 0
+                                     ? job.end_time - job.invoke_time
+                                     : 0;
+  // A batch is shared evenly by its requests
+  const JobState* state = job_arena_.Get(job.handle);
+  const size_t num_batched_jobs = state ? state->batched_jobs.size() : 0;
+  const int64_t share_us = worker_time_us / (num_batched_jobs + 1);
+  for (auto& scheduler : schedulers_) {
+    scheduler->OnJobFinished(job, share_us);
+    for (size_t i = 0; i < num_batched_jobs; i++) {
+      scheduler->OnJobFinished(state->batched_jobs[i], share_us);
+    }
+  }
+}
+
+void Planner::FinishJob(Job& job) {
+  // The last branch of a fork continues with the merged state
+  const bool is_joined = job.branch_unit_subgraphs.any();
+  if (is_joined && !JoinBranch(job)) {
+    return;
+  }
+  JobState* state = job_arena_.Get(job.handle);
+  // A job that forked may resolve the last unit subgraph in any branch
+  const bool has_forked = state && state->resolved_unit_subgraphs.any();
+  bool is_finished = job.status != JobStatus::kSuccess ||
+                     (has_forked ? IsResolved(job)
+                                 : engine_.IsEnd(job.subgraph_key));
+  JobStatus aborted_status;
+  if (!is_finished && IsAborted(job.job_id, &aborted_status)) {
+    // Skip the remaining subgraphs
+    job.status = aborted_status;
+    is_finished = true;
+  }
+  if (!is_finished) {
+    // Continue with the remaining ops. The state stays in the arena and only
+    // the descriptor is enqueued again.
+    Job remaining_ops = CreateRemainingOps(job);
+    if (state && !is_joined) {
+      state->previous_subgraph_keys.push_back(job.subgraph_key);
+    }
+    const std::vector<BitMask> branches =
+        parallel_unit_subgraphs_ && state
+            ? GetBranches(job.model_id, remaining_ops.resolved_unit_subgraphs)
+            : std::vector<BitMask>();
+    if (branches.size() < 2) {
+      EnqueueRequest(remaining_ops, true);
+      return;
+    }
+
+    // Fork the independent branches, which join in `JoinBranch`
+    BitMask all_unit_subgraphs;
+    const ModelSpec* model_spec = engine_.GetModelSpec(job.model_id);
+    for (size_t i = 0; i < model_spec->GetNumUnitSubgraphs(); i++) {
+      all_unit_subgraphs.set(i);
+    }
+    {
+      std::lock_guard<std::mutex> lock(state->mtx);
+      state->resolved_unit_subgraphs = remaining_ops.resolved_unit_subgraphs;
+      state->num_running_branches = branches.size();
+      state->branch_status = JobStatus::kSuccess;
+    }
+    std::vector<Job> branch_jobs;
+    for (const BitMask& branch : branches) {
+      Job branch_job = remaining_ops;
+      branch_job.branch_unit_subgraphs = branch;
+      branch_job.resolved_unit_subgraphs = all_unit_subgraphs & ~branch;
+      branch_jobs.push_back(branch_job);
+    }
+    EnqueueBatch(branch_jobs, true);
+    return;
+  }
+
+  // Jobs merged by dynamic batching finish with the batch
+  if (state) {
+    for (Job& batched_job : state->batched_jobs) {
+      batched_job.subgraph_key = job.subgraph_key;
+      batched_job.status = job.status;
+      batched_job.invoke_time = job.invoke_time;
+      batched_job.end_time = job.end_time;
+      batched_job.profiled_execution_time = job.profiled_execution_time;
+      batched_job.expected_execution_time = job.expected_execution_time;
+      batched_job.resolved_unit_subgraphs = job.resolved_unit_subgraphs;
+      FinishJob(batched_job);
+    }
+  }
+  job_arena_.Free(job.handle);
+
+  // Outputs of an aborted job are discarded even if it ran to the end
+  const bool is_aborted = IsAborted(job.job_id, &aborted_status);
+  if (is_aborted) {
+    job.status = aborted_status;
+  }
+  admission_controller_.OnFinished(job.job_id);
+  engine_.ReleaseJobTensors(job);
   // record finished / failed job
-  if (is_finished) {
-    jobs_finished_record_[GetJobRecordIndex(job.job_id)] = job;
+  const JobId evicted_job_id = finished_jobs_.Complete(job);
+  if (evicted_job_id != -1) {
+    // Outputs of an evicted job cannot be read anymore
+    engine_.DiscardOutputTensors(evicted_job_id).IgnoreError();
+  }
+  if (is_aborted) {
+    std::lock_guard<std::mutex> lock(aborted_jobs_mtx_);
+    aborted_jobs_.erase(job.job_id);
+  }
+  if (job.completion_queue_id != -1) {
+    std::shared_ptr<CompletionQueue> completion_queue =
+        GetCompletionQueue(job.completion_queue_id);
+    if (completion_queue) {
+      completion_queue->Push(job.job_id);
+    }
+  }
+  {
+    std::lock_guard<std::mutex> finished_lock(job_finished_mtx_);
     num_finished_jobs_++;
-    end_invoke_.notify_all();
+    if (num_finished_jobs_ >= num_submitted_jobs_) {
+      all_jobs_finished_.notify_all();
+    }
   }
-  // make sure to unlock before calling callback to avoid
-  // potential recursive locking from client code
-  finished_lock.unlock();
 
   // report end invoke using callback
-  if (job.require_callback && is_finished) {
+  if (job.require_callback) {
     std::unique_lock<std::mutex> callback_lock(on_end_request_mtx_);
     for (auto& id_callback : on_end_request_callbacks_) {
-      id_callback.second(job.job_id, job.status == JobStatus::kSuccess
-                                         ? absl::OkStatus()
-                                         : absl::InternalError("Job failed."));
+      absl::Status status = absl::OkStatus();
+      if (job.status == JobStatus::kCancelled) {
+        status = absl::CancelledError("Job cancelled.");
+      } else if (job.status == JobStatus::kRejected) {
+        status = absl::ResourceExhaustedError("Job rejected.");
+      } else if (job.status == JobStatus::kSLOViolation) {
+        status = absl::DeadlineExceededError("SLO violation.");
+      } else if (job.status != JobStatus::kSuccess) {
+        status = absl::InternalError("Job failed.");
+      }
+      id_callback.second(job.job_id, status);
     }
   }
 }
 
+Job Planner::CreateRemainingOps(const Job& job) {
+  Job remaining_ops(job.model_id);
+  remaining_ops.slo_us = job.slo_us;
+  remaining_ops.enqueue_time = job.enqueue_time;
+  remaining_ops.expected_latency = job.expected_latency;
+  remaining_ops.job_id = job.job_id;
+  remaining_ops.handle = job.handle;
+  remaining_ops.require_callback = job.require_callback;
+  remaining_ops.completion_queue_id = job.completion_queue_id;
+  remaining_ops.priority_class = job.priority_class;
+  remaining_ops.tenant_id = job.tenant_id;
+  remaining_ops.input_handle = job.input_handle;
+  remaining_ops.output_handle = job.output_handle;
+  remaining_ops.resolved_unit_subgraphs = job.resolved_unit_subgraphs;
+  remaining_ops.branch_unit_subgraphs = job.branch_unit_subgraphs;
+  return remaining_ops;
+}
+
+bool Planner::JoinBranch(Job& job) {
+  JobState* state = job_arena_.Get(job.handle);
+  if (state == nullptr) {
+    job.branch_unit_subgraphs.reset();
+    return true;
+  }
+
+  std::unique_lock<std::mutex> lock(state->mtx);
+  if (job.status == JobStatus::kSuccess) {
+    state->resolved_unit_subgraphs |= job.subgraph_key.GetUnitIndices();
+    state->previous_subgraph_keys.push_back(job.subgraph_key);
+  } else if (state->branch_status == JobStatus::kSuccess) {
+    state->branch_status = job.status;
+  }
+  JobStatus aborted_status;
+  const bool is_branch_done =
+      state->branch_status != JobStatus::kSuccess ||
+      IsAborted(job.job_id, &aborted_status) ||
+      (job.branch_unit_subgraphs & ~state->resolved_unit_subgraphs).none();
+  if (!is_branch_done) {
+    lock.unlock();
+    EnqueueRequest(CreateRemainingOps(job), true);
+    return false;
+  }
+  if (--state->num_running_branches > 0) {
+    return false;
+  }
+
+  // The last branch continues as the whole job
+  job.status = state->branch_status;
+  job.resolved_unit_subgraphs = state->resolved_unit_subgraphs;
+  job.branch_unit_subgraphs.reset();
+  return true;
+}
+
+std::vector<BitMask> Planner::GetBranches(
+    ModelId model_id, const BitMask& resolved_unit_subgraphs) const {
+  std::vector<BitMask> branches;
+  const ModelSpec* model_spec = engine_.GetModelSpec(model_id);
+  if (model_spec == nullptr) {
+    return branches;
+  }
+  const size_t num_unit_subgraphs = model_spec->GetNumUnitSubgraphs();
+
+  // Each unit subgraph ready to run starts a branch
+  for (size_t i = 0; i < num_unit_subgraphs; i++) {
+    if (!resolved_unit_subgraphs.test(i) &&
+        (model_spec->GetUnitSubgraphDependency(i) & ~resolved_unit_subgraphs)
+            .none()) {
+      branches.push_back(BitMask().set(i));
+    }
+  }
+  if (branches.size() < 2) {
+    return {};
+  }
+
+  // A unit subgraph joins the branch if it depends on that branch alone.
+  // Dependencies always have lower indices.
+  for (size_t i = 0; i < num_unit_subgraphs; i++) {
+    const BitMask& dependency = model_spec->GetUnitSubgraphDependency(i);
+    if (resolved_unit_subgraphs.test(i)) {
+      continue;
+    }
+    int owner = -1;
+    for (size_t j = 0; j < branches.size(); j++) {
+      if (branches[j].test(i)) {
+        owner = -1;
+        break;
+      }
+      if ((dependency & branches[j]).any()) {
+        if (owner != -1) {
+          owner = -1;
+          break;
+        }
+        owner = j;
+      }
+    }
+    if (owner != -1 &&
+        (dependency & ~(resolved_unit_subgraphs | branches[owner])).none()) {
+      branches[owner].set(i);
+    }
+  }
+  return branches;
+}
+
+bool Planner::IsResolved(const Job& job) const {
+  const ModelSpec* model_spec = engine_.GetModelSpec(job.model_id);
+  return model_spec == nullptr || job.resolved_unit_subgraphs.count() >=
+                                      model_spec->GetNumUnitSubgraphs();
+}
+
+absl::Status Planner::Cancel(const std::vector<JobId>& job_ids) {
+  absl::Status status = absl::OkStatus();
+  std::map<JobId, JobStatus> cancelled_jobs;
+  for (JobId job_id : job_ids) {
+    if (finished_jobs_.IsPending(job_id)) {
+      cancelled_jobs[job_id] = JobStatus::kCancelled;
+    } else if (status.ok()) {
+      status = absl::NotFoundError(
+          absl::StrFormat("Job %d is unknown or already finished", job_id));
+    }
+  }
+  if (!cancelled_jobs.empty()) {
+    Abort(cancelled_jobs);
+  }
+  return status;
+}
+
+void Planner::Abort(const std::map<JobId, JobStatus>& job_statuses) {
+  std::set<JobId> aborted_jobs;
+  {
+    std::lock_guard<std::mutex> lock(aborted_jobs_mtx_);
+    for (auto& job_status : job_statuses) {
+      if (finished_jobs_.IsPending(job_status.first)) {
+        aborted_jobs_.insert(job_status);
+        aborted_jobs.insert(job_status.first);
+      }
+    }
+  }
+  if (aborted_jobs.empty()) {
+    return;
+  }
+
+  for (WorkerId worker_id = 0; worker_id < engine_.GetNumWorkers();
+       worker_id++) {
+    Worker* worker = engine_.GetWorker(worker_id);
+    if (worker) {
+      worker->CancelJobs(aborted_jobs);
+    }
+  }
+  // The rest are dropped from the local queues by the planner threads
+  Trigger();
+}
+
 void Planner::PrepareReenqueue(Job& job) {
   job.invoke_time = 0;
   job.end_time = 0;
   job.resolved_unit_subgraphs = 0;
-  job.following_jobs.clear();
+  JobState* state = job_arena_.Get(job.handle);
+  if (state) {
+    state->previous_subgraph_keys.clear();
+  }
 }
 
 bool Planner::NeedFallbackSubgraphs() const {
@@ -227,13 +652,7 @@ void Planner::SetWindowSize(int schedule_window_size) {
 }
 
 Job Planner::GetFinishedJob(int job_id) {
-  std::lock_guard<std::mutex> request_lock(requests_.mtx);
-  if (IsJobIdValid(job_id) &&
-      jobs_finished_record_[GetJobRecordIndex(job_id)].job_id != -1) {
-    return jobs_finished_record_[GetJobRecordIndex(job_id)];
-  } else {
-    return Job();
-  }
+  return finished_jobs_.GetFinishedJob(job_id);
 }
 
 CallbackId Planner::SetOnEndRequest(
@@ -254,6 +673,93 @@ absl::Status Planner::UnsetOnEndRequest(CallbackId callback_id) {
   return absl::OkStatus();
 }
 
+CompletionQueueId Planner::CreateCompletionQueue() {
+  std::lock_guard<std::mutex> lock(completion_queues_mtx_);
+  completion_queues_[next_completion_queue_id_] =
+      std::make_shared<CompletionQueue>();
+  return next_completion_queue_id_++;
+}
+
+absl::Status Planner::DestroyCompletionQueue(CompletionQueueId queue_id) {
+  std::shared_ptr<CompletionQueue> completion_queue;
+  {
+    std::lock_guard<std::mutex> lock(completion_queues_mtx_);
+    auto it = completion_queues_.find(queue_id);
+    if (it == completion_queues_.end()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Completion queue %d not found.", queue_id));
+    }
+    completion_queue = it->second;
+    completion_queues_.erase(it);
+  }
+  completion_queue->Close();
+  return absl::OkStatus();
+}
+
+std::shared_ptr<CompletionQueue> Planner::GetCompletionQueue(
+    CompletionQueueId queue_id) const {
+  std::lock_guard<std::mutex> lock(completion_queues_mtx_);
+  auto it = completion_queues_.find(queue_id);
+  return it == completion_queues_.end() ? nullptr : it->second;
+}
+
+absl::Status Planner::SetPriorityArbitration(
+    PriorityArbitration arbitration, std::vector<int> weights,
+    int64_t starvation_timeout_us) {
+  for (int weight : weights) {
+    if (weight <= 0) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Invalid priority weight %d, should be positive",
+                          weight));
+    }
+  }
+  std::lock_guard<std::mutex> lock(priority_mtx_);
+  priority_arbitration_ = arbitration;
+  priority_weights_ = weights;
+  starvation_timeout_us_ = starvation_timeout_us;
+  return absl::OkStatus();
+}
+
+absl::Status Planner::SetAdmissionQuota(ModelId model_id,
+                                        int max_pending_jobs) {
+  if (max_pending_jobs != -1 && max_pending_jobs <= 0) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Invalid max pending jobs %d, should be -1 or positive",
+        max_pending_jobs));
+  }
+  if (!admission_controller_.IsEnabled()) {
+    return absl::FailedPreconditionError(
+        "Admission quotas need a shedding policy other than none");
+  }
+  admission_controller_.SetModelQuota(model_id, max_pending_jobs);
+  return absl::OkStatus();
+}
+
+absl::Status Planner::SetBatchingConfig(
+    ModelId model_id, const BatchingConfig& batching_config) {
+  if (batching_config.max_batch_size < 1 || batching_config.max_delay_us < 0) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Invalid batching config (max batch size %d, max delay %lld us)",
+        batching_config.max_batch_size, batching_config.max_delay_us));
+  }
+  {
+    std::lock_guard<std::mutex> lock(batching_configs_mtx_);
+    if (batching_config.max_batch_size == 1) {
+      batching_configs_.erase(model_id);
+    } else {
+      batching_configs_[model_id] = batching_config;
+    }
+  }
+  Trigger();
+  return absl::OkStatus();
+}
+
+void Planner::OnModelReleased(ModelId model_id) {
+  for (auto& scheduler : schedulers_) {
+    scheduler->OnModelReleased(model_id);
+  }
+}
+
 int Planner::GetWorkerType() const {
   int worker_type = 0;
   for (int i = 0; i < schedulers_.size(); ++i) {
@@ -264,57 +770,294 @@ int Planner::GetWorkerType() const {
   return worker_type;
 }
 
-absl::Status Planner::Plan() {
+absl::Status Planner::Plan(Shard& shard) {
+  int64_t timeout_us = -1;
   while (true) {
-    if (planner_safe_bool_.wait()) {
+    const bool terminated = timeout_us < 0
+                                ? shard.safe_bool.wait()
+                                : shard.safe_bool.wait_for(timeout_us);
+    if (terminated) {
       break;
     }
-    if (need_cpu_update_) {
+    if (shard.need_cpu_update) {
       {
         auto status = SetCPUThreadAffinity(cpu_set_);
         if (!status.ok()) {
           BAND_LOG(LogSeverity::kWarning, "%s", status.ToString().c_str());
         }
       }
-      need_cpu_update_ = false;
+      shard.need_cpu_update = false;
     }
-    CopyToLocalQueues();
+    CopyToLocalQueues(shard);
+    DropAbortedJobs(shard);
+    timeout_us = BatchJobs(shard);
     bool need_reschedule = false;
-    for (size_t i = 0; i < local_queues_.size(); ++i) {
+    for (size_t i : GetSchedulingOrder(shard)) {
+      const size_t num_queued_jobs = local_queues_[i].size();
       need_reschedule |= !schedulers_[i]->Schedule(local_queues_[i]);
+      if (local_queues_[i].size() < num_queued_jobs) {
+        UpdateVirtualTime(i, num_queued_jobs - local_queues_[i].size());
+      }
+      const int64_t retry_timeout_us = schedulers_[i]->GetRetryTimeout();
+      if (!local_queues_[i].empty() && retry_timeout_us >= 0 &&
+          (timeout_us < 0 || retry_timeout_us < timeout_us)) {
+        timeout_us = retry_timeout_us;
+      }
     }
 
     if (need_reschedule) {
-      planner_safe_bool_.notify();
+      shard.safe_bool.notify();
     }
   }
   return absl::OkStatus();
 }
 
-void Planner::CopyToLocalQueues() {
-  std::unique_lock<std::mutex> request_lock(GetRequestsMtx());
-  JobQueue& requests = GetRequests();
-  if (!requests.empty()) {
-    if (schedulers_.size() == 1) {
-      // Gets jobs from requests and removes those jobs from the requests.
-      auto& local_jobs = local_queues_[0];
-      local_jobs.insert(local_jobs.end(),
-                        std::make_move_iterator(requests.begin()),
-                        std::make_move_iterator(requests.end()));
-    } else if (schedulers_.size() == 2) {
-      // TODO: general method for assigning SLO/non-SLO requests
-      for (Job& job : requests) {
-        if (job.slo_us > 0) {
-          local_queues_[0].push_back(std::move(job));
-        } else {
-          local_queues_[1].push_back(std::move(job));
+void Planner::CopyToLocalQueues(Shard& shard) {
+  if (shard.requests.IsEmpty()) {
+    return;
+  }
+
+  if (schedulers_.size() == 1) {
+    // Gets jobs from requests and removes those jobs from the requests.
+    shard.requests.PopAll(local_queues_[0]);
+  } else {
+    // Only the jobs of the classes of the shard are routed to it
+    JobQueue requests;
+    shard.requests.PopAll(requests);
+    for (Job& job : requests) {
+      local_queues_[GetPriorityClass(job)].push_back(std::move(job));
+    }
+  }
+}
+
+int Planner::GetPriorityClass(const Job& job) const {
+  const int num_classes = local_queues_.size();
+  if (job.priority_class >= 0 && job.priority_class < num_classes) {
+    return job.priority_class;
+  }
+  // SLO requests are the most urgent, and the others the least
+  return job.slo_us > 0 ? 0 : num_classes - 1;
+}
+
+std::vector<size_t> Planner::GetSchedulingOrder(const Shard& shard) {
+  // The other classes are arbitrated by their own shards
+  std::vector<size_t> order;
+  for (size_t i = 0; i < local_queues_.size(); i++) {
+    if (GetShardIndex(i) == shard.index) {
+      order.push_back(i);
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(priority_mtx_);
+  virtual_times_.resize(local_queues_.size(), 0.);
+  if (priority_arbitration_ == PriorityArbitration::kWeighted) {
+    // An idle class does not save up its share for later
+    double min_virtual_time = -1.;
+    for (size_t i : order) {
+      if (!local_queues_[i].empty() &&
+          (min_virtual_time < 0 || virtual_times_[i] < min_virtual_time)) {
+        min_virtual_time = virtual_times_[i];
+      }
+    }
+    for (size_t i : order) {
+      if (local_queues_[i].empty()) {
+        virtual_times_[i] = std::max(virtual_times_[i], min_virtual_time);
+      }
+    }
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+      return virtual_times_[a] < virtual_times_[b];
+    });
+  }
+
+  if (starvation_timeout_us_ > 0) {
+    // Classes whose oldest job waited too long go first, the oldest first
+    const int64_t current_time = time::NowMicros();
+    std::vector<int64_t> waiting_times(local_queues_.size(), 0);
+    for (size_t i : order) {
+      for (const Job& job : local_queues_[i]) {
+        waiting_times[i] =
+            std::max(waiting_times[i], current_time - job.enqueue_time);
+      }
+    }
+    auto starving_end = std::stable_partition(
+        order.begin(), order.end(), [&](size_t i) {
+          return waiting_times[i] > starvation_timeout_us_;
+        });
+    std::stable_sort(order.begin(), starving_end, [&](size_t a, size_t b) {
+      return waiting_times[a] > waiting_times[b];
+    });
+  }
+  return order;
+}
+
+void Planner::UpdateVirtualTime(size_t priority_class,
+                                size_t num_dispatched_jobs) {
+  std::lock_guard<std::mutex> lock(priority_mtx_);
+  const int weight = priority_class < priority_weights_.size()
+                         ? priority_weights_[priority_class]
+                         : 1;
+  virtual_times_[priority_class] +=
+      static_cast<double>(num_dispatched_jobs) / weight;
+}
+
+int64_t Planner::BatchJobs(Shard& shard) {
+  auto& batching_queues = shard.batching_queues;
+  std::map<ModelId, BatchingConfig> batching_configs;
+  {
+    std::lock_guard<std::mutex> lock(batching_configs_mtx_);
+    if (batching_configs_.empty() && batching_queues.empty()) {
+      return -1;
+    }
+    batching_configs = batching_configs_;
+  }
+
+  for (size_t i = 0; i < local_queues_.size(); ++i) {
+    if (GetShardIndex(i) != shard.index) {
+      continue;
+    }
+    JobQueue remaining_jobs;
+    for (Job& job : local_queues_[i]) {
+      auto config_it = batching_configs.find(job.model_id);
+      // Only fresh jobs are merged, as a batch runs the whole model at once
+      const bool is_batchable = config_it != batching_configs.end() &&
+                                config_it->second.max_batch_size > 1 &&
+                                job.resolved_unit_subgraphs.none() &&
+                                job.batch_size == 1 &&
+                                job.target_worker_id == -1;
+      if (is_batchable) {
+        batching_queues[{i, job.model_id}].push_back(std::move(job));
+      } else {
+        remaining_jobs.push_back(std::move(job));
+      }
+    }
+    local_queues_[i] = std::move(remaining_jobs);
+  }
+
+  const int64_t current_time = time::NowMicros();
+  int64_t timeout_us = -1;
+  for (auto it = batching_queues.begin(); it != batching_queues.end();) {
+    JobQueue& local_queue = local_queues_[it->first.first];
+    JobQueue& jobs = it->second;
+    // Flush the jobs if batching is disabled in the meantime
+    BatchingConfig batching_config;
+    auto config_it = batching_configs.find(it->first.second);
+    if (config_it != batching_configs.end()) {
+      batching_config = config_it->second;
+    }
+    const size_t max_batch_size = std::max(1, batching_config.max_batch_size);
+
+    while (jobs.size() >= max_batch_size) {
+      local_queue.push_back(CreateBatch(jobs, max_batch_size));
+    }
+    if (!jobs.empty()) {
+      const int64_t due_time = GetBatchDueTime(jobs, batching_config);
+      if (due_time <= current_time) {
+        local_queue.push_back(CreateBatch(jobs, jobs.size()));
+      } else if (timeout_us < 0 || due_time - current_time < timeout_us) {
+        timeout_us = due_time - current_time;
+      }
+    }
+
+    it = jobs.empty() ? batching_queues.erase(it) : std::next(it);
+  }
+  return timeout_us;
+}
+
+int64_t Planner::GetBatchDueTime(const JobQueue& jobs,
+                                 const BatchingConfig& batching_config) const {
+  int64_t due_time = jobs.front().enqueue_time + batching_config.max_delay_us;
+
+  // Leave enough time to run the model within the SLO
+  int64_t min_expected_latency = -1;
+  for (const Job& job : jobs) {
+    if (job.slo_us <= 0) {
+      continue;
+    }
+    if (min_expected_latency < 0) {
+      min_expected_latency = 0;
+      for (WorkerId worker_id = 0; worker_id < engine_.GetNumWorkers();
+           worker_id++) {
+        SubgraphKey key =
+            engine_.GetLargestSubgraphKey(job.model_id, worker_id);
+        if (!key.IsValid()) {
+          continue;
+        }
+        int64_t expected_latency = engine_.GetExpected(key);
+        if (min_expected_latency == 0 ||
+            expected_latency < min_expected_latency) {
+          min_expected_latency = expected_latency;
         }
       }
-    }  // other else cases should have been caught in Init()
+    }
+    due_time = std::min(due_time,
+                        job.enqueue_time + job.slo_us - min_expected_latency);
+  }
+  return due_time;
+}
+
+Job Planner::CreateBatch(JobQueue& jobs, size_t batch_size) {
+  Job batch = jobs.front();
+  jobs.pop_front();
+  JobState* state = job_arena_.Get(batch.handle);
+  for (size_t i = 1; i < batch_size && state; i++) {
+    state->batched_jobs.push_back(jobs.front());
+    jobs.pop_front();
+    batch.batch_size++;
+  }
+  return batch;
+}
+
+bool Planner::IsAborted(JobId job_id, JobStatus* status) const {
+  std::lock_guard<std::mutex> lock(aborted_jobs_mtx_);
+  auto it = aborted_jobs_.find(job_id);
+  if (it == aborted_jobs_.end()) {
+    return false;
+  }
+  if (status) {
+    *status = it->second;
+  }
+  return true;
+}
+
+void Planner::DropAbortedJobs(Shard& shard) {
+  std::map<JobId, JobStatus> aborted_job_statuses;
+  {
+    std::lock_guard<std::mutex> lock(aborted_jobs_mtx_);
+    if (aborted_jobs_.empty()) {
+      return;
+    }
+    aborted_job_statuses = aborted_jobs_;
+  }
+
+  JobQueue aborted_jobs;
+  auto remove_aborted = [&](JobQueue& jobs) {
+    for (auto it = jobs.begin(); it != jobs.end();) {
+      // A batch runs for the other requests as well
+      auto status_it = aborted_job_statuses.find(it->job_id);
+      if (it->batch_size == 1 && status_it != aborted_job_statuses.end()) {
+        it->status = status_it->second;
+        aborted_jobs.push_back(std::move(*it));
+        it = jobs.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  };
+  for (size_t i = 0; i < local_queues_.size(); i++) {
+    if (GetShardIndex(i) == shard.index) {
+      remove_aborted(local_queues_[i]);
+    }
+  }
+  auto& batching_queues = shard.batching_queues;
+  for (auto it = batching_queues.begin(); it != batching_queues.end();) {
+    remove_aborted(it->second);
+    it = it->second.empty() ? batching_queues.erase(it) : std::next(it);
+  }
 
-    requests.clear();
+  for (Job& job : aborted_jobs) {
+    job.end_time = time::NowMicros();
+    EnqueueFinishedJob(job);
   }
-  request_lock.unlock();
 }
 
 bool Planner::EnqueueToWorker(const std::vector<ScheduleAction>& actions) {
@@ -333,6 +1076,9 @@ bool Planner::EnqueueToWorker(const std::vector<ScheduleAction>& actions) {
                target_key.GetWorkerId());
       job.status = JobStatus::kEnqueueFailed;
       EnqueueFinishedJob(job);
+    } else if (job.batch_size == 1 && IsAborted(job.job_id, &job.status)) {
+      job.end_time = time::NowMicros();
+      EnqueueFinishedJob(job);
     } else if (IsSLOViolated(job)) {
       // no point in running this job anymore
       job.status = JobStatus::kSLOViolation;
@@ -347,8 +1093,24 @@ bool Planner::EnqueueToWorker(const std::vector<ScheduleAction>& actions) {
       std::lock_guard<std::mutex> lock(worker->GetDeviceMtx());
 
       if (worker->IsEnqueueReady()) {
+        if (job.batch_size > 1 &&
+            !(engine_.IsBegin(target_key) && engine_.IsEnd(target_key))) {
+          // A batch can only run the whole model at once
+          JobState* state = job_arena_.Get(job.handle);
+          if (state) {
+            EnqueueBatch(state->batched_jobs, true);
+            state->batched_jobs.clear();
+          }
+          job.batch_size = 1;
+        }
         UpdateJobScheduleStatus(job, target_key);
-        if (!worker->EnqueueJob(job)) {
+        if (worker->EnqueueJob(job)) {
+          admission_controller_.OnDispatched(job.job_id);
+          JobState* state = job_arena_.Get(job.handle);
+          for (size_t i = 0; state && i < state->batched_jobs.size(); i++) {
+            admission_controller_.OnDispatched(state->batched_jobs[i].job_id);
+          }
+        } else {
           BAND_LOG(LogSeverity::kError,
                    "EnqueueToWorker failed. Requests scheduled to "
                    "unavailable worker id %d",
@@ -385,32 +1147,6 @@ void Planner::UpdateJobScheduleStatus(Job& job, const SubgraphKey& target_key) {
   job.profiled_execution_time = engine_.GetProfiled(target_key);
   job.expected_execution_time = engine_.GetExpected(target_key);
   job.resolved_unit_subgraphs |= target_key.GetUnitIndices();
-
-  if (!engine_.IsEnd(target_key)) {
-    Job remaining_ops(job.model_id);
-    remaining_ops.model_fname = job.model_fname;
-    remaining_ops.slo_us = job.slo_us;
-    remaining_ops.enqueue_time = job.enqueue_time;
-    remaining_ops.following_jobs = job.following_jobs;
-    remaining_ops.expected_latency = job.expected_latency;
-    remaining_ops.job_id = job.job_id;
-    remaining_ops.input_handle = job.input_handle;
-    remaining_ops.output_handle = job.output_handle;
-    remaining_ops.resolved_unit_subgraphs = job.resolved_unit_subgraphs;
-    remaining_ops.previous_subgraph_keys = job.previous_subgraph_keys;
-    remaining_ops.previous_subgraph_keys.emplace_back(job.subgraph_key);
-
-    job.following_jobs.clear();
-    job.following_jobs.push_back(remaining_ops);
-  }
-}
-
-bool Planner::IsJobIdValid(int job_id) {
-  return num_submitted_jobs_ - job_id <= NUM_FINISHED_RECORDS;
-}
-
-int Planner::GetJobRecordIndex(int job_id) const {
-  return job_id % NUM_FINISHED_RECORDS;
 }
 
 }  // namespace band
@@ -17,30 +17,27 @@
 #ifndef BAND_PLANNER_H_
 #define BAND_PLANNER_H_
 
-#include <array>
 #include <atomic>
 #include <functional>
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "band/admission_controller.h"
+#include "band/completion_queue.h"
 #include "band/config.h"
+#include "band/job_arena.h"
+#include "band/job_completion_store.h"
+#include "band/request_queue.h"
 #include "band/safe_bool.h"
 #include "band/scheduler/scheduler.h"
 #include "band/worker.h"
 
 namespace band {
 
-// The maximum number of available job outputs at one time.
-#define NUM_FINISHED_RECORDS 1000
-
-// The job queue which can be shared by multiple threads.
-struct ConcurrentJobQueue {
-  JobQueue queue;
-  std::mutex mtx;
-};
-
 class Planner {
  public:
   explicit Planner(IEngine& engine);
@@ -52,7 +49,11 @@ class Planner {
   // Enqueues a job to a worker request queue.
   JobId EnqueueRequest(Job job, bool push_front = false);
   // Enqueues a batch of jobs to a worker request queue.
-  // Assigns new job id for non-continuous job.
+  // Assigns new job id for non-continuous job. Lock-free, and jobs enqueued
+  // with `push_front` are scheduled before the others.
+  // Job ids increase in the order of submission and stay in order within a
+  // batch, but concurrent batches may reach the queue in a different order
+  // than their ids. Schedulers must not rely on queue order being id order.
   std::vector<JobId> EnqueueBatch(std::vector<Job> jobs,
                                   bool push_front = false);
   // Waits until the jobs are done.
@@ -63,10 +64,38 @@ class Planner {
   // A worker calls the method.
   void EnqueueFinishedJob(Job& job);
   void PrepareReenqueue(Job& job);
+  // Cancels the jobs that are not finished yet. Queued jobs are dropped, and
+  // the remaining subgraphs of a job in progress are skipped. Cancelled jobs
+  // finish with `JobStatus::kCancelled`. Returns NotFound if any of the jobs
+  // is unknown or finished, after cancelling the others.
+  absl::Status Cancel(const std::vector<JobId>& job_ids);
   // Enqueue the request to the worker.
   // Returns true if the request is successfully enqueued.
   bool EnqueueToWorker(const std::vector<ScheduleAction>& action);
-  void Trigger() { planner_safe_bool_.notify(); }
+  // Wakes up every planner thread.
+  void Trigger();
+  // Schedules the priority classes on `num_shards` planner threads, where
+  // the class `i` belongs to the shard `i % num_shards`. Must be called
+  // before any request is enqueued, and only once.
+  absl::Status SetNumShards(int num_shards);
+  int GetNumShards() const { return shards_.size(); }
+
+  // Sets the dynamic batching of the model. Batching is disabled if
+  // `max_batch_size` is 1.
+  absl::Status SetBatchingConfig(ModelId model_id,
+                                 const BatchingConfig& batching_config);
+  // Lets the schedulers drop their state of an unregistered model.
+  void OnModelReleased(ModelId model_id);
+  // Sets how the queues of the priority classes take turns. `weights` are
+  // per class, and empty for the same weight.
+  absl::Status SetPriorityArbitration(PriorityArbitration arbitration,
+                                      std::vector<int> weights,
+                                      int64_t starvation_timeout_us);
+  // Each scheduler serves a priority class.
+  int GetNumPriorityClasses() const { return local_queues_.size(); }
+  // Sets the maximum number of unfinished requests of the model admitted by
+  // the shedding policy. -1 for unlimited.
+  absl::Status SetAdmissionQuota(ModelId model_id, int max_pending_jobs);
 
   // Checks if the schedulers can handle fallback subgraphs.
   // Returns true if any of the scheduler can handle fallback subgraphs.
@@ -74,10 +103,12 @@ class Planner {
   // may lead to unexpected results.
   bool NeedFallbackSubgraphs() const;
 
-  std::mutex& GetRequestsMtx() { return requests_.mtx; }
-  JobQueue& GetRequests() { return requests_.queue; }
   int GetWindowSize() const { return schedule_window_size_; }
   void SetWindowSize(int schedule_window_size);
+  // Runs independent unit subgraphs of a request on different workers.
+  void SetParallelUnitSubgraphs(bool parallel_unit_subgraphs) {
+    parallel_unit_subgraphs_ = parallel_unit_subgraphs;
+  }
   const std::map<int, int>& GetModelExecutionCounts() const {
     return model_execution_count_;
   }
@@ -85,21 +116,86 @@ class Planner {
   CallbackId SetOnEndRequest(
       std::function<void(int, absl::Status)> on_end_request);
   absl::Status UnsetOnEndRequest(CallbackId callback_id);
+  // Completion queues to report finished jobs in the order of completion.
+  CompletionQueueId CreateCompletionQueue();
+  absl::Status DestroyCompletionQueue(CompletionQueueId queue_id);
+  // Returns nullptr if the queue does not exist.
+  std::shared_ptr<CompletionQueue> GetCompletionQueue(
+      CompletionQueueId queue_id) const;
 
   // Get the Job instance with the `job_id`.
   Job GetFinishedJob(int job_id);
+  // State of the jobs in flight. A job is allocated on `EnqueueBatch` and
+  // freed once it finishes.
+  JobArena& GetJobArena() { return job_arena_; }
   // Get which worker types the schedulers require.
   int GetWorkerType() const;
   std::map<ModelId, WorkerId>& GetModelWorkerMap() { return model_worker_map_; }
 
  private:
-  // Main loop for planner_thread_
-  absl::Status Plan();
+  // A planner thread and the queues it owns. Jobs of the priority classes
+  // of a shard are routed to its request queue, so that the shards never
+  // touch each other's local queues.
+  struct Shard {
+    size_t index = 0;
+    SafeBool safe_bool;
+    RequestQueue requests;
+    // Jobs waiting for a batch, per (local queue index, model)
+    std::map<std::pair<int, ModelId>, JobQueue> batching_queues;
+    bool need_cpu_update = false;
+    std::thread thread;
+  };
+
+  // Starts the thread of a new shard.
+  void AddShard();
+  // Main loop of a shard thread
+  absl::Status Plan(Shard& shard);
   // Write job logs and delete the job from the finished queue.
   void FlushFinishedJobs();
-  // Copy the Job instances from the `requests_` to the local queue.
-  // Note that this function is to minimize the hold time for the queue lock.
-  void CopyToLocalQueues();
+  // Report the worker time of a finished subgraph to the schedulers.
+  void ReportWorkerTime(const Job& job);
+  void FinishJob(Job& job);
+  // Copy of the request descriptor to schedule the remaining ops.
+  static Job CreateRemainingOps(const Job& job);
+  // Merges a finished subgraph of a forked branch into the job state.
+  // Returns true if it was the last running branch, and updates the job to
+  // continue as a whole.
+  bool JoinBranch(Job& job);
+  // Independent sets of unit subgraphs that can run after the resolved ones.
+  // Returns an empty list if there are less than two of them.
+  std::vector<BitMask> GetBranches(
+      ModelId model_id, const BitMask& resolved_unit_subgraphs) const;
+  // Returns true if every unit subgraph of the job is resolved.
+  bool IsResolved(const Job& job) const;
+  // Pushes the jobs to the request queues of their shards.
+  void PushRequests(std::vector<Job> jobs, bool push_front);
+  // Move the Job instances from the request queue of the shard to its
+  // local queues.
+  void CopyToLocalQueues(Shard& shard);
+  int GetPriorityClass(const Job& job) const;
+  size_t GetShardIndex(size_t priority_class) const {
+    return priority_class % shards_.size();
+  }
+  // Order of the local queues of the shard to schedule in this round.
+  std::vector<size_t> GetSchedulingOrder(const Shard& shard);
+  // Charge the priority class for the dispatched jobs.
+  void UpdateVirtualTime(size_t priority_class, size_t num_dispatched_jobs);
+  // Move batchable jobs from the local queues to the batching queues of the
+  // shard, and put them back as batches once a batch is full or cannot wait
+  // anymore. Returns the time until the next pending batch is due, or -1 if
+  // none.
+  int64_t BatchJobs(Shard& shard);
+  // The latest time to dispatch a batch of the jobs without delaying any of
+  // them by more than the max delay or past its SLO.
+  int64_t GetBatchDueTime(const JobQueue& jobs,
+                          const BatchingConfig& batching_config) const;
+  Job CreateBatch(JobQueue& jobs, size_t batch_size);
+  // Stops the unfinished jobs, which finish with the given status.
+  void Abort(const std::map<JobId, JobStatus>& job_statuses);
+  // Returns true with the status to finish the job with if it is aborted.
+  bool IsAborted(JobId job_id, JobStatus* status = nullptr) const;
+  // Finish the aborted jobs in the local and batching queues of the shard.
+  void DropAbortedJobs(Shard& shard);
   // Check if the job violated the specified SLO.
   // This func assumes that workers_waiting_, job.profiled_time,
   // job.device_id, and job.enqueue_time are all up to date.
@@ -108,13 +204,8 @@ class Planner {
   void UpdateJobScheduleStatus(Job& job, const SubgraphKey& target_key);
   // Update `model_worker_map_`.
   void TryUpdateModelWorkerMapping();
-  bool IsJobIdValid(int job_id);
-  int GetJobRecordIndex(int job_id) const;
 
   CpuSet cpu_set_;
-  bool need_cpu_update_ = false;
-
-  SafeBool planner_safe_bool_;
 
   // Jobs Finished
   std::map<int, int> model_execution_count_;
@@ -124,25 +215,47 @@ class Planner {
       on_end_request_callbacks_;
   CallbackId next_callback_id_ = 0;
 
-  // Request Queue
-  ConcurrentJobQueue requests_;
+  mutable std::mutex completion_queues_mtx_;
+  std::map<CompletionQueueId, std::shared_ptr<CompletionQueue>>
+      completion_queues_;
+  CompletionQueueId next_completion_queue_id_ = 0;
+
+  // Planner threads, the first of which runs from the construction
+  std::vector<std::unique_ptr<Shard>> shards_;
+  JobArena job_arena_;
 
   // Multi-level Local Queue.
   // The closer the index is to 0, the higher the priority.
   std::vector<JobQueue> local_queues_;
   std::vector<std::unique_ptr<IScheduler>> schedulers_;
 
-  std::mutex job_finished_mtx_;
-  std::array<Job, NUM_FINISHED_RECORDS> jobs_finished_record_;
+  // Arbitration between the local queues
+  std::mutex priority_mtx_;
+  PriorityArbitration priority_arbitration_ = PriorityArbitration::kStrict;
+  std::vector<int> priority_weights_;
+  int64_t starvation_timeout_us_ = -1;
+  // Dispatched jobs per weight of each class
+  std::vector<double> virtual_times_;
+
+  // Dynamic batching
+  std::mutex batching_configs_mtx_;
+  std::map<ModelId, BatchingConfig> batching_configs_;
+
+  JobCompletionStore finished_jobs_;
+  AdmissionController admission_controller_;
+  // Cancelled or shed jobs until they finish
+  mutable std::mutex aborted_jobs_mtx_;
+  std::map<JobId, JobStatus> aborted_jobs_;
   std::atomic<int> num_submitted_jobs_;
+  // Guards `num_finished_jobs_` for `WaitAll`
+  std::mutex job_finished_mtx_;
   int num_finished_jobs_ = 0;
-
-  std::condition_variable end_invoke_;
+  std::condition_variable all_jobs_finished_;
   std::string log_path_;
 
   int schedule_window_size_ = std::numeric_limits<int>::max();
+  bool parallel_unit_subgraphs_ = false;
 
-  std::thread planner_thread_;
   // Map structure to find assigned worker of model idx (model_id, worker_id)
   std::map<ModelId, WorkerId> model_worker_map_;
   IEngine& engine_;
@@ -0,0 +1,85 @@
+// Copyright 2023 Seoul National University
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "band/request_queue.h"
+
+namespace band {
+
+RequestQueue::~RequestQueue() {
+  for (auto& head : heads_) {
+    Node* node = head.exchange(nullptr);
+    while (node) {
+      Node* next = node->next;
+      delete node;
+      node = next;
+    }
+  }
+}
+
+void RequestQueue::Push(std::vector<Job> jobs, bool high_priority) {
+  if (jobs.empty()) {
+    return;
+  }
+
+  // Chain the batch in the reverse order, so that the consumer restores the
+  // order by reversing the whole stack.
+  Node* first = nullptr;
+  Node* last = nullptr;
+  for (Job& job : jobs) {
+    Node* node = new Node{std::move(job), first};
+    if (last == nullptr) {
+      last = node;
+    }
+    first = node;
+  }
+
+  std::atomic<Node*>& head = heads_[high_priority ? kHighPriority : kNormal];
+  Node* old_head = head.load(std::memory_order_relaxed);
+  do {
+    last->next = old_head;
+  } while (!head.compare_exchange_weak(old_head, first,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed));
+}
+
+void RequestQueue::PopAll(JobQueue& jobs) {
+  for (auto& head : heads_) {
+    Node* node = head.exchange(nullptr, std::memory_order_acquire);
+    // Reverse to the order of push
+    Node* reversed = nullptr;
+    while (node) {
+      Node* next = node->next;
+      node->next = reversed;
+      reversed = node;
+      node = next;
+    }
+    while (reversed) {
+      Node* next = reversed->next;
+      jobs.push_back(std::move(reversed->job));
+      delete reversed;
+      reversed = next;
+    }
+  }
+}
+
+bool RequestQueue::IsEmpty() const {
+  for (auto& head : heads_) {
+    if (head.load(std::memory_order_acquire) != nullptr) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace band
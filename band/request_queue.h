@@ -0,0 +1,60 @@
+/*
+ * Copyright 2023 Seoul National University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BAND_REQUEST_QUEUE_H_
+#define BAND_REQUEST_QUEUE_H_
+
+#include <atomic>
+#include <vector>
+
+#include "band/common.h"
+#include "band/engine_interface.h"
+
+namespace band {
+
+// Lock-free multi-producer single-consumer queue for incoming requests.
+// Producers push a batch with a single CAS, and the consumer takes every
+// pending job at once, so neither side blocks the other.
+// Jobs pushed to the high-priority lane are popped before the others.
+class RequestQueue {
+ public:
+  RequestQueue() = default;
+  ~RequestQueue();
+  RequestQueue(const RequestQueue&) = delete;
+  RequestQueue& operator=(const RequestQueue&) = delete;
+
+  // Thread-safe. Jobs in a batch are kept in order.
+  void Push(std::vector<Job> jobs, bool high_priority = false);
+  // Appends all pending jobs to `jobs` in the order of push, high-priority
+  // jobs first. Only a single consumer may call this at a time.
+  void PopAll(JobQueue& jobs);
+  bool IsEmpty() const;
+
+ private:
+  struct Node {
+    Job job;
+    Node* next = nullptr;
+  };
+
+  enum Lane { kHighPriority = 0, kNormal = 1, kNumLanes = 2 };
+
+  // Each lane is a stack of nodes in the reverse order of push
+  std::atomic<Node*> heads_[kNumLanes] = {{nullptr}, {nullptr}};
+};
+
+}  // namespace band
+
+#endif  // BAND_REQUEST_QUEUE_H_
@@ -14,6 +14,8 @@
 
 #include "band/safe_bool.h"
 
+#include <chrono>
+
 namespace band {
 void SafeBool::notify() {
   std::lock_guard<std::mutex> lock(m);
@@ -30,6 +32,14 @@ bool SafeBool::wait() {
   return exit;
 }
 
+bool SafeBool::wait_for(int64_t timeout_us) {
+  std::unique_lock<std::mutex> lock(m);
+  c.wait_for(lock, std::chrono::microseconds(timeout_us),
+             [this]() { return exit || flag; });
+  flag = false;
+  return exit;
+}
+
 void SafeBool::terminate() {
   std::lock_guard<std::mutex> lock(m);
   exit = true;
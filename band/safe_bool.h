@@ -18,6 +18,7 @@
 #define BAND_SAFE_BOOL_H_
 
 #include <condition_variable>
+#include <cstdint>
 #include <mutex>
 namespace band {
 class SafeBool {
@@ -27,6 +28,8 @@ class SafeBool {
 
   void notify();
   bool wait();
+  // Waits at most `timeout_us`. Returns true if terminated.
+  bool wait_for(int64_t timeout_us);
   void terminate();
 
  private:
@@ -0,0 +1,144 @@
+// Copyright 2023 Seoul National University
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "band/scheduler/earliest_deadline_first_scheduler.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+#include "band/time.h"
+
+namespace band {
+
+EarliestDeadlineFirstScheduler::EarliestDeadlineFirstScheduler(
+    IEngine& engine, int window_size)
+    : IScheduler(engine), window_size_(window_size) {}
+
+bool EarliestDeadlineFirstScheduler::Schedule(JobQueue& requests) {
+  bool success = true;
+  const int window_size = std::min(window_size_, (int)requests.size());
+  if (window_size <= 0) {
+    sub_deadlines_.clear();
+    return success;
+  }
+
+  engine_.UpdateWorkersWaiting();
+  std::set<WorkerId> idle_workers = engine_.GetIdleWorkers();
+  if (idle_workers.empty()) {
+    return success;
+  }
+  WorkerWaitingTime waiting_time = engine_.GetWorkerWaitingTime();
+  const int64_t current_time = time::NowMicros();
+
+  // (sub-deadline, index in the queue), the earliest on top
+  std::vector<std::pair<int64_t, int>> deadline_heap;
+  deadline_heap.reserve(window_size);
+  std::unordered_map<std::pair<int, BitMask>, int64_t, JobIdBitMaskHash>
+      sub_deadlines;
+  for (int i = 0; i < window_size; i++) {
+    const Job& job = requests[i];
+    const std::pair<int, BitMask> key = {job.job_id,
+                                         job.resolved_unit_subgraphs};
+    auto it = sub_deadlines_.find(key);
+    const int64_t sub_deadline =
+        it != sub_deadlines_.end()
+            ? it->second
+            : GetSubDeadline(job, current_time, waiting_time);
+    sub_deadlines[key] = sub_deadline;
+    deadline_heap.push_back({sub_deadline, i});
+  }
+  // Jobs that left the queue are forgotten
+  sub_deadlines_ = std::move(sub_deadlines);
+  std::make_heap(deadline_heap.begin(), deadline_heap.end(),
+                 std::greater<std::pair<int64_t, int>>());
+
+  std::set<int> job_indices_to_erase;
+  while (!deadline_heap.empty() && !idle_workers.empty()) {
+    std::pop_heap(deadline_heap.begin(), deadline_heap.end(),
+                  std::greater<std::pair<int64_t, int>>());
+    const int job_index = deadline_heap.back().second;
+    deadline_heap.pop_back();
+    Job job = requests[job_index];
+
+    std::pair<std::vector<SubgraphKey>, int64_t> best_exec_plan =
+        engine_.GetSubgraphWithShortestLatency(job, waiting_time);
+    if (best_exec_plan.first.empty()) {
+      continue;
+    }
+    const SubgraphKey target_subgraph_key = best_exec_plan.first.front();
+
+    // No point in running the job if it cannot meet the deadline anyway
+    if (job.slo_us > 0 && current_time + best_exec_plan.second >
+                              job.enqueue_time + job.slo_us) {
+      job.status = JobStatus::kSLOViolation;
+      success &= engine_.EnqueueToWorker({job, target_subgraph_key});
+      job_indices_to_erase.insert(job_index);
+      continue;
+    }
+
+    // Otherwise, the job waits for its best worker
+    const WorkerId worker_id = target_subgraph_key.GetWorkerId();
+    if (idle_workers.find(worker_id) != idle_workers.end()) {
+      waiting_time[worker_id] += engine_.GetExpected(target_subgraph_key);
+      idle_workers.erase(worker_id);
+      if (engine_.IsBegin(target_subgraph_key)) {
+        job.expected_latency = best_exec_plan.second;
+      }
+      success &= engine_.EnqueueToWorker({job, target_subgraph_key});
+      job_indices_to_erase.insert(job_index);
+    }
+  }
+
+  for (auto it = job_indices_to_erase.rbegin();
+       it != job_indices_to_erase.rend(); ++it) {
+    const Job& job = requests[*it];
+    sub_deadlines_.erase({job.job_id, job.resolved_unit_subgraphs});
+    requests.erase(requests.begin() + *it);
+  }
+  return success;
+}
+
+int64_t EarliestDeadlineFirstScheduler::GetSubDeadline(
+    const Job& job, int64_t current_time,
+    const WorkerWaitingTime& waiting_time) const {
+  if (job.slo_us <= 0) {
+    return std::numeric_limits<int64_t>::max();
+  }
+  const int64_t deadline = job.enqueue_time + job.slo_us;
+  if (deadline <= current_time) {
+    return deadline;
+  }
+
+  // The next subgraph gets the share of the time left in proportion to its
+  // expected latency among the remaining subgraphs
+  std::pair<std::vector<SubgraphKey>, int64_t> best_exec_plan =
+      engine_.GetSubgraphWithShortestLatency(job, waiting_time);
+  int64_t next_latency = 0;
+  int64_t remaining_latency = 0;
+  for (size_t i = 0; i < best_exec_plan.first.size(); i++) {
+    const int64_t latency = engine_.GetExpected(best_exec_plan.first[i]);
+    if (i == 0) {
+      next_latency = latency;
+    }
+    remaining_latency += latency;
+  }
+  if (remaining_latency <= 0) {
+    return deadline;
+  }
+  return current_time +
+         (deadline - current_time) * next_latency / remaining_latency;
+}
+
+}  // namespace band
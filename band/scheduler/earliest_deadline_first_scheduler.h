@@ -0,0 +1,53 @@
+/*
+ * Copyright 2023 Seoul National University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef BAND_SCHEDULER_EARLIEST_DEADLINE_FIRST_SCHEDULER_H_
+#define BAND_SCHEDULER_EARLIEST_DEADLINE_FIRST_SCHEDULER_H_
+
+#include <unordered_map>
+
+#include "band/scheduler/scheduler.h"
+
+namespace band {
+
+// Dispatches the job with the earliest deadline (`enqueue_time + slo_us`)
+// first, and jobs without SLO in the order of arrival after them.
+// The time left to the deadline of a job with multiple subgraphs to go is
+// split among the subgraphs by their expected latency, so that the job is
+// ordered by the sub-deadline of its next subgraph.
+class EarliestDeadlineFirstScheduler : public IScheduler {
+ public:
+  explicit EarliestDeadlineFirstScheduler(IEngine& engine, int window_size);
+
+  bool Schedule(JobQueue& requests) override;
+  bool NeedFallbackSubgraphs() override { return true; }
+  WorkerType GetWorkerType() override { return WorkerType::kGlobalQueue; }
+
+ private:
+  int64_t GetSubDeadline(const Job& job, int64_t current_time,
+                         const WorkerWaitingTime& waiting_time) const;
+
+  const int window_size_;
+  // Sub-deadline of the queued jobs, per (job id, resolved unit subgraphs),
+  // computed once for each subgraph of a job
+  std::unordered_map<std::pair<int, BitMask>, int64_t, JobIdBitMaskHash>
+      sub_deadlines_;
+};
+
+}  // namespace band
+
+#endif  // BAND_SCHEDULER_EARLIEST_DEADLINE_FIRST_SCHEDULER_H_
@@ -0,0 +1,186 @@
+// Copyright 2023 Seoul National University
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "band/scheduler/fair_share_scheduler.h"
+
+#include <algorithm>
+#include <set>
+
+#include "band/time.h"
+
+namespace band {
+
+FairShareScheduler::FairShareScheduler(
+    IEngine& engine, std::map<int, FairShareConfig> fair_share_configs)
+    : IScheduler(engine), fair_share_configs_(fair_share_configs) {}
+
+bool FairShareScheduler::Schedule(JobQueue& requests) {
+  std::vector<ScheduleAction> actions;
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    const int64_t current_time = time::NowMicros();
+
+    // A tenant back from idle starts from the least virtual time of the busy
+    // ones, instead of claiming the share it did not use
+    std::set<int> queued_tenants;
+    for (const Job& job : requests) {
+      queued_tenants.insert(GetTenantId(job));
+    }
+    double min_virtual_time = -1;
+    for (auto& id_tenant : tenants_) {
+      const Tenant& tenant = id_tenant.second;
+      if (tenant.is_backlogged &&
+          (min_virtual_time < 0 || tenant.virtual_time < min_virtual_time)) {
+        min_virtual_time = tenant.virtual_time;
+      }
+    }
+    for (int tenant_id : queued_tenants) {
+      Tenant& tenant = tenants_[tenant_id];
+      if (!tenant.is_backlogged) {
+        tenant.virtual_time = std::max(tenant.virtual_time, min_virtual_time);
+        tenant.is_backlogged = true;
+      }
+      Refill(tenant_id, current_time);
+    }
+
+    for (WorkerId worker_id : engine_.GetIdleWorkers()) {
+      auto target_it = requests.end();
+      double target_virtual_time = 0;
+      SubgraphKey target_key;
+      for (auto it = requests.begin(); it != requests.end(); ++it) {
+        const int tenant_id = GetTenantId(*it);
+        const double virtual_time = tenants_[tenant_id].virtual_time;
+        if ((target_it != requests.end() &&
+             virtual_time >= target_virtual_time) ||
+            IsThrottled(tenant_id)) {
+          continue;
+        }
+        SubgraphKey key =
+            engine_.GetLargestSubgraphKey(it->model_id, worker_id);
+        if (key.IsValid()) {
+          target_it = it;
+          target_virtual_time = virtual_time;
+          target_key = key;
+        }
+      }
+      if (target_it == requests.end()) {
+        continue;
+      }
+
+      // Charge the expected time until the measured one is reported
+      const int tenant_id = GetTenantId(*target_it);
+      const int64_t expected_time =
+          std::max<int64_t>(engine_.GetExpected(target_key), 0);
+      Charge(tenant_id, expected_time);
+      tenants_[tenant_id].num_running_jobs++;
+      running_jobs_[target_it->job_id] = {tenant_id, expected_time};
+
+      actions.push_back({*target_it, target_key});
+      requests.erase(target_it);
+    }
+
+    retry_timeout_us_ = -1;
+    queued_tenants.clear();
+    for (const Job& job : requests) {
+      queued_tenants.insert(GetTenantId(job));
+    }
+    for (auto& id_tenant : tenants_) {
+      Tenant& tenant = id_tenant.second;
+      const bool is_queued =
+          queued_tenants.find(id_tenant.first) != queued_tenants.end();
+      tenant.is_backlogged = is_queued || tenant.num_running_jobs > 0;
+      if (is_queued && IsThrottled(id_tenant.first)) {
+        // Until the bucket has tokens again
+        const int64_t rate_limit_us = GetConfig(id_tenant.first).rate_limit_us;
+        const int64_t timeout_us =
+            static_cast<int64_t>(-tenant.tokens * 1000000 / rate_limit_us) + 1;
+        if (retry_timeout_us_ < 0 || timeout_us < retry_timeout_us_) {
+          retry_timeout_us_ = timeout_us;
+        }
+      }
+    }
+  }
+
+  // The planner may report a job that ends early, which locks `mtx_`
+  bool success = true;
+  for (const ScheduleAction& action : actions) {
+    success &= engine_.EnqueueToWorker(action);
+  }
+  return success;
+}
+
+void FairShareScheduler::OnJobFinished(const Job& job,
+                                       int64_t worker_time_us) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto it = running_jobs_.find(job.job_id);
+  if (it != running_jobs_.end()) {
+    Charge(it->second.first, -it->second.second);
+    tenants_[it->second.first].num_running_jobs--;
+    running_jobs_.erase(it);
+  }
+  Charge(GetTenantId(job), worker_time_us);
+}
+
+int64_t FairShareScheduler::GetRetryTimeout() const {
+  std::lock_guard<std::mutex> lock(mtx_);
+  return retry_timeout_us_;
+}
+
+int FairShareScheduler::GetTenantId(const Job& job) {
+  return job.tenant_id != -1 ? job.tenant_id : -2 - job.model_id;
+}
+
+double FairShareScheduler::GetVirtualTime(int tenant_id) const {
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto it = tenants_.find(tenant_id);
+  return it != tenants_.end() ? it->second.virtual_time : 0;
+}
+
+const FairShareConfig& FairShareScheduler::GetConfig(int tenant_id) const {
+  auto it = fair_share_configs_.find(tenant_id);
+  return it != fair_share_configs_.end() ? it->second : default_config_;
+}
+
+void FairShareScheduler::Refill(int tenant_id, int64_t current_time) {
+  const FairShareConfig& config = GetConfig(tenant_id);
+  if (config.rate_limit_us < 0) {
+    return;
+  }
+  Tenant& tenant = tenants_[tenant_id];
+  const double capacity =
+      config.burst_us > 0 ? config.burst_us : config.rate_limit_us;
+  if (tenant.last_refill_time == 0) {
+    tenant.tokens = capacity;
+  } else {
+    const double elapsed_us = current_time - tenant.last_refill_time;
+    tenant.tokens = std::min(
+        capacity, tenant.tokens + elapsed_us * config.rate_limit_us / 1000000);
+  }
+  tenant.last_refill_time = current_time;
+}
+
+bool FairShareScheduler::IsThrottled(int tenant_id) const {
+  auto it = tenants_.find(tenant_id);
+  return GetConfig(tenant_id).rate_limit_us >= 0 && it != tenants_.end() &&
+         it->second.tokens <= 0;
+}
+
+void FairShareScheduler::Charge(int tenant_id, int64_t worker_time_us) {
+  Tenant& tenant = tenants_[tenant_id];
+  tenant.virtual_time +=
+      static_cast<double>(worker_time_us) / GetConfig(tenant_id).weight;
+  tenant.tokens -= worker_time_us;
+}
+
+}  // namespace band
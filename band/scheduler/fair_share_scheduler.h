@@ -0,0 +1,77 @@
+/*
+ * Copyright 2023 Seoul National University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BAND_SCHEDULER_FAIR_SHARE_SCHEDULER_H_
+#define BAND_SCHEDULER_FAIR_SHARE_SCHEDULER_H_
+
+#include <map>
+#include <mutex>
+
+#include "band/config.h"
+#include "band/scheduler/scheduler.h"
+
+namespace band {
+
+// Shares the workers among tenants by the worker time they used, so that a
+// busy tenant cannot monopolize a worker. An idle worker runs the oldest
+// request of the tenant with the least worker time per weight, unless the
+// tenant is over its rate limit.
+class FairShareScheduler : public IScheduler {
+ public:
+  FairShareScheduler(IEngine& engine,
+                     std::map<int, FairShareConfig> fair_share_configs);
+
+  bool Schedule(JobQueue& requests) override;
+  bool NeedFallbackSubgraphs() override { return false; }
+  WorkerType GetWorkerType() override { return WorkerType::kGlobalQueue; }
+  void OnJobFinished(const Job& job, int64_t worker_time_us) override;
+  int64_t GetRetryTimeout() const override;
+
+  // Untagged requests belong to their model, which is kept apart from the
+  // tagged tenants by a negative id.
+  static int GetTenantId(const Job& job);
+  // Worker time used by the tenant divided by its weight.
+  double GetVirtualTime(int tenant_id) const;
+
+ private:
+  struct Tenant {
+    double virtual_time = 0;
+    // Worker time left in the token bucket
+    double tokens = 0;
+    int64_t last_refill_time = 0;
+    int num_running_jobs = 0;
+    bool is_backlogged = false;
+  };
+
+  const FairShareConfig& GetConfig(int tenant_id) const;
+  void Refill(int tenant_id, int64_t current_time);
+  bool IsThrottled(int tenant_id) const;
+  void Charge(int tenant_id, int64_t worker_time_us);
+
+  const std::map<int, FairShareConfig> fair_share_configs_;
+  const FairShareConfig default_config_;
+
+  mutable std::mutex mtx_;
+  std::map<int, Tenant> tenants_;
+  // Expected worker time charged on dispatch, replaced by the measured time
+  // once the job finishes. (tenant id, expected worker time)
+  std::map<JobId, std::pair<int, int64_t>> running_jobs_;
+  int64_t retry_timeout_us_ = -1;
+};
+
+}  // namespace band
+
+#endif  // BAND_SCHEDULER_FAIR_SHARE_SCHEDULER_H_
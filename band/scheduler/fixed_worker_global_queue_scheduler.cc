@@ -12,59 +12,51 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include "band/logger.h"
 #include "band/scheduler/fixed_worker_scheduler.h"
-#include "band/time.h"
 
 namespace band {
 
 bool FixedWorkerGlobalQueueScheduler::Schedule(JobQueue& requests) {
   bool success = true;
   // TODO: fallback subgraphs for FixedDeviceFixedWorkerPlanner?
+  engine_.UpdateWorkersWaiting();
   std::set<int> idle_workers = engine_.GetIdleWorkers();
   if (idle_workers.empty()) {
     // no device is idle; wait for next iteration
     return success;
   }
-  BAND_NOT_IMPLEMENTED
-  return success;
-  // for (auto it = engine_.requests_.begin(); it !=
-  // engine_.requests_.end();)
-  // {
-  //   Job &to_execute = *it;
-  //   int model_id = subgraph_key.GetModelId();
-
-  //   int worker_id;
-  //   if (worker_id >= 0 && GetModelExecutor()->GetNumWorkers()) {
-  //     worker_id = to_execute.worker_id;
-  //   } else {
-  //     worker_id = planner_->GetModelWorkerMap()[model_id];
-  //   }
-
-  //   auto idle_workers_it = idle_workers.find(worker_id);
-  //   if (idle_workers_it == idle_workers.end()) {
-  //     // that device is not idle, so leave this job alone for now
-  //     ++it;
-  //     continue;
-  //   }
-
-  //   int subgraph_idx = engine_.GetSubgraphIdx(model_id, worker_id);
-  //   Subgraph *subgraph = GetModelExecutor()->subgraph(subgraph_idx);
-  //   to_execute.expected_latency =
-  //       GetWorkerWaitingTime()[worker_id] +
-  //       GetModelExecutor()->GetExpectedLatency(subgraph_idx);
-  //   EnqueueAction(to_execute, subgraph);
 
-  //   // delete this job from our request queue and
-  //   // delete this device from our idle_workers set
-  //   it = engine_.requests_.erase(it);
-  //   idle_workers.erase(idle_workers_it);
-
-  //   if (idle_workers.empty()) {
-  //     // no device is idle; wait for next iteration
-  //     break;
-  //   }
-  // }
+  for (auto it = requests.begin(); it != requests.end();) {
+    Job to_execute = *it;
+    int model_id = to_execute.model_id;
+    // Same priority as FixedWorkerScheduler
+    WorkerId worker_id = to_execute.target_worker_id == -1
+                             ? engine_.GetModelWorker(model_id)
+                             : to_execute.target_worker_id;
+
+    auto idle_workers_it = idle_workers.find(worker_id);
+    if (idle_workers_it == idle_workers.end()) {
+      // that device is not idle, so leave this job alone for now, without
+      // blocking the jobs of other devices behind it
+      ++it;
+      continue;
+    }
+
+    SubgraphKey key = engine_.GetLargestSubgraphKey(model_id, worker_id);
+    to_execute.expected_latency = engine_.GetExpected(key);
+    success &= engine_.EnqueueToWorker({to_execute, key});
+
+    // delete this job from our request queue and
+    // delete this device from our idle_workers set
+    it = requests.erase(it);
+    idle_workers.erase(idle_workers_it);
+
+    if (idle_workers.empty()) {
+      // no device is idle; wait for next iteration
+      break;
+    }
+  }
+  return success;
 }
 
 }  // namespace band
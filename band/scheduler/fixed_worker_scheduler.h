@@ -31,6 +31,8 @@ class FixedWorkerScheduler : public IScheduler {
   WorkerType GetWorkerType() override { return WorkerType::kDeviceQueue; }
 };
 
+// Same assignment as FixedWorkerScheduler, but keeps each job in the global
+// queue until its worker is idle.
 class FixedWorkerGlobalQueueScheduler : public IScheduler {
  public:
   using IScheduler::IScheduler;
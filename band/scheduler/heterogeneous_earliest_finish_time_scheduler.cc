@@ -14,6 +14,8 @@
 
 #include "band/scheduler/heterogeneous_earliest_finish_time_scheduler.h"
 
+#include <limits>
+#include <queue>
 #include <unordered_set>
 
 #include "band/logger.h"
@@ -35,80 +37,108 @@ bool HEFTScheduler::Schedule(JobQueue& requests) {
 
     // hold on to a local copy of worker waiting time
     WorkerWaitingTime waiting_time = engine_.GetWorkerWaitingTime();
-    std::set<JobId> jobs_to_yield;
-    // basically the same as ShortestExpectedLatencyScheduler
-    int64_t largest_shortest_latency;
-    int64_t target_job_index;
-    SubgraphKey target_subgraph_key;
-    SubgraphKey target_subgraph_key_next;
-    do {
-      largest_shortest_latency = -1;
-      target_job_index = -1;
-
-      // only check up to `window_size` requests
-      std::unordered_set<std::pair<int, BitMask>, JobIdBitMaskHash>
-          searched_jobs;
-      for (auto it = requests.begin(); it != requests.begin() + window_size;
-           ++it) {
-        Job job = *it;
-
-        if (jobs_to_yield.find(job.job_id) != jobs_to_yield.end()) {
-          continue;
-        }
 
-        std::pair<int, BitMask> job_to_search =
-            std::make_pair(job.model_id, job.resolved_unit_subgraphs);
-        if (searched_jobs.find(job_to_search) != searched_jobs.end()) {
-          continue;
-        } else {
-          searched_jobs.insert(job_to_search);
-        }
+    // total expected time of the reserved subgraphs per worker, from which
+    // each job takes out its own reservation
+    WorkerWaitingTime reserved_total;
+    std::map<JobId, int64_t> reserved_expected;
+    for (auto job_subgraph_key : reserved_) {
+      const int64_t expected = engine_.GetExpected(job_subgraph_key.second);
+      reserved_total[job_subgraph_key.second.GetWorkerId()] += expected;
+      reserved_expected[job_subgraph_key.first] = expected;
+    }
+
+    // basically the same as ShortestExpectedLatencyScheduler, but only
+    // the first job of each (model, resolved unit subgraphs) in the window
+    // that is not yielded is a candidate
+    std::vector<Candidate> candidates(window_size);
+    std::vector<bool> yielded(window_size, false);
+    // (latency - delay at evaluation, -job index), the largest first
+    std::priority_queue<std::pair<int64_t, int>> heap;
+    std::unordered_set<std::pair<int, BitMask>, JobIdBitMaskHash>
+        searched_jobs;
+    for (int i = 0; i < window_size; i++) {
+      if (searched_jobs
+              .insert({requests[i].model_id,
+                       requests[i].resolved_unit_subgraphs})
+              .second) {
+        heap.push({std::numeric_limits<int64_t>::max(), -i});
+      }
+    }
 
+    // A yielded job delays its worker, which delays any plan by at most that
+    // much. So a stale latency plus the delays since its evaluation bounds
+    // the current one, and a job is re-evaluated only if it may be the
+    // largest.
+    int64_t delay = 0;
+    int target_job_index = -1;
+    while (!heap.empty()) {
+      const int index = -heap.top().second;
+      heap.pop();
+      Candidate& candidate = candidates[index];
+      const Job& job = requests[index];
+
+      if (candidate.delay != delay) {
         // update waiting_time for all future jobs in reserved_
         WorkerWaitingTime reserved_time(waiting_time);
-        for (auto job_subgraph_key : reserved_) {
-          if (job_subgraph_key.first == job.job_id) {
-            continue;
-          }
-
-          reserved_time[job_subgraph_key.second.GetWorkerId()] +=
-              engine_.GetExpected(job_subgraph_key.second);
+        for (auto& worker_reserved : reserved_total) {
+          reserved_time[worker_reserved.first] += worker_reserved.second;
+        }
+        auto reserved_it = reserved_.find(job.job_id);
+        if (reserved_it != reserved_.end()) {
+          reserved_time[reserved_it->second.GetWorkerId()] -=
+              reserved_expected[job.job_id];
         }
 
         std::pair<std::vector<SubgraphKey>, int64_t> best_subgraph =
             engine_.GetSubgraphWithShortestLatency(job, reserved_time);
-
-        if (largest_shortest_latency < best_subgraph.second) {
-          largest_shortest_latency = best_subgraph.second;
-          target_subgraph_key = best_subgraph.first.front();
-          target_job_index = it - requests.begin();
-          if (best_subgraph.first.size() > 1) {
-            target_subgraph_key_next = best_subgraph.first[1];
-          } else {
-            target_subgraph_key_next = {};
-          }
+        candidate.latency = best_subgraph.second;
+        candidate.delay = delay;
+        if (!best_subgraph.first.empty()) {
+          candidate.subgraph_key = best_subgraph.first.front();
         }
+        if (best_subgraph.first.size() > 1) {
+          candidate.subgraph_key_next = best_subgraph.first[1];
+        } else {
+          candidate.subgraph_key_next = {};
+        }
+        heap.push({candidate.latency - delay, -index});
+        continue;
       }
 
-      if (target_job_index < 0) {
+      if (candidate.latency <= -1) {
         // no one wants to be scheduled..
-        return success;
+        break;
       }
 
       // skip this job if we can't schedule it immediately,
       // even if this job is the "most urgent" one
-      const int worker_id = target_subgraph_key.GetWorkerId();
+      const int worker_id = candidate.subgraph_key.GetWorkerId();
       if (idle_workers.find(worker_id) == idle_workers.end()) {
-        waiting_time[worker_id] += engine_.GetExpected(target_subgraph_key);
-        auto requests_it = requests.begin() + target_job_index;
-        Job job = *requests_it;
-        jobs_to_yield.insert(job.job_id);
+        const int64_t expected = engine_.GetExpected(candidate.subgraph_key);
+        waiting_time[worker_id] += expected;
+        delay += expected;
+        yielded[index] = true;
+        // the next job of the same kind takes its place
+        for (int i = index + 1; i < window_size; i++) {
+          if (!yielded[i] && requests[i].model_id == job.model_id &&
+              requests[i].resolved_unit_subgraphs ==
+                  job.resolved_unit_subgraphs) {
+            heap.push({std::numeric_limits<int64_t>::max(), -i});
+            break;
+          }
+        }
         continue;
-      } else {
-        break;
       }
-    } while (true);
+      target_job_index = index;
+      break;
+    }
+
+    if (target_job_index < 0) {
+      return success;
+    }
 
+    const Candidate target = candidates[target_job_index];
     auto requests_it = requests.begin() + target_job_index;
     Job job = *requests_it;
 
@@ -118,17 +148,17 @@ bool HEFTScheduler::Schedule(JobQueue& requests) {
 
     // Update Job status specific to this planner.
     // Common status will be updated by `EnqueueAction`.
-    if (engine_.IsBegin(target_subgraph_key)) {
+    if (engine_.IsBegin(target.subgraph_key)) {
       // only set these fields if this is the first subgraph of this model
-      job.expected_latency = largest_shortest_latency;
+      job.expected_latency = target.latency;
     }
 
-    success &= engine_.EnqueueToWorker({job, target_subgraph_key});
+    success &= engine_.EnqueueToWorker({job, target.subgraph_key});
 
     if (reserve_) {
       // add next job to reserved_, if one exists
-      if (target_subgraph_key_next != SubgraphKey()) {
-        reserved_[job.job_id] = target_subgraph_key_next;
+      if (target.subgraph_key_next != SubgraphKey()) {
+        reserved_[job.job_id] = target.subgraph_key_next;
       } else {
         reserved_.erase(job.job_id);
       }
@@ -136,4 +166,4 @@ bool HEFTScheduler::Schedule(JobQueue& requests) {
   }
   return success;
 }
-}  // namespace band
\ No newline at end of file
+}  // namespace band
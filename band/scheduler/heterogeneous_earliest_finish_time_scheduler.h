@@ -30,6 +30,15 @@ class HEFTScheduler : public IScheduler {
   WorkerType GetWorkerType() override { return WorkerType::kGlobalQueue; }
 
  private:
+  // Best plan of a job in the window
+  struct Candidate {
+    int64_t latency = -1;
+    // Total delay of the yielded jobs at the evaluation, -1 if not evaluated
+    int64_t delay = -1;
+    SubgraphKey subgraph_key;
+    SubgraphKey subgraph_key_next;
+  };
+
   // job_id --> subgraph_key
   std::map<int, SubgraphKey> reserved_;
   const int window_size_;
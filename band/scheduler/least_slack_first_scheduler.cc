@@ -15,6 +15,8 @@
 #include "band/scheduler/least_slack_first_scheduler.h"
 
 #include <algorithm>
+#include <functional>
+#include <limits>
 
 #include "band/time.h"
 
@@ -25,6 +27,7 @@ LeastSlackFirstScheduler::LeastSlackFirstScheduler(IEngine& engine,
 
 bool LeastSlackFirstScheduler::Schedule(JobQueue& requests) {
   bool success = true;
+  DropReleasedModels();
   engine_.UpdateWorkersWaiting();
   int window_size = std::min(window_size_, (int)requests.size());
   if (window_size <= 0) {
@@ -37,26 +40,37 @@ bool LeastSlackFirstScheduler::Schedule(JobQueue& requests) {
   }
 
   WorkerWaitingTime waiting_time = engine_.GetWorkerWaitingTime();
+  UpdateWorkerVersions(waiting_time);
 
   int64_t current_time = time::NowMicros();
-  SortBySlackTime(requests, window_size, current_time);
+  UpdateExpectedLatency(requests, window_size, waiting_time);
 
-  std::set<int> job_indices_to_erase;
-  for (auto it = requests.begin(); it != requests.begin() + window_size; ++it) {
-    Job job = *it;
+  // (slack time, job index), the least slack first
+  std::vector<std::pair<int64_t, int>> slack_heap;
+  slack_heap.reserve(window_size);
+  for (int i = 0; i < window_size; i++) {
+    slack_heap.push_back({GetSlackTime(current_time, requests[i]), i});
+  }
+  std::make_heap(slack_heap.begin(), slack_heap.end(), std::greater<>());
+
+  std::vector<bool> is_dispatched(window_size, false);
+  while (!slack_heap.empty()) {
+    std::pop_heap(slack_heap.begin(), slack_heap.end(), std::greater<>());
+    const int index = slack_heap.back().second;
+    slack_heap.pop_back();
+    Job job = requests[index];
 
     // Get current job's fastest subgraph execution plan + latency
-    std::pair<std::vector<SubgraphKey>, int> best_exec_plan =
-        engine_.GetSubgraphWithShortestLatency(job, waiting_time);
+    const ExecutionPlan& best_exec_plan = GetExecutionPlan(job, waiting_time);
     // Get first executable subgraph plan
-    SubgraphKey target_subgraph_key = best_exec_plan.first.front();
+    SubgraphKey target_subgraph_key = best_exec_plan.subgraph_key;
 
     // Change job status and schedule if the execution plan already exceeded SLO
     if (job.slo_us > 0 &&
-        current_time + best_exec_plan.second > job.enqueue_time + job.slo_us) {
+        current_time + best_exec_plan.latency > job.enqueue_time + job.slo_us) {
       job.status = JobStatus::kSLOViolation;
       success &= engine_.EnqueueToWorker({job, target_subgraph_key});
-      job_indices_to_erase.insert(it - requests.begin());
+      is_dispatched[index] = true;
       continue;
     }
 
@@ -65,20 +79,31 @@ bool LeastSlackFirstScheduler::Schedule(JobQueue& requests) {
     if (idle_workers.find(worker_id) != idle_workers.end()) {
       // Update worker's waiting time as if it will execute the job
       waiting_time[worker_id] += engine_.GetExpected(target_subgraph_key);
+      worker_versions_[worker_id]++;
       success &= engine_.EnqueueToWorker({job, target_subgraph_key});
-      job_indices_to_erase.insert(it - requests.begin());
+      is_dispatched[index] = true;
       continue;
     }
   }
 
-  for (auto it = job_indices_to_erase.rbegin();
-       it != job_indices_to_erase.rend(); ++it) {
-    requests.erase(requests.begin() + *it);
+  // Remove the dispatched jobs at once
+  int num_remaining = 0;
+  for (int i = 0; i < window_size; i++) {
+    if (!is_dispatched[i]) {
+      requests[num_remaining++] = std::move(requests[i]);
+    }
   }
+  requests.erase(requests.begin() + num_remaining,
+                 requests.begin() + window_size);
 
   return success;
 }
 
+void LeastSlackFirstScheduler::OnModelReleased(ModelId model_id) {
+  std::lock_guard<std::mutex> lock(released_models_mtx_);
+  released_models_.push_back(model_id);
+}
+
 int64_t LeastSlackFirstScheduler::GetSlackTime(int64_t current_time,
                                                const Job& job) {
   if (job.slo_us > 0) {
@@ -90,25 +115,87 @@ int64_t LeastSlackFirstScheduler::GetSlackTime(int64_t current_time,
   }
 }
 
-void LeastSlackFirstScheduler::SortBySlackTime(JobQueue& requests,
-                                               int window_size,
-                                               int64_t current_time) {
-  UpdateExpectedLatency(requests, window_size);
-  std::sort(requests.begin(), requests.begin() + window_size,
-            [&](const Job& first, const Job& second) -> bool {
-              return GetSlackTime(current_time, first) <
-                     GetSlackTime(current_time, second);
-            });
+void LeastSlackFirstScheduler::UpdateWorkerVersions(
+    const WorkerWaitingTime& waiting_time) {
+  for (auto& worker_waiting : waiting_time) {
+    auto last_it = last_waiting_time_.find(worker_waiting.first);
+    if (last_it == last_waiting_time_.end() ||
+        (last_it->second == 0) != (worker_waiting.second == 0) ||
+        last_it->second < worker_waiting.second) {
+      worker_versions_[worker_waiting.first]++;
+    }
+  }
+  last_waiting_time_ = waiting_time;
 }
 
-void LeastSlackFirstScheduler::UpdateExpectedLatency(JobQueue& requests,
-                                                     int window_size) {
+uint64_t LeastSlackFirstScheduler::GetWorkerVersion(ModelId model_id) {
+  auto model_it = model_workers_.find(model_id);
+  if (model_it == model_workers_.end()) {
+    std::set<WorkerId> workers;
+    engine_.ForEachSubgraph([&](const SubgraphKey& key) {
+      if (key.GetModelId() == model_id) {
+        workers.insert(key.GetWorkerId());
+      }
+    });
+    model_it = model_workers_.emplace(model_id, std::move(workers)).first;
+  }
+
+  // Depend on every worker if the subgraphs are unknown
+  uint64_t version = 0;
+  for (auto& worker_version : worker_versions_) {
+    if (model_it->second.empty() ||
+        model_it->second.count(worker_version.first)) {
+      version += worker_version.second;
+    }
+  }
+  return version;
+}
+
+const LeastSlackFirstScheduler::ExecutionPlan&
+LeastSlackFirstScheduler::GetExecutionPlan(
+    const Job& job, const WorkerWaitingTime& waiting_time) {
+  const uint64_t worker_version = GetWorkerVersion(job.model_id);
+  const uint64_t latency_epoch = engine_.GetLatencyEpoch();
+  ExecutionPlan& plan =
+      execution_plans_[{job.model_id, job.resolved_unit_subgraphs}];
+  if (plan.worker_version != worker_version ||
+      plan.latency_epoch != latency_epoch || plan.latency < 0) {
+    std::pair<std::vector<SubgraphKey>, int64_t> best_exec_plan =
+        engine_.GetSubgraphWithShortestLatency(job, waiting_time);
+    plan.subgraph_key = best_exec_plan.first.empty()
+                            ? SubgraphKey()
+                            : best_exec_plan.first.front();
+    plan.latency = best_exec_plan.second;
+    plan.worker_version = worker_version;
+    plan.latency_epoch = latency_epoch;
+  }
+  return plan;
+}
+
+void LeastSlackFirstScheduler::UpdateExpectedLatency(
+    JobQueue& requests, int window_size,
+    const WorkerWaitingTime& waiting_time) {
+  // Plans of the jobs that left the window are dropped
+  if (execution_plans_.size() > 2 * static_cast<size_t>(window_size)) {
+    execution_plans_.clear();
+  }
   for (auto it = requests.begin(); it != requests.begin() + window_size; ++it) {
-    it->expected_latency = engine_
-                               .GetSubgraphWithShortestLatency(
-                                   *it, engine_.GetWorkerWaitingTime())
-                               .second;
+    it->expected_latency = GetExecutionPlan(*it, waiting_time).latency;
+  }
+}
+
+void LeastSlackFirstScheduler::DropReleasedModels() {
+  std::vector<ModelId> released_models;
+  {
+    std::lock_guard<std::mutex> lock(released_models_mtx_);
+    released_models.swap(released_models_);
+  }
+  for (ModelId model_id : released_models) {
+    model_workers_.erase(model_id);
+    for (auto it = execution_plans_.begin(); it != execution_plans_.end();) {
+      (it->first.first == model_id) ? execution_plans_.erase(it++) : (++it);
+    }
   }
 }
 
-}  // namespace band
\ No newline at end of file
+}  // namespace band
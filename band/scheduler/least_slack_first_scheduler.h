@@ -17,6 +17,10 @@
 #ifndef BAND_SCHEDULER_LEAST_SLACK_FIRST_SCHEDULER_H_
 #define BAND_SCHEDULER_LEAST_SLACK_FIRST_SCHEDULER_H_
 
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 #include "band/scheduler/scheduler.h"
 
 namespace band {
@@ -28,13 +32,45 @@ class LeastSlackFirstScheduler : public IScheduler {
   bool Schedule(JobQueue& requests) override;
   bool NeedFallbackSubgraphs() override { return true; }
   WorkerType GetWorkerType() override { return WorkerType::kGlobalQueue; }
+  void OnModelReleased(ModelId model_id) override;
 
  private:
+  // Shortest latency plan of a (model, resolved unit subgraphs), valid while
+  // the workers of the model keep their state and the expected latencies do
+  // not drift
+  struct ExecutionPlan {
+    SubgraphKey subgraph_key;
+    // -1 if not searched yet
+    int64_t latency = -1;
+    uint64_t worker_version = 0;
+    uint64_t latency_epoch = 0;
+  };
+
   int64_t GetSlackTime(int64_t current_time, const Job& job);
-  void SortBySlackTime(JobQueue& requests, int window_size,
-                       int64_t current_time);
-  void UpdateExpectedLatency(JobQueue& requests, int window_size);
+  // A worker changes its state when it becomes idle or busy, or takes more
+  // work. Aging of the current work alone is not a change.
+  void UpdateWorkerVersions(const WorkerWaitingTime& waiting_time);
+  // Sum of the versions of the workers the model may run on
+  uint64_t GetWorkerVersion(ModelId model_id);
+  // Returns the cached plan of the job, or searches it again if the workers
+  // of the model changed since.
+  const ExecutionPlan& GetExecutionPlan(const Job& job,
+                                        const WorkerWaitingTime& waiting_time);
+  void UpdateExpectedLatency(JobQueue& requests, int window_size,
+                             const WorkerWaitingTime& waiting_time);
+  // Drops the state of the models released since the last call
+  void DropReleasedModels();
+
   const int window_size_;
+  WorkerWaitingTime last_waiting_time_;
+  std::map<WorkerId, uint64_t> worker_versions_;
+  std::map<ModelId, std::set<WorkerId>> model_workers_;
+  std::unordered_map<std::pair<ModelId, BitMask>, ExecutionPlan,
+                     JobIdBitMaskHash>
+      execution_plans_;
+
+  std::mutex released_models_mtx_;
+  std::vector<ModelId> released_models_;
 };
 
 }  // namespace band
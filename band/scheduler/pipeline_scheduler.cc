@@ -0,0 +1,172 @@
+// Copyright 2023 Seoul National University
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "band/scheduler/pipeline_scheduler.h"
+
+namespace band {
+
+PipelineScheduler::PipelineScheduler(IEngine& engine, int depth)
+    : IScheduler(engine), depth_(depth) {}
+
+bool PipelineScheduler::Schedule(JobQueue& requests) {
+  bool success = true;
+  std::vector<ScheduleAction> actions;
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    // A queued job is not in flight, e.g., re-enqueued after a device error
+    // or by a worker that was not ready
+    for (const Job& job : requests) {
+      ReleaseStage(job);
+    }
+    for (auto it = requests.begin(); it != requests.end();) {
+      const Job& job = *it;
+      const std::vector<SubgraphKey>& stages =
+          GetOrCreateStages(job.model_id);
+      const int stage = GetStageIndex(stages, job.resolved_unit_subgraphs);
+
+      SubgraphKey target_subgraph_key;
+      if (stage == -1) {
+        // Not on the pipeline, e.g., started by another scheduler
+        std::pair<std::vector<SubgraphKey>, int64_t> best_exec_plan =
+            engine_.GetSubgraphWithShortestLatency(
+                job, engine_.GetWorkerWaitingTime());
+        if (best_exec_plan.first.empty()) {
+          ++it;
+          continue;
+        }
+        target_subgraph_key = best_exec_plan.first.front();
+      } else {
+        int& num_in_flight = num_in_flight_[job.model_id][stage];
+        if (num_in_flight >= depth_) {
+          // Wait for the stage to drain
+          ++it;
+          continue;
+        }
+        num_in_flight++;
+        job_stages_[{job.job_id, job.branch_unit_subgraphs.to_ullong()}] = {
+            job.model_id, stage};
+        target_subgraph_key = stages[stage];
+      }
+
+      actions.push_back({job, target_subgraph_key});
+      it = requests.erase(it);
+    }
+  }
+
+  // Enqueue without the lock, a failed job reports back synchronously
+  for (const ScheduleAction& action : actions) {
+    success &= engine_.EnqueueToWorker(action);
+  }
+  return success;
+}
+
+void PipelineScheduler::OnJobFinished(const Job& job, int64_t worker_time_us) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  ReleaseStage(job);
+}
+
+void PipelineScheduler::OnModelReleased(ModelId model_id) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  DropStages(model_id);
+}
+
+std::vector<SubgraphKey> PipelineScheduler::GetStages(ModelId model_id) const {
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto it = stages_.find(model_id);
+  return it != stages_.end() ? it->second : std::vector<SubgraphKey>();
+}
+
+const std::vector<SubgraphKey>& PipelineScheduler::GetOrCreateStages(
+    ModelId model_id) {
+  const uint64_t latency_epoch = engine_.GetLatencyEpoch();
+  auto it = stages_.find(model_id);
+  if (it != stages_.end()) {
+    if (stage_epochs_[model_id] == latency_epoch) {
+      return it->second;
+    }
+    // Jobs in flight on the previous stages drain without holding the new
+    // ones
+    DropStages(model_id);
+  }
+
+  // Pin the fastest plan without any load, one stage per subgraph
+  WorkerWaitingTime idle_waiting_time = engine_.GetWorkerWaitingTime();
+  for (auto& worker_waiting : idle_waiting_time) {
+    worker_waiting.second = 0;
+  }
+  std::vector<SubgraphKey> stages;
+  Job job(model_id);
+  while (true) {
+    std::pair<std::vector<SubgraphKey>, int64_t> best_exec_plan =
+        engine_.GetSubgraphWithShortestLatency(job, idle_waiting_time);
+    if (best_exec_plan.first.empty()) {
+      stages.clear();
+      break;
+    }
+    const SubgraphKey& key = best_exec_plan.first.front();
+    if (!key.IsValid() ||
+        (key.GetUnitIndices() & job.resolved_unit_subgraphs).any()) {
+      stages.clear();
+      break;
+    }
+    stages.push_back(key);
+    if (engine_.IsEnd(key) || key.GetUnitIndices().none()) {
+      break;
+    }
+    job.resolved_unit_subgraphs |= key.GetUnitIndices();
+  }
+
+  num_in_flight_[model_id] = std::vector<int>(stages.size(), 0);
+  stage_epochs_[model_id] = latency_epoch;
+  return stages_[model_id] = stages;
+}
+
+void PipelineScheduler::DropStages(ModelId model_id) {
+  stages_.erase(model_id);
+  stage_epochs_.erase(model_id);
+  num_in_flight_.erase(model_id);
+  for (auto it = job_stages_.begin(); it != job_stages_.end();) {
+    (it->second.first == model_id) ? job_stages_.erase(it++) : (++it);
+  }
+}
+
+void PipelineScheduler::ReleaseStage(const Job& job) {
+  auto it =
+      job_stages_.find({job.job_id, job.branch_unit_subgraphs.to_ullong()});
+  if (it == job_stages_.end()) {
+    return;
+  }
+  int& num_in_flight = num_in_flight_[it->second.first][it->second.second];
+  if (num_in_flight > 0) {
+    num_in_flight--;
+  }
+  job_stages_.erase(it);
+}
+
+int PipelineScheduler::GetStageIndex(const std::vector<SubgraphKey>& stages,
+                                     const BitMask& resolved_unit_subgraphs) {
+  for (size_t i = 0; i < stages.size(); i++) {
+    const BitMask& unit_indices = stages[i].GetUnitIndices();
+    if ((unit_indices & resolved_unit_subgraphs).none()) {
+      // The next stage, unless the job went off the pipeline
+      return (unit_indices.any() || resolved_unit_subgraphs.none()) ? i : -1;
+    }
+    if ((unit_indices & ~resolved_unit_subgraphs).any()) {
+      return -1;
+    }
+  }
+  return -1;
+}
+
+}  // namespace band
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2023 Seoul National University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef BAND_SCHEDULER_PIPELINE_SCHEDULER_H_
+#define BAND_SCHEDULER_PIPELINE_SCHEDULER_H_
+
+#include <map>
+#include <mutex>
+#include <utility>
+
+#include "band/scheduler/scheduler.h"
+
+namespace band {
+
+// Runs the subgraphs of a model as the stages of a pipeline. Each stage is
+// pinned to the worker of the fastest plan on idle workers, so that a stage
+// of a request overlaps with the other stages of the requests before and
+// after it. At most `depth` requests are in flight per stage. Stages are
+// pinned again once the expected latencies drift.
+class PipelineScheduler : public IScheduler {
+ public:
+  explicit PipelineScheduler(IEngine& engine, int depth);
+
+  bool Schedule(JobQueue& requests) override;
+  bool NeedFallbackSubgraphs() override { return true; }
+  WorkerType GetWorkerType() override { return WorkerType::kDeviceQueue; }
+  void OnJobFinished(const Job& job, int64_t worker_time_us) override;
+  void OnModelReleased(ModelId model_id) override;
+
+  // Subgraph per stage of the model, empty until its first request
+  std::vector<SubgraphKey> GetStages(ModelId model_id) const;
+
+ private:
+  const std::vector<SubgraphKey>& GetOrCreateStages(ModelId model_id);
+  static int GetStageIndex(const std::vector<SubgraphKey>& stages,
+                           const BitMask& resolved_unit_subgraphs);
+  // Forgets the stages of the model and the jobs in flight on them
+  void DropStages(ModelId model_id);
+  // Frees the stage held by the job, if any. Jobs are tracked by their id
+  // and branch rather than the subgraph key, which changes when a job is
+  // stolen by another worker.
+  void ReleaseStage(const Job& job);
+
+  const int depth_;
+  mutable std::mutex mtx_;
+  std::map<ModelId, std::vector<SubgraphKey>> stages_;
+  // Latency epoch of the engine when the stages were pinned
+  std::map<ModelId, uint64_t> stage_epochs_;
+  std::map<ModelId, std::vector<int>> num_in_flight_;
+  // Stage held by each dispatched job, per job id and branch
+  std::map<std::pair<JobId, uint64_t>, std::pair<ModelId, int>> job_stages_;
+};
+
+}  // namespace band
+
+#endif  // BAND_SCHEDULER_PIPELINE_SCHEDULER_H_
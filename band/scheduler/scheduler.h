@@ -36,6 +36,14 @@ class IScheduler {
   virtual bool Schedule(JobQueue& requests) = 0;
   virtual bool NeedFallbackSubgraphs() = 0;
   virtual WorkerType GetWorkerType() = 0;
+  // Reports the end of a (sub)graph of a job with the worker time spent on
+  // it, which is 0 if it did not run. Called from any thread.
+  virtual void OnJobFinished(const Job& job, int64_t worker_time_us) {}
+  // Reports that the model is unregistered. Called from any thread.
+  virtual void OnModelReleased(ModelId model_id) {}
+  // Time until the scheduler can dispatch the remaining requests without
+  // waiting for a new or finished request, or -1.
+  virtual int64_t GetRetryTimeout() const { return -1; }
 
  protected:
   IEngine& engine_;
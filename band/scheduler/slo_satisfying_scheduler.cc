@@ -0,0 +1,101 @@
+// Copyright 2023 Seoul National University
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "band/scheduler/slo_satisfying_scheduler.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+#include "band/time.h"
+
+namespace band {
+
+SLOSatisfyingScheduler::SLOSatisfyingScheduler(IEngine& engine,
+                                               int window_size)
+    : IScheduler(engine), window_size_(window_size) {}
+
+bool SLOSatisfyingScheduler::Schedule(JobQueue& requests) {
+  bool success = true;
+  engine_.UpdateWorkersWaiting();
+  const int window_size = std::min(window_size_, (int)requests.size());
+  if (window_size <= 0) {
+    return success;
+  }
+
+  std::set<WorkerId> idle_workers = engine_.GetIdleWorkers();
+  if (idle_workers.empty()) {
+    return success;
+  }
+
+  WorkerWaitingTime waiting_time = engine_.GetWorkerWaitingTime();
+  const int64_t current_time = time::NowMicros();
+
+  // Jobs with an earlier deadline choose their worker first
+  std::vector<int> job_indices(window_size);
+  std::iota(job_indices.begin(), job_indices.end(), 0);
+  std::stable_sort(job_indices.begin(), job_indices.end(),
+                   [&requests](int lhs, int rhs) {
+                     return GetDeadline(requests[lhs]) <
+                            GetDeadline(requests[rhs]);
+                   });
+
+  std::set<int> job_indices_to_erase;
+  for (int job_index : job_indices) {
+    if (idle_workers.empty()) {
+      break;
+    }
+    Job job = requests[job_index];
+
+    SubgraphKey target_subgraph_key =
+        engine_.GetSubgraphIdxSatisfyingSLO(job, waiting_time, idle_workers);
+    if (!target_subgraph_key.IsValid()) {
+      // No SLO, or no idle worker meets it in time
+      std::pair<std::vector<SubgraphKey>, int64_t> best_exec_plan =
+          engine_.GetSubgraphWithShortestLatency(job, waiting_time);
+      if (best_exec_plan.first.empty()) {
+        continue;
+      }
+      target_subgraph_key = best_exec_plan.first.front();
+
+      if (current_time + best_exec_plan.second > GetDeadline(job)) {
+        job.status = JobStatus::kSLOViolation;
+        success &= engine_.EnqueueToWorker({job, target_subgraph_key});
+        job_indices_to_erase.insert(job_index);
+        continue;
+      }
+    }
+
+    const WorkerId worker_id = target_subgraph_key.GetWorkerId();
+    if (idle_workers.find(worker_id) != idle_workers.end()) {
+      waiting_time[worker_id] += engine_.GetExpected(target_subgraph_key);
+      idle_workers.erase(worker_id);
+      success &= engine_.EnqueueToWorker({job, target_subgraph_key});
+      job_indices_to_erase.insert(job_index);
+    }
+  }
+
+  for (auto it = job_indices_to_erase.rbegin();
+       it != job_indices_to_erase.rend(); ++it) {
+    requests.erase(requests.begin() + *it);
+  }
+  return success;
+}
+
+int64_t SLOSatisfyingScheduler::GetDeadline(const Job& job) {
+  return job.slo_us > 0 ? job.enqueue_time + job.slo_us
+                        : std::numeric_limits<int64_t>::max();
+}
+
+}  // namespace band
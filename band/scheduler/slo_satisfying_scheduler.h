@@ -0,0 +1,45 @@
+/*
+ * Copyright 2023 Seoul National University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef BAND_SCHEDULER_SLO_SATISFYING_SCHEDULER_H_
+#define BAND_SCHEDULER_SLO_SATISFYING_SCHEDULER_H_
+
+#include "band/scheduler/scheduler.h"
+
+namespace band {
+
+// Instead of the fastest plan, takes the slowest plan that still meets the
+// SLO of a job, so that fast workers are left to the jobs with a tight SLO.
+// Jobs are visited in the order of deadline, and fall back to the fastest
+// plan when no plan on the idle workers meets the SLO.
+class SLOSatisfyingScheduler : public IScheduler {
+ public:
+  explicit SLOSatisfyingScheduler(IEngine& engine, int window_size);
+
+  bool Schedule(JobQueue& requests) override;
+  bool NeedFallbackSubgraphs() override { return true; }
+  WorkerType GetWorkerType() override { return WorkerType::kGlobalQueue; }
+
+ private:
+  static int64_t GetDeadline(const Job& job);
+
+  const int window_size_;
+};
+
+}  // namespace band
+
+#endif  // BAND_SCHEDULER_SLO_SATISFYING_SCHEDULER_H_
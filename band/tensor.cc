@@ -16,6 +16,8 @@
 
 #include <string.h>
 
+#include <new>
+
 #include "band/logger.h"
 
 namespace band {
@@ -24,7 +26,8 @@ Tensor::Tensor(ITensor* tensor_view, bool copy_data)
       quantization_({QuantizationType::kNoQuantization, nullptr}),
       dims_(tensor_view->GetDims(),
             tensor_view->GetDims() + tensor_view->GetNumDims()),
-      data_(new char[tensor_view->GetBytes()]),
+      data_(new(std::align_val_t(kDataAlignment))
+                char[tensor_view->GetBytes()]),
       name_(tensor_view->GetName()) {
   auto status = SetQuantization(tensor_view->GetQuantization());
   if (!status.ok()) {
@@ -37,7 +40,7 @@ Tensor::Tensor(ITensor* tensor_view, bool copy_data)
 }
 
 Tensor::~Tensor() {
-  delete[] data_;
+  operator delete[](data_, std::align_val_t(kDataAlignment));
   if (quantization_.GetParams() != nullptr) {
     free(quantization_.GetParams());
   }
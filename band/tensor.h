@@ -42,6 +42,10 @@ class Tensor : public interface::ITensor {
   Quantization GetQuantization() const override;
   absl::Status SetQuantization(Quantization quantization) override;
 
+  // Data is aligned so that backends can bind it without copy
+  // (see `RequestOption::zero_copy_input`).
+  static constexpr size_t kDataAlignment = 64;
+
  private:
   DataType type_;
   Quantization quantization_;
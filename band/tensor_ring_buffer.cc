@@ -16,6 +16,7 @@
 
 #include <cassert>
 #include <cstring>  // memcpy
+#include <limits>
 #include <mutex>
 
 #include "absl/strings/str_format.h"
@@ -26,38 +27,95 @@
 namespace band {
 TensorRingBuffer::TensorRingBuffer(
     std::vector<std::shared_ptr<interface::ITensor>> tensors,
-    std::vector<int> tensor_indices, int size)
-    : tensors_(new std::vector<interface::ITensor*>[size]), size_(size) {
-  assert(size_ > 0);
-  for (size_t i = 0; i < size_; i++) {
-    tensors_[i].resize(tensors.size());
-    for (size_t j = 0; j < tensors_[i].size(); j++) {
-      tensors_[i][j] = new Tensor(tensors[j].get());
-    }
+    std::vector<int> tensor_indices, int initial_size, int max_size)
+    : tensors_(tensors),
+      chunk_size_(initial_size),
+      max_size_(std::max(initial_size, max_size)),
+      chunks_(new std::atomic<Slot*>[(max_size_ + chunk_size_ - 1) /
+                                     chunk_size_]) {
+  assert(chunk_size_ > 0);
+  const int num_chunks = (max_size_ + chunk_size_ - 1) / chunk_size_;
+  for (int i = 0; i < num_chunks; i++) {
+    chunks_[i].store(nullptr);
   }
 
   for (int i = 0; i < tensor_indices.size(); i++) {
     tensor_to_buffer_[tensor_indices[i]] = i;
   }
+
+  std::lock_guard<std::mutex> lock(grow_mtx_);
+  PushFreeSlot(Grow());
 }
 
 TensorRingBuffer::~TensorRingBuffer() {
-  for (size_t i = 0; i < size_; i++) {
-    for (size_t j = 0; j < tensors_[i].size(); j++) {
-      delete tensors_[i][j];
+  for (int i = 0; i * chunk_size_ < capacity_; i++) {
+    Slot* chunk = chunks_[i].load();
+    for (int j = 0; j < chunk_size_; j++) {
+      for (interface::ITensor* tensor : chunk[j].tensors) {
+        delete tensor;
+      }
     }
+    delete[] chunk;
   }
-
-  delete[] tensors_;
 }
 
-const int TensorRingBuffer::GetTensorsLength() const {
-  return tensors_[0].size();
+const int TensorRingBuffer::GetTensorsLength() const { return tensors_.size(); }
+
+absl::StatusOr<int> TensorRingBuffer::Alloc() {
+  int index = PopFreeSlot();
+  if (index < 0) {
+    std::lock_guard<std::mutex> lock(grow_mtx_);
+    // Other thread may have grown the pool or freed a slot in the meantime
+    index = PopFreeSlot();
+    if (index < 0) {
+      index = Grow();
+    }
+  }
+  if (index < 0) {
+    return absl::ResourceExhaustedError(
+        absl::StrFormat("Alloc: All %d slots are in use.", max_size_));
+  }
+
+  Slot& slot = GetSlot(index);
+  int handle = slot.handle.load(std::memory_order_relaxed);
+  // Advance the generation, and wrap around before the overflow
+  handle = (handle < 0 || handle > std::numeric_limits<int>::max() - max_size_)
+               ? index
+               : handle + max_size_;
+  slot.handle.store(handle, std::memory_order_relaxed);
+  slot.ref_count.store(1, std::memory_order_release);
+
+  const int num_in_use = ++num_in_use_;
+  int peak_usage = peak_usage_.load(std::memory_order_relaxed);
+  while (num_in_use > peak_usage &&
+         !peak_usage_.compare_exchange_weak(peak_usage, num_in_use)) {
+  }
+  return handle;
 }
 
-int TensorRingBuffer::Alloc() {
-  std::lock_guard<std::mutex> lock(head_mtx_);
-  return head_++;
+bool TensorRingBuffer::Acquire(int handle) { return AcquireSlot(handle); }
+
+absl::Status TensorRingBuffer::Release(int handle) {
+  if (handle < 0 || GetIndex(handle) >= capacity_) {
+    return absl::InternalError(
+        absl::StrFormat("Release: Invalid memory handle: %d.", handle));
+  }
+  Slot& slot = GetSlot(GetIndex(handle));
+  int ref_count = slot.ref_count.load(std::memory_order_acquire);
+  do {
+    // Reject a double release instead of freeing a reused slot
+    if (ref_count == 0 ||
+        slot.handle.load(std::memory_order_acquire) != handle) {
+      return absl::InternalError(
+          absl::StrFormat("Release: Invalid memory handle: %d.", handle));
+    }
+  } while (!slot.ref_count.compare_exchange_weak(ref_count, ref_count - 1,
+                                                 std::memory_order_acq_rel));
+  if (ref_count == 1) {
+    num_in_use_--;
+    PushFreeSlot(GetIndex(handle));
+  }
+  return absl::OkStatus();
 }
 
 bool TensorRingBuffer::IsTensorIndexValid(int tensor_index) const {
@@ -65,7 +123,12 @@ bool TensorRingBuffer::IsTensorIndexValid(int tensor_index) const {
 }
 
 bool TensorRingBuffer::IsHandleValid(int handle) const {
-  return (handle >= 0) && (head_ - size_ <= handle) && (handle < head_);
+  if (handle < 0 || GetIndex(handle) >= capacity_) {
+    return false;
+  }
+  const Slot& slot = GetSlot(GetIndex(handle));
+  return slot.handle.load(std::memory_order_acquire) == handle &&
+         slot.ref_count.load(std::memory_order_acquire) > 0;
 }
 
 absl::Status TensorRingBuffer::GetTensorFromHandle(interface::ITensor* dst,
@@ -76,15 +139,16 @@ absl::Status TensorRingBuffer::GetTensorFromHandle(interface::ITensor* dst,
         "GetTensorFromHandle: Invalid tensor index: %d.", tensor_index));
   }
 
-  std::lock_guard<std::mutex> lock(head_mtx_);
-  if (!IsHandleValid(handle)) {
+  if (!AcquireSlot(handle)) {
     return absl::InternalError(absl::StrFormat(
-        "GetTensorFromHandle: Invalid memory handle: %d head: %d.", handle,
-        head_));
+        "GetTensorFromHandle: Invalid memory handle: %d.", handle));
   }
 
-  return CopyTensor(
-      tensors_[GetIndex(handle)][tensor_to_buffer_.at(tensor_index)], dst);
+  auto status = CopyTensor(
+      GetSlot(GetIndex(handle)).tensors[tensor_to_buffer_.at(tensor_index)],
+      dst);
+  ReleaseSlot(GetIndex(handle));
+  return status;
 }
 
 absl::Status TensorRingBuffer::PutTensorToHandle(const interface::ITensor* src,
@@ -94,38 +158,149 @@ absl::Status TensorRingBuffer::PutTensorToHandle(const interface::ITensor* src,
         "PutTensorToHandle: Invalid tensor index: %d.", tensor_index));
   }
 
-  std::lock_guard<std::mutex> lock(head_mtx_);
-  if (!IsHandleValid(handle)) {
+  if (!AcquireSlot(handle)) {
     return absl::InternalError(absl::StrFormat(
-        "PutTensorToHandle: Invalid memory handle: %d head: %d.", handle,
-        head_));
+        "PutTensorToHandle: Invalid memory handle: %d.", handle));
   }
 
-  return CopyTensor(
-      src, tensors_[GetIndex(handle)][tensor_to_buffer_.at(tensor_index)]);
+  auto status = CopyTensor(
+      src,
+      GetSlot(GetIndex(handle)).tensors[tensor_to_buffer_.at(tensor_index)]);
+  ReleaseSlot(GetIndex(handle));
+  return status;
 }
 
 absl::Status TensorRingBuffer::GetTensorsFromHandle(
     std::vector<interface::ITensor*>& dst_tensors, int handle) const {
-  std::lock_guard<std::mutex> lock(head_mtx_);
-  if (!IsHandleValid(handle)) {
+  if (!AcquireSlot(handle)) {
     return absl::InternalError(absl::StrFormat(
-        "GetTensorsFromHandle: Invalid memory handle: %d head: %d.", handle,
-        head_));
+        "GetTensorsFromHandle: Invalid memory handle: %d.", handle));
   }
-  return CopyTensors(tensors_[GetIndex(handle)], dst_tensors);
+  auto status = CopyTensors(GetSlot(GetIndex(handle)).tensors, dst_tensors);
+  ReleaseSlot(GetIndex(handle));
+  return status;
 }
 
 absl::Status TensorRingBuffer::PutTensorsToHandle(
     const std::vector<interface::ITensor*>& src_tensors, int handle) {
-  std::lock_guard<std::mutex> lock(head_mtx_);
-  if (!IsHandleValid(handle)) {
+  if (!AcquireSlot(handle)) {
     return absl::InternalError(absl::StrFormat(
-        "PutTensorsToHandle: Invalid memory handle: %d head: %d.", handle,
-        head_));
+        "PutTensorsToHandle: Invalid memory handle: %d.", handle));
+  }
+  auto status = CopyTensors(src_tensors, GetSlot(GetIndex(handle)).tensors);
+  ReleaseSlot(GetIndex(handle));
+  return status;
+}
+
+absl::StatusOr<std::vector<const interface::ITensor*>>
+TensorRingBuffer::Lease(int handle) {
+  if (!AcquireSlot(handle)) {
+    return absl::InternalError(
+        absl::StrFormat("Lease: Invalid memory handle: %d.", handle));
   }
+  const std::vector<interface::ITensor*>& tensors =
+      GetSlot(GetIndex(handle)).tensors;
+  return std::vector<const interface::ITensor*>(tensors.begin(),
+                                                tensors.end());
+}
+
+int TensorRingBuffer::GetNumInUse() const { return num_in_use_.load(); }
+
+int TensorRingBuffer::GetCapacity() const { return capacity_; }
 
-  return CopyTensors(src_tensors, tensors_[GetIndex(handle)]);
+int TensorRingBuffer::GetPeakUsage() const { return peak_usage_; }
+
+int TensorRingBuffer::GetIndex(int handle) const { return handle % max_size_; }
+
+TensorRingBuffer::Slot& TensorRingBuffer::GetSlot(int index) const {
+  return chunks_[index / chunk_size_].load(
+      std::memory_order_acquire)[index % chunk_size_];
+}
+
+bool TensorRingBuffer::AcquireSlot(int handle) const {
+  if (handle < 0 || GetIndex(handle) >= capacity_) {
+    return false;
+  }
+  Slot& slot = GetSlot(GetIndex(handle));
+  int ref_count = slot.ref_count.load(std::memory_order_acquire);
+  do {
+    // Never revive a free slot
+    if (ref_count == 0) {
+      return false;
+    }
+  } while (!slot.ref_count.compare_exchange_weak(ref_count, ref_count + 1,
+                                                 std::memory_order_acq_rel));
+
+  // The slot has been reused by another handle
+  if (slot.handle.load(std::memory_order_acquire) != handle) {
+    ReleaseSlot(GetIndex(handle));
+    return false;
+  }
+  return true;
+}
+
+void TensorRingBuffer::ReleaseSlot(int index) const {
+  if (GetSlot(index).ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    num_in_use_--;
+    PushFreeSlot(index);
+  }
+}
+
+void TensorRingBuffer::PushFreeSlot(int index) const {
+  if (index < 0) {
+    return;
+  }
+  Slot& slot = GetSlot(index);
+  uint64_t head = free_head_.load(std::memory_order_acquire);
+  uint64_t new_head;
+  do {
+    slot.next_free.store(static_cast<int>(head & 0xffffffff) - 1,
+                         std::memory_order_relaxed);
+    new_head = (((head >> 32) + 1) << 32) | static_cast<uint32_t>(index + 1);
+  } while (!free_head_.compare_exchange_weak(head, new_head,
+                                             std::memory_order_acq_rel));
+}
+
+int TensorRingBuffer::PopFreeSlot() const {
+  uint64_t head = free_head_.load(std::memory_order_acquire);
+  while (true) {
+    const int index = static_cast<int>(head & 0xffffffff) - 1;
+    if (index < 0) {
+      return -1;
+    }
+    const int next = GetSlot(index).next_free.load(std::memory_order_relaxed);
+    const uint64_t new_head =
+        (((head >> 32) + 1) << 32) | static_cast<uint32_t>(next + 1);
+    if (free_head_.compare_exchange_weak(head, new_head,
+                                         std::memory_order_acq_rel)) {
+      return index;
+    }
+  }
+}
+
+// Must be called with `grow_mtx_`. Returns the first slot of a new chunk and
+// puts the others to the free-list.
+int TensorRingBuffer::Grow() {
+  const int capacity = capacity_;
+  if (capacity >= max_size_) {
+    return -1;
+  }
+
+  Slot* chunk = new Slot[chunk_size_];
+  for (int i = 0; i < chunk_size_; i++) {
+    chunk[i].tensors.resize(tensors_.size());
+    for (size_t j = 0; j < tensors_.size(); j++) {
+      chunk[i].tensors[j] = new Tensor(tensors_[j].get());
+    }
+  }
+  chunks_[capacity / chunk_size_].store(chunk, std::memory_order_release);
+
+  const int num_new_slots = std::min(chunk_size_, max_size_ - capacity);
+  capacity_ = capacity + num_new_slots;
+  for (int i = num_new_slots - 1; i > 0; i--) {
+    PushFreeSlot(capacity + i);
+  }
+  return capacity;
 }
 
 absl::Status TensorRingBuffer::CopyTensors(
@@ -158,5 +333,4 @@ absl::Status TensorRingBuffer::CopyTensor(const interface::ITensor* src,
   return absl::OkStatus();
 }
 
-int TensorRingBuffer::GetIndex(int handle) const { return handle % size_; }
 }  // namespace band
@@ -17,13 +17,14 @@
 #ifndef BAND_TENSOR_RING_BUFFER_H_
 #define BAND_TENSOR_RING_BUFFER_H_
 
-#include <array>
+#include <atomic>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <vector>
 
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "band/interface/tensor.h"
 #include "band/interface/tensor_view.h"
 
@@ -31,14 +32,29 @@ namespace band {
 
 class Tensor;
 
+// Pool of tensor slots for model inputs / outputs.
+// Each slot is reference counted and returned to a lock-free free-list when
+// the last reference is released. The pool starts with `initial_size` slots
+// and grows by `initial_size` slots whenever it runs out, up to `max_size`.
+// A handle encodes the slot index and its generation, so a handle of a
+// reused slot is detected as invalid instead of reading the new data.
 class TensorRingBuffer {
  public:
   TensorRingBuffer(std::vector<std::shared_ptr<interface::ITensor>> tensors,
-                   std::vector<int> tensor_indices, int size = 128);
+                   std::vector<int> tensor_indices, int initial_size = 8,
+                   int max_size = 128);
   ~TensorRingBuffer();
 
   const int GetTensorsLength() const;
-  int Alloc();
+  // Allocate a slot with a single reference owned by the caller.
+  // Returns ResourceExhausted if all `max_size` slots are referenced. A slot
+  // is never taken away from its owner, even if nobody reads it anymore.
+  absl::StatusOr<int> Alloc();
+  // Add a reference to the slot. Returns false if the handle is invalid.
+  bool Acquire(int handle);
+  // Drop a reference to the slot, and free the slot if it was the last one.
+  absl::Status Release(int handle);
+
   bool IsTensorIndexValid(int tensor_index) const;
   bool IsHandleValid(int handle) const;
   absl::Status GetTensorFromHandle(interface::ITensor* dst, int tensor_index,
@@ -49,19 +65,55 @@ class TensorRingBuffer {
       std::vector<interface::ITensor*>& dst_tensors, int handle) const;
   absl::Status PutTensorsToHandle(
       const std::vector<interface::ITensor*>& src_tensors, int handle);
+  // Add a reference to the slot and expose its tensors without copy.
+  // The caller should `Release` the handle when it is done with the tensors.
+  absl::StatusOr<std::vector<const interface::ITensor*>> Lease(int handle);
+
+  int GetCapacity() const;
+  // The number of slots that are allocated or leased.
+  int GetNumInUse() const;
+  // The maximum number of slots that were in use at the same time.
+  int GetPeakUsage() const;
 
  private:
+  struct Slot {
+    std::vector<interface::ITensor*> tensors;
+    std::atomic<int> handle{-1};
+    std::atomic<int> ref_count{0};
+    std::atomic<int> next_free{-1};
+  };
+
   int GetIndex(int handle) const;
+  Slot& GetSlot(int index) const;
+  // Reference counting for const accessors
+  bool AcquireSlot(int handle) const;
+  void ReleaseSlot(int index) const;
+
+  void PushFreeSlot(int index) const;
+  int PopFreeSlot() const;
+  int Grow();
+
   absl::Status CopyTensors(const std::vector<interface::ITensor*>& src_tensors,
                            std::vector<interface::ITensor*>& dst_tensors) const;
   absl::Status CopyTensor(const interface::ITensor* src,
                           interface::ITensor* dst) const;
 
-  mutable std::mutex head_mtx_;
-  int head_ = 0;
-  const int size_;
-  std::vector<interface::ITensor*>* tensors_;
-  // Model's tensor index to ring buffer's index
+  const std::vector<std::shared_ptr<interface::ITensor>> tensors_;
+  const int chunk_size_;
+  const int max_size_;
+  // Slots are allocated in chunks that never move, so that lookups do not
+  // need a lock while the pool grows.
+  std::unique_ptr<std::atomic<Slot*>[]> chunks_;
+  std::atomic<int> capacity_{0};
+  std::mutex grow_mtx_;
+
+  // Head of the free-list. Lower 32 bits hold (slot index + 1) and upper 32
+  // bits hold a tag to avoid ABA problems.
+  mutable std::atomic<uint64_t> free_head_{0};
+  mutable std::atomic<int> num_in_use_{0};
+  std::atomic<int> peak_usage_{0};
+
+  // Model's tensor index to slot's tensor index
   std::map<int, int> tensor_to_buffer_;
 };
 }  // namespace band
@@ -0,0 +1,185 @@
+// Copyright 2023 Seoul National University
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "band/admission_controller.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "band/test/test_util.h"
+#include "band/time.h"
+
+namespace band {
+namespace test {
+
+using ::testing::_;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+// A single worker that runs any model in 10 ms
+struct MockEngine : public NiceMock<MockEngineBase> {
+  MockEngine() {
+    ON_CALL(*this, GetNumWorkers()).WillByDefault(Return(1));
+    ON_CALL(*this, GetLargestSubgraphKey(_, _))
+        .WillByDefault(Return(SubgraphKey(0, 0)));
+    ON_CALL(*this, GetExpected(_)).WillByDefault(Return(10000));
+  }
+};
+
+Job CreateJob(JobId job_id, ModelId model_id, int64_t slo_us = 0) {
+  Job job(model_id);
+  job.job_id = job_id;
+  job.slo_us = slo_us;
+  job.enqueue_time = time::NowMicros();
+  return job;
+}
+
+TEST(AdmissionControllerSuite, Disabled) {
+  MockEngine engine;
+  AdmissionController admission_controller(engine);
+  admission_controller.Init(SheddingPolicy::kNone, 1);
+
+  std::map<JobId, JobStatus> dropped_jobs;
+  std::vector<JobStatus> statuses = admission_controller.Admit(
+      {CreateJob(0, 0, 1), CreateJob(1, 0, 1)}, dropped_jobs);
+  EXPECT_EQ(statuses, std::vector<JobStatus>(2, JobStatus::kQueued));
+  EXPECT_TRUE(dropped_jobs.empty());
+}
+
+TEST(AdmissionControllerSuite, RejectNewestOverQuota) {
+  MockEngine engine;
+  AdmissionController admission_controller(engine);
+  admission_controller.Init(SheddingPolicy::kRejectNewest, 2);
+
+  std::map<JobId, JobStatus> dropped_jobs;
+  std::vector<JobStatus> statuses = admission_controller.Admit(
+      {CreateJob(0, 0), CreateJob(1, 0), CreateJob(2, 0), CreateJob(3, 1)},
+      dropped_jobs);
+  EXPECT_EQ(statuses,
+            std::vector<JobStatus>({JobStatus::kQueued, JobStatus::kQueued,
+                                    JobStatus::kRejected, JobStatus::kQueued}));
+  EXPECT_TRUE(dropped_jobs.empty());
+
+  // A finished job makes room
+  admission_controller.OnFinished(0);
+  statuses = admission_controller.Admit({CreateJob(4, 0)}, dropped_jobs);
+  EXPECT_EQ(statuses[0], JobStatus::kQueued);
+
+  // Per-model quota overrides the default
+  admission_controller.SetModelQuota(1, -1);
+  statuses = admission_controller.Admit({CreateJob(5, 1), CreateJob(6, 1)},
+                                        dropped_jobs);
+  EXPECT_EQ(statuses, std::vector<JobStatus>(2, JobStatus::kQueued));
+}
+
+TEST(AdmissionControllerSuite, DropOldestOverQuota) {
+  MockEngine engine;
+  AdmissionController admission_controller(engine);
+  admission_controller.Init(SheddingPolicy::kDropOldest, 2);
+
+  std::map<JobId, JobStatus> dropped_jobs;
+  std::vector<JobStatus> statuses = admission_controller.Admit(
+      {CreateJob(0, 0), CreateJob(1, 0), CreateJob(2, 0)}, dropped_jobs);
+  EXPECT_EQ(statuses, std::vector<JobStatus>(3, JobStatus::kQueued));
+  EXPECT_EQ(dropped_jobs,
+            (std::map<JobId, JobStatus>{{0, JobStatus::kRejected}}));
+  // The dropped job no longer counts
+  EXPECT_EQ(admission_controller.GetQueuedLatency(), 20000);
+}
+
+TEST(AdmissionControllerSuite, DropOldestKeepsDispatchedJobs) {
+  MockEngine engine;
+  AdmissionController admission_controller(engine);
+  admission_controller.Init(SheddingPolicy::kDropOldest, 2);
+
+  std::map<JobId, JobStatus> dropped_jobs;
+  admission_controller.Admit({CreateJob(0, 0), CreateJob(1, 0)},
+                             dropped_jobs);
+  admission_controller.OnDispatched(0);
+
+  // The oldest job still in the queue gives way
+  std::vector<JobStatus> statuses =
+      admission_controller.Admit({CreateJob(2, 0)}, dropped_jobs);
+  EXPECT_EQ(statuses[0], JobStatus::kQueued);
+  EXPECT_EQ(dropped_jobs,
+            (std::map<JobId, JobStatus>{{1, JobStatus::kRejected}}));
+
+  // Nothing left to drop once every job is running
+  admission_controller.OnDispatched(2);
+  dropped_jobs.clear();
+  statuses = admission_controller.Admit({CreateJob(3, 0)}, dropped_jobs);
+  EXPECT_EQ(statuses[0], JobStatus::kRejected);
+  EXPECT_TRUE(dropped_jobs.empty());
+}
+
+TEST(AdmissionControllerSuite, RejectNewestMissingSLO) {
+  MockEngine engine;
+  AdmissionController admission_controller(engine);
+  admission_controller.Init(SheddingPolicy::kRejectNewest, -1);
+
+  std::map<JobId, JobStatus> dropped_jobs;
+  // Cannot run in time even on an idle worker
+  std::vector<JobStatus> statuses =
+      admission_controller.Admit({CreateJob(0, 0, 5000)}, dropped_jobs);
+  EXPECT_EQ(statuses[0], JobStatus::kSLOViolation);
+
+  // The third one waits for the other two
+  statuses = admission_controller.Admit(
+      {CreateJob(1, 0, 25000), CreateJob(2, 0, 25000), CreateJob(3, 0, 25000)},
+      dropped_jobs);
+  EXPECT_EQ(statuses, std::vector<JobStatus>(
+                          {JobStatus::kQueued, JobStatus::kQueued,
+                           JobStatus::kSLOViolation}));
+  EXPECT_EQ(admission_controller.GetQueuedLatency(), 20000);
+
+  // Dispatched jobs are accounted by the worker waiting time instead
+  admission_controller.OnDispatched(1);
+  EXPECT_EQ(admission_controller.GetQueuedLatency(), 10000);
+  statuses = admission_controller.Admit({CreateJob(4, 0, 25000)},
+                                        dropped_jobs);
+  EXPECT_EQ(statuses[0], JobStatus::kQueued);
+
+  // Requests without SLO are always admitted
+  statuses = admission_controller.Admit({CreateJob(5, 0)}, dropped_jobs);
+  EXPECT_EQ(statuses[0], JobStatus::kQueued);
+  EXPECT_TRUE(dropped_jobs.empty());
+}
+
+TEST(AdmissionControllerSuite, DropOldestMissingSLO) {
+  MockEngine engine;
+  AdmissionController admission_controller(engine);
+  admission_controller.Init(SheddingPolicy::kDropOldest, -1);
+
+  std::map<JobId, JobStatus> dropped_jobs;
+  std::vector<JobStatus> statuses =
+      admission_controller.Admit({CreateJob(0, 0, 12000)}, dropped_jobs);
+  EXPECT_EQ(statuses[0], JobStatus::kQueued);
+
+  // The first job cannot meet its SLO anymore, and gives way to a new one
+  time::SleepForMicros(5000);
+  statuses =
+      admission_controller.Admit({CreateJob(1, 0, 15000)}, dropped_jobs);
+  EXPECT_EQ(statuses[0], JobStatus::kQueued);
+  EXPECT_EQ(dropped_jobs,
+            (std::map<JobId, JobStatus>{{0, JobStatus::kSLOViolation}}));
+  EXPECT_EQ(admission_controller.GetQueuedLatency(), 10000);
+}
+
+}  // namespace test
+}  // namespace band
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
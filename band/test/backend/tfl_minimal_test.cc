@@ -18,6 +18,7 @@
 
 #include <array>
 #include <fstream>
+#include <set>
 #include <vector>
 
 #include "band/backend/tfl/model.h"
@@ -105,6 +106,44 @@ TEST(TFLiteBackend, InterfaceInvoke) {
   delete model_executor;
 }
 
+// An input bound to caller memory is released even if the execution that
+// releases it is skipped, so that the next execution neither reads nor writes
+// the caller memory.
+TEST(TFLiteBackend, ReleaseBoundInputWithoutInvoke) {
+  tfl::TfLiteModel bin_model(0);
+  EXPECT_EQ(bin_model.FromPath("band/test/data/add.tflite"), absl::OkStatus());
+  tfl::TfLiteModelExecutor model_executor(0, 0, DeviceFlag::kCPU);
+  EXPECT_EQ(model_executor.PrepareSubgraph(&bin_model), absl::OkStatus());
+
+  SubgraphKey key = model_executor.GetLargestSubgraphKey();
+  const int input_index = model_executor.GetInputs(key)[0];
+  Tensor caller_input(model_executor.GetTensorView(key, input_index).get());
+  float* caller_data = reinterpret_cast<float*>(caller_input.GetData());
+  caller_data[0] = 1.f;
+  caller_data[1] = 3.f;
+
+  EXPECT_EQ(model_executor.BindInputTensor(key, input_index, &caller_input),
+            absl::OkStatus());
+  EXPECT_EQ(model_executor.GetTensorView(key, input_index)->GetData(),
+            caller_input.GetData());
+
+  // The execution is skipped
+  EXPECT_EQ(model_executor.ReleaseInputTensors(key), absl::OkStatus());
+  auto input_view = model_executor.GetTensorView(key, input_index);
+  EXPECT_NE(input_view->GetData(), caller_input.GetData());
+
+  std::array<float, 2> input = {2.f, 4.f};
+  memcpy(input_view->GetData(), input.data(), input.size() * sizeof(float));
+  EXPECT_EQ(model_executor.ExecuteSubgraph(key), absl::OkStatus());
+
+  auto output_tensor =
+      model_executor.GetTensorView(key, model_executor.GetOutputs(key)[0]);
+  EXPECT_EQ(reinterpret_cast<float*>(output_tensor->GetData())[0], 6.f);
+  EXPECT_EQ(reinterpret_cast<float*>(output_tensor->GetData())[1], 12.f);
+  EXPECT_EQ(caller_data[0], 1.f);
+  EXPECT_EQ(caller_data[1], 3.f);
+}
+
 TEST(TFLiteBackend, SimpleEngineInvokeSync) {
   RuntimeConfigBuilder b;
   auto config =
@@ -201,6 +240,46 @@ TEST(TFLiteBackend, SimpleEngineProfile) {
       engine->GetExpected(engine->GetLargestSubgraphKey(model.GetId(), 0)), 0);
 }
 
+TEST(TFLiteBackend, SimpleEngineBackgroundProfile) {
+  RuntimeConfigBuilder b;
+  RuntimeConfig config =
+      b.AddPlannerLogPath("band/test/data/log.json")
+          .AddSchedulers({SchedulerType::kFixedWorkerGlobalQueue})
+          .AddMinimumSubgraphSize(7)
+          .AddSubgraphPreparationType(
+              SubgraphPreparationType::kMergeUnitSubgraph)
+          .AddCPUMask(CPUMaskFlag::kAll)
+          .AddPlannerCPUMask(CPUMaskFlag::kPrimary)
+          .AddWorkers({DeviceFlag::kCPU, DeviceFlag::kCPU})
+          .AddWorkerNumThreads({3, 4})
+          .AddWorkerCPUMasks({CPUMaskFlag::kBig, CPUMaskFlag::kLittle})
+          .AddSmoothingFactor(0.1)
+          .AddOnline(true)
+          .AddProfileBackground(true)
+          .AddNumWarmups(1)
+          .AddNumRuns(3)
+          .AddAllowWorkSteal(true)
+          .AddAvailabilityCheckIntervalMs(30000)
+          .AddScheduleWindowSize(10)
+          .Build()
+          .value();
+
+  auto engine = Engine::Create(config);
+  EXPECT_TRUE(engine);
+
+  Model model;
+  EXPECT_TRUE(
+      model.FromPath(BackendType::kTfLite, "band/test/data/add.tflite").ok());
+  // Returns without waiting for the profile
+  EXPECT_EQ(engine->RegisterModel(&model), absl::OkStatus());
+  const SubgraphKey key = engine->GetLargestSubgraphKey(model.GetId(), 0);
+  EXPECT_GE(engine->GetExpected(key), 0);
+
+  // Requests are served while the model is being profiled
+  EXPECT_EQ(engine->RequestSync(model.GetId()), absl::OkStatus());
+  EXPECT_GE(engine->GetProfiled(key), 0);
+}
+
 TEST(TFLiteBackend, SimpleEngineInvokeAsync) {
   RuntimeConfigBuilder b;
   RuntimeConfig config =
@@ -261,6 +340,307 @@ TEST(TFLiteBackend, SimpleEngineInvokeAsync) {
   delete output_tensor;
 }  // namespace
 
+TEST(TFLiteBackend, SimpleEngineReplaceModel) {
+  RuntimeConfigBuilder b;
+  RuntimeConfig config =
+      b.AddPlannerLogPath("band/test/data/log.json")
+          .AddSchedulers({SchedulerType::kShortestExpectedLatency})
+          .AddMinimumSubgraphSize(7)
+          .AddSubgraphPreparationType(
+              SubgraphPreparationType::kMergeUnitSubgraph)
+          .AddCPUMask(CPUMaskFlag::kAll)
+          .AddPlannerCPUMask(CPUMaskFlag::kPrimary)
+          .AddWorkers({DeviceFlag::kCPU, DeviceFlag::kCPU})
+          .AddWorkerNumThreads({3, 4})
+          .AddWorkerCPUMasks({CPUMaskFlag::kBig, CPUMaskFlag::kLittle})
+          .AddSmoothingFactor(0.1)
+          .AddProfileDataPath("band/test/data/profile.json")
+          .AddOnline(true)
+          .AddNumWarmups(1)
+          .AddNumRuns(1)
+          .AddAvailabilityCheckIntervalMs(30000)
+          .AddScheduleWindowSize(10)
+          .Build()
+          .value();
+
+  auto engine = Engine::Create(config);
+  EXPECT_TRUE(engine);
+
+  Model model;
+  EXPECT_TRUE(
+      model.FromPath(BackendType::kTfLite, "band/test/data/add.tflite").ok());
+  EXPECT_EQ(engine->RegisterModel(&model), absl::OkStatus());
+
+  Tensor* input_tensor = engine->CreateTensor(
+      model.GetId(), engine->GetInputTensorIndices(model.GetId())[0]);
+  Tensor* output_tensor = engine->CreateTensor(
+      model.GetId(), engine->GetOutputTensorIndices(model.GetId())[0]);
+  EXPECT_TRUE(input_tensor && output_tensor);
+
+  std::array<float, 2> input = {1.f, 3.f};
+  memcpy(input_tensor->GetData(), input.data(), input.size() * sizeof(float));
+
+  // A request admitted before the switch finishes on the previous version
+  std::vector<JobId> job_ids;
+  job_ids.push_back(engine
+                        ->RequestAsync(model.GetId(),
+                                       RequestOption::GetDefaultOption(),
+                                       {input_tensor})
+                        .value());
+
+  Model new_model;
+  EXPECT_TRUE(
+      new_model.FromPath(BackendType::kTfLite, "band/test/data/add.tflite")
+          .ok());
+  EXPECT_EQ(engine->ReplaceModel(&model, &new_model), absl::OkStatus());
+  EXPECT_EQ(engine->ReplaceModel(&model, &model).code(),
+            absl::StatusCode::kInvalidArgument);
+
+  // Requests keep using the id of the replaced model
+  job_ids.push_back(engine
+                        ->RequestAsync(model.GetId(),
+                                       RequestOption::GetDefaultOption(),
+                                       {input_tensor})
+                        .value());
+  for (JobId job_id : job_ids) {
+    EXPECT_EQ(engine->Wait(job_id, {output_tensor}), absl::OkStatus());
+    EXPECT_EQ(reinterpret_cast<float*>(output_tensor->GetData())[0], 3.f);
+    EXPECT_EQ(reinterpret_cast<float*>(output_tensor->GetData())[1], 9.f);
+  }
+
+  EXPECT_EQ(engine->UnregisterModel(&model), absl::OkStatus());
+  EXPECT_FALSE(engine
+                   ->RequestAsync(model.GetId(),
+                                  RequestOption::GetDefaultOption(),
+                                  {input_tensor})
+                   .ok());
+
+  delete input_tensor;
+  delete output_tensor;
+}
+
+TEST(TFLiteBackend, SimpleEngineInvokeAsyncZeroCopy) {
+  RuntimeConfigBuilder b;
+  RuntimeConfig config =
+      b.AddPlannerLogPath("band/test/data/log.json")
+          .AddSchedulers({SchedulerType::kShortestExpectedLatency})
+          .AddMinimumSubgraphSize(7)
+          .AddSubgraphPreparationType(
+              SubgraphPreparationType::kMergeUnitSubgraph)
+          .AddCPUMask(CPUMaskFlag::kAll)
+          .AddPlannerCPUMask(CPUMaskFlag::kPrimary)
+          .AddWorkers({DeviceFlag::kCPU, DeviceFlag::kCPU})
+          .AddWorkerNumThreads({3, 4})
+          .AddWorkerCPUMasks({CPUMaskFlag::kBig, CPUMaskFlag::kLittle})
+          .AddSmoothingFactor(0.1)
+          .AddProfileDataPath("band/test/data/profile.json")
+          .AddOnline(true)
+          .AddNumWarmups(1)
+          .AddNumRuns(1)
+          .AddAllowWorkSteal(true)
+          .AddAvailabilityCheckIntervalMs(30000)
+          .AddScheduleWindowSize(10)
+          .Build()
+          .value();
+
+  auto engine = Engine::Create(config);
+  EXPECT_TRUE(engine);
+
+  Model model;
+  EXPECT_TRUE(
+      model.FromPath(BackendType::kTfLite, "band/test/data/add.tflite").ok());
+  EXPECT_EQ(engine->RegisterModel(&model), absl::OkStatus());
+
+  Tensor* input_tensor = engine->CreateTensor(
+      model.GetId(), engine->GetInputTensorIndices(model.GetId())[0]);
+  Tensor* output_tensor = engine->CreateTensor(
+      model.GetId(), engine->GetOutputTensorIndices(model.GetId())[0]);
+
+  EXPECT_TRUE(input_tensor && output_tensor);
+
+  RequestOption option = RequestOption::GetDefaultOption();
+  option.zero_copy_input = true;
+
+  for (float scale : {1.f, 2.f}) {
+    std::array<float, 2> input = {scale, 3.f * scale};
+    memcpy(input_tensor->GetData(), input.data(),
+           input.size() * sizeof(float));
+
+    auto job_id =
+        engine->RequestAsync(model.GetId(), option, {input_tensor}).value();
+    EXPECT_EQ(engine->Wait(job_id, {output_tensor}), absl::OkStatus());
+    EXPECT_EQ(reinterpret_cast<float*>(output_tensor->GetData())[0],
+              3.f * scale);
+    EXPECT_EQ(reinterpret_cast<float*>(output_tensor->GetData())[1],
+              9.f * scale);
+  }
+
+  // The subgraph falls back to its own storage after the zero-copy request
+  std::array<float, 2> input = {1.f, 3.f};
+  memcpy(input_tensor->GetData(), input.data(), input.size() * sizeof(float));
+  EXPECT_TRUE(engine
+                  ->RequestSync(model.GetId(),
+                                RequestOption::GetDefaultOption(),
+                                {input_tensor}, {output_tensor})
+                  .ok());
+  EXPECT_EQ(reinterpret_cast<float*>(output_tensor->GetData())[0], 3.f);
+  EXPECT_EQ(reinterpret_cast<float*>(output_tensor->GetData())[1], 9.f);
+
+  delete input_tensor;
+  delete output_tensor;
+}
+
+TEST(TFLiteBackend, SimpleEngineWaitAny) {
+  RuntimeConfigBuilder b;
+  RuntimeConfig config =
+      b.AddPlannerLogPath("band/test/data/log.json")
+          .AddSchedulers({SchedulerType::kShortestExpectedLatency})
+          .AddMinimumSubgraphSize(7)
+          .AddSubgraphPreparationType(
+              SubgraphPreparationType::kMergeUnitSubgraph)
+          .AddCPUMask(CPUMaskFlag::kAll)
+          .AddPlannerCPUMask(CPUMaskFlag::kPrimary)
+          .AddWorkers({DeviceFlag::kCPU, DeviceFlag::kCPU})
+          .AddWorkerNumThreads({3, 4})
+          .AddWorkerCPUMasks({CPUMaskFlag::kBig, CPUMaskFlag::kLittle})
+          .AddSmoothingFactor(0.1)
+          .AddProfileDataPath("band/test/data/profile.json")
+          .AddOnline(true)
+          .AddNumWarmups(1)
+          .AddNumRuns(1)
+          .AddAllowWorkSteal(true)
+          .AddAvailabilityCheckIntervalMs(30000)
+          .AddScheduleWindowSize(10)
+          .Build()
+          .value();
+
+  auto engine = Engine::Create(config);
+  EXPECT_TRUE(engine);
+
+  Model model;
+  EXPECT_TRUE(
+      model.FromPath(BackendType::kTfLite, "band/test/data/add.tflite").ok());
+  EXPECT_EQ(engine->RegisterModel(&model), absl::OkStatus());
+
+  Tensor* input_tensor = engine->CreateTensor(
+      model.GetId(), engine->GetInputTensorIndices(model.GetId())[0]);
+  Tensor* output_tensor = engine->CreateTensor(
+      model.GetId(), engine->GetOutputTensorIndices(model.GetId())[0]);
+
+  EXPECT_TRUE(input_tensor && output_tensor);
+
+  std::array<float, 2> input = {1.f, 3.f};
+  memcpy(input_tensor->GetData(), input.data(), input.size() * sizeof(float));
+
+  CompletionQueueId queue_id = engine->CreateCompletionQueue();
+  RequestOption option = RequestOption::GetDefaultOption();
+  option.completion_queue = queue_id;
+
+  std::set<JobId> job_ids;
+  for (int i = 0; i < 3; i++) {
+    job_ids.insert(
+        engine->RequestAsync(model.GetId(), option, {input_tensor}).value());
+  }
+
+  for (int i = 0; i < 3; i++) {
+    auto status_or_job_id = engine->WaitAny(queue_id);
+    ASSERT_TRUE(status_or_job_id.ok());
+    EXPECT_EQ(job_ids.erase(status_or_job_id.value()), 1);
+    EXPECT_EQ(engine->GetOutputTensors(status_or_job_id.value(),
+                                       {output_tensor}),
+              absl::OkStatus());
+    EXPECT_EQ(reinterpret_cast<float*>(output_tensor->GetData())[1], 9.f);
+  }
+  EXPECT_EQ(engine->WaitAny(queue_id, 0).status().code(),
+            absl::StatusCode::kDeadlineExceeded);
+
+  EXPECT_EQ(engine->DestroyCompletionQueue(queue_id), absl::OkStatus());
+  EXPECT_FALSE(engine->WaitAny(queue_id, 0).ok());
+  EXPECT_FALSE(
+      engine->RequestAsync(model.GetId(), option, {input_tensor}).ok());
+
+  delete input_tensor;
+  delete output_tensor;
+}
+
+TEST(TFLiteBackend, SimpleEngineDynamicBatching) {
+  RuntimeConfigBuilder b;
+  RuntimeConfig config =
+      b.AddPlannerLogPath("band/test/data/log.json")
+          .AddSchedulers({SchedulerType::kShortestExpectedLatency})
+          .AddMinimumSubgraphSize(7)
+          .AddSubgraphPreparationType(
+              SubgraphPreparationType::kMergeUnitSubgraph)
+          .AddCPUMask(CPUMaskFlag::kAll)
+          .AddPlannerCPUMask(CPUMaskFlag::kPrimary)
+          .AddWorkers({DeviceFlag::kCPU, DeviceFlag::kCPU})
+          .AddWorkerNumThreads({3, 4})
+          .AddWorkerCPUMasks({CPUMaskFlag::kBig, CPUMaskFlag::kLittle})
+          .AddSmoothingFactor(0.1)
+          .AddProfileDataPath("band/test/data/profile.json")
+          .AddOnline(true)
+          .AddNumWarmups(1)
+          .AddNumRuns(1)
+          .AddAllowWorkSteal(true)
+          .AddAvailabilityCheckIntervalMs(30000)
+          .AddScheduleWindowSize(10)
+          .Build()
+          .value();
+
+  auto engine = Engine::Create(config);
+  EXPECT_TRUE(engine);
+
+  Model model;
+  EXPECT_TRUE(
+      model.FromPath(BackendType::kTfLite, "band/test/data/add.tflite").ok());
+  EXPECT_EQ(engine->RegisterModel(&model), absl::OkStatus());
+  // Wait long enough for all requests to join a single batch
+  EXPECT_EQ(engine->SetBatchingConfig(model.GetId(), {3, 1000000}),
+            absl::OkStatus());
+
+  std::vector<Tensor*> input_tensors;
+  std::vector<Tensor*> output_tensors;
+  std::vector<JobId> job_ids;
+  for (int i = 0; i < 3; i++) {
+    input_tensors.push_back(engine->CreateTensor(
+        model.GetId(), engine->GetInputTensorIndices(model.GetId())[0]));
+    output_tensors.push_back(engine->CreateTensor(
+        model.GetId(), engine->GetOutputTensorIndices(model.GetId())[0]));
+
+    std::array<float, 2> input = {1.f + i, 3.f + i};
+    memcpy(input_tensors[i]->GetData(), input.data(),
+           input.size() * sizeof(float));
+    job_ids.push_back(engine
+                          ->RequestAsync(model.GetId(),
+                                         RequestOption::GetDefaultOption(),
+                                         {input_tensors[i]})
+                          .value());
+  }
+
+  // Outputs are scattered back to each request
+  for (int i = 0; i < 3; i++) {
+    EXPECT_EQ(engine->Wait(job_ids[i], {output_tensors[i]}), absl::OkStatus());
+    EXPECT_EQ(reinterpret_cast<float*>(output_tensors[i]->GetData())[0],
+              3.f * (1.f + i));
+    EXPECT_EQ(reinterpret_cast<float*>(output_tensors[i]->GetData())[1],
+              3.f * (3.f + i));
+  }
+
+  // A single request runs with the batch size of 1 again
+  EXPECT_EQ(engine->SetBatchingConfig(model.GetId(), {1, 0}),
+            absl::OkStatus());
+  EXPECT_EQ(engine->RequestSync(model.GetId(),
+                                RequestOption::GetDefaultOption(),
+                                {input_tensors[0]}, {output_tensors[0]}),
+            absl::OkStatus());
+  EXPECT_EQ(reinterpret_cast<float*>(output_tensors[0]->GetData())[1], 9.f);
+
+  for (int i = 0; i < 3; i++) {
+    delete input_tensors[i];
+    delete output_tensors[i];
+  }
+}
+
 TEST(TFLiteBackend, SimpleEngineInvokeSyncOnWorker) {
   RuntimeConfigBuilder b;
   RuntimeConfig config =
@@ -192,6 +192,8 @@ TEST(CApi, EngineSimpleAsyncInvoke) {
 
   EXPECT_EQ(BandEngineWait(engine, handle, &output_tensor, 1), kBandOk);
   EXPECT_EQ(is_finished, true);
+  // The outputs are read only once
+  EXPECT_EQ(BandEngineWait(engine, handle, &output_tensor, 1), kBandErr);
 
   EXPECT_EQ(reinterpret_cast<float*>(BandTensorGetData(output_tensor))[0], 3.f);
   EXPECT_EQ(reinterpret_cast<float*>(BandTensorGetData(output_tensor))[1], 9.f);
@@ -202,6 +204,11 @@ TEST(CApi, EngineSimpleAsyncInvoke) {
   EXPECT_EQ(BandTensorGetDims(output_tensor)[2], 8);
   EXPECT_EQ(BandTensorGetDims(output_tensor)[3], 3);
 
+  // Waiting without outputs discards them
+  handle = BandEngineRequestAsync(engine, model, &input_tensor);
+  EXPECT_EQ(BandEngineWait(engine, handle, nullptr, 0), kBandOk);
+  EXPECT_EQ(BandEngineDiscardOutputs(engine, handle), kBandErr);
+
   EXPECT_EQ(BandEngineUnsetOnEndRequest(engine, callback_handle), kBandOk);
 
   BandTensorDelete(input_tensor);
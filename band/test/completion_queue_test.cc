@@ -0,0 +1,64 @@
+// Copyright 2023 Seoul National University
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "band/completion_queue.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace band {
+namespace test {
+
+TEST(CompletionQueueSuite, PopInCompletionOrder) {
+  CompletionQueue queue;
+  queue.Push(3);
+  queue.Push(1);
+  queue.Push(2);
+
+  EXPECT_EQ(queue.Pop().value(), 3);
+  EXPECT_EQ(queue.Pop(0).value(), 1);
+  EXPECT_EQ(queue.Pop(1000).value(), 2);
+}
+
+TEST(CompletionQueueSuite, PollAndTimeout) {
+  CompletionQueue queue;
+  EXPECT_EQ(queue.Pop(0).status().code(), absl::StatusCode::kDeadlineExceeded);
+  EXPECT_EQ(queue.Pop(1000).status().code(),
+            absl::StatusCode::kDeadlineExceeded);
+
+  std::thread producer([&queue]() { queue.Push(5); });
+  EXPECT_EQ(queue.Pop().value(), 5);
+  producer.join();
+}
+
+TEST(CompletionQueueSuite, CloseWakesWaiters) {
+  CompletionQueue queue;
+  std::thread waiter([&queue]() {
+    EXPECT_EQ(queue.Pop().status().code(), absl::StatusCode::kCancelled);
+  });
+  queue.Close();
+  waiter.join();
+
+  queue.Push(0);
+  EXPECT_EQ(queue.Pop(0).status().code(), absl::StatusCode::kCancelled);
+}
+
+}  // namespace test
+}  // namespace band
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,436 @@
+// Copyright 2023 Seoul National University
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "band/engine.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "band/backend_factory.h"
+#include "band/config_builder.h"
+#include "band/interface/model.h"
+#include "band/interface/model_executor.h"
+#include "band/interface/tensor_view.h"
+#include "band/model.h"
+#include "band/tensor.h"
+#include "band/time.h"
+
+namespace band {
+namespace test {
+
+using namespace interface;
+
+// A model of four ops, where op 1 and 2 both depend on op 0 and op 3 joins
+// them. Each of op 0 to 2 runs on a different set of devices, so that the
+// model splits into four unit subgraphs, the middle two of which are
+// independent.
+ModelSpec GetDiamondModelSpec() {
+  return ModelSpec(4, 5, std::vector<DataType>(5, DataType::kFloat32), {0},
+                   {4}, {{0}, {1}, {1}, {2, 3}}, {{1}, {2}, {3}, {4}},
+                   {{DeviceFlag::kCPU, {}},
+                    {DeviceFlag::kGPU, {0, 2, 3}},
+                    {DeviceFlag::kDSP, {0, 1, 3}}},
+                   {});
+}
+
+class MockTensorView : public ITensorView {
+ public:
+  explicit MockTensorView(int index) : name_(std::to_string(index)) {}
+
+  BackendType GetBackendType() const override { return BackendType::kTfLite; }
+  DataType GetType() const override { return DataType::kFloat32; }
+  void SetType(DataType type) override {}
+  const char* GetData() const override {
+    return reinterpret_cast<const char*>(&data_);
+  }
+  char* GetData() override { return reinterpret_cast<char*>(&data_); }
+  const int* GetDims() const override { return dims_.data(); }
+  size_t GetNumDims() const override { return dims_.size(); }
+  void SetDims(const std::vector<int>& dims) override {}
+  const char* GetName() const override { return name_.c_str(); }
+  Quantization GetQuantization() const override {
+    return {QuantizationType::kNoQuantization, nullptr};
+  }
+  absl::Status SetQuantization(Quantization quantization) override {
+    return absl::OkStatus();
+  }
+
+  float data_ = 0.f;
+
+ private:
+  std::vector<int> dims_ = {1};
+  std::string name_;
+};
+
+class MockModel : public IModel {
+ public:
+  using IModel::IModel;
+  BackendType GetBackendType() const override { return BackendType::kTfLite; }
+  absl::Status FromPath(const char* filename) override {
+    return absl::OkStatus();
+  }
+  absl::Status FromBuffer(const char* buffer, size_t buffer_size) override {
+    return absl::OkStatus();
+  }
+  bool IsInitialized() const override { return true; }
+};
+
+class MockModelExecutor : public IModelExecutor {
+ public:
+  MockModelExecutor(ModelId model_id, WorkerId worker_id,
+                    DeviceFlag device_flag)
+      : IModelExecutor(model_id, worker_id, device_flag),
+        model_spec_(GetDiamondModelSpec()) {
+    for (int i = 0; i < model_spec_.num_tensors; i++) {
+      tensors_.push_back(std::make_shared<MockTensorView>(i));
+    }
+  }
+
+  BackendType GetBackendType() const override { return BackendType::kTfLite; }
+  absl::StatusOr<ModelSpec> InvestigateModelSpec(IModel* model) override {
+    return GetDiamondModelSpec();
+  }
+  absl::Status PrepareSubgraph(IModel* model, std::set<int> ops,
+                               std::set<int> unit_indices) override {
+    const SubgraphKey key(model_id_, worker_id_, unit_indices);
+    Subgraph& subgraph = subgraphs_[key];
+    subgraph.ops = ops;
+    const std::set<int> inputs = model_spec_.GetPureInputTensors(ops);
+    const std::set<int> outputs = model_spec_.GetOutputTensors(ops);
+    subgraph.inputs.assign(inputs.begin(), inputs.end());
+    subgraph.outputs.assign(outputs.begin(), outputs.end());
+    return absl::OkStatus();
+  }
+
+  const std::vector<int>& GetInputs(const SubgraphKey& key) const override {
+    return subgraphs_.at(key).inputs;
+  }
+  const std::vector<int>& GetOutputs(const SubgraphKey& key) const override {
+    return subgraphs_.at(key).outputs;
+  }
+  const char* GetInputName(const SubgraphKey& key, int index) const override {
+    return tensors_[GetInputs(key)[index]]->GetName();
+  }
+  const char* GetOutputName(const SubgraphKey& key,
+                            int index) const override {
+    return tensors_[GetOutputs(key)[index]]->GetName();
+  }
+  size_t GetNumTensors(const SubgraphKey& key) const override {
+    return tensors_.size();
+  }
+  size_t GetNumNodes(const SubgraphKey& key) const override {
+    return subgraphs_.at(key).ops.size();
+  }
+
+  std::shared_ptr<ITensorView> GetTensorView(const SubgraphKey& key,
+                                             int index) override {
+    return tensors_[index];
+  }
+
+  bool HasSubgraph(const SubgraphKey& key) const override {
+    return subgraphs_.find(key) != subgraphs_.end();
+  }
+  SubgraphKey GetLargestSubgraphKey() const override {
+    SubgraphKey largest_key;
+    for (auto& it : subgraphs_) {
+      if (!largest_key.IsValid() || it.first.GetUnitIndices().count() >
+                                        largest_key.GetUnitIndices().count()) {
+        largest_key = it.first;
+      }
+    }
+    return largest_key;
+  }
+
+  // t1 = t0 + 1, t2 = t1 * 2, t3 = t1 * 3 and t4 = t2 + t3
+  absl::Status ExecuteSubgraph(const SubgraphKey& key) override {
+    time::SleepForMicros(100);
+    for (int op : subgraphs_.at(key).ops) {
+      switch (op) {
+        case 0:
+          tensors_[1]->data_ = tensors_[0]->data_ + 1.f;
+          break;
+        case 1:
+          tensors_[2]->data_ = tensors_[1]->data_ * 2.f;
+          break;
+        case 2:
+          tensors_[3]->data_ = tensors_[1]->data_ * 3.f;
+          break;
+        case 3:
+          tensors_[4]->data_ = tensors_[2]->data_ + tensors_[3]->data_;
+          break;
+      }
+    }
+    return absl::OkStatus();
+  }
+  void ForEachSubgraph(
+      std::function<void(const SubgraphKey&)> visitor) override {
+    for (auto& it : subgraphs_) {
+      visitor(it.first);
+    }
+  }
+
+ private:
+  struct Subgraph {
+    std::set<int> ops;
+    std::vector<int> inputs;
+    std::vector<int> outputs;
+  };
+
+  const ModelSpec model_spec_;
+  std::map<SubgraphKey, Subgraph> subgraphs_;
+  std::vector<std::shared_ptr<MockTensorView>> tensors_;
+};
+
+class MockBackendUtil : public IBackendUtil {
+ public:
+  std::set<DeviceFlag> GetAvailableDevices() const override {
+    return {DeviceFlag::kCPU, DeviceFlag::kGPU, DeviceFlag::kDSP};
+  }
+};
+
+struct MockModelExecutorCreator
+    : public Creator<IModelExecutor, ModelId, WorkerId, DeviceFlag, CpuSet,
+                     int> {
+  IModelExecutor* Create(ModelId model_id, WorkerId worker_id,
+                         DeviceFlag device_flag, CpuSet, int) const override {
+    return new MockModelExecutor(model_id, worker_id, device_flag);
+  }
+};
+
+struct MockModelCreator : public Creator<IModel, ModelId> {
+  IModel* Create(ModelId id) const override { return new MockModel(id); }
+};
+
+struct MockBackendUtilCreator : public Creator<IBackendUtil> {
+  IBackendUtil* Create() const override { return new MockBackendUtil(); }
+};
+
+class EngineSuite : public testing::TestWithParam<SchedulerType> {
+ protected:
+  static void SetUpTestSuite() {
+    // Registered backends are replaced by the mock
+    BackendFactory::GetAvailableBackends();
+    BackendFactory::RegisterBackendCreators(
+        BackendType::kTfLite, new MockModelExecutorCreator(),
+        new MockModelCreator(), new MockBackendUtilCreator());
+  }
+};
+
+// The independent unit subgraphs run as branches that are planned by the
+// shortest latency search of the engine, and the request finishes with the
+// outputs of both of them.
+TEST_P(EngineSuite, ParallelUnitSubgraphs) {
+  RuntimeConfigBuilder b;
+  auto config = b.AddSchedulers({GetParam()})
+                    .AddParallelUnitSubgraphs(true)
+                    .AddMinimumSubgraphSize(1)
+                    .AddSubgraphPreparationType(
+                        SubgraphPreparationType::kUnitSubgraph)
+                    .AddWorkers({DeviceFlag::kCPU, DeviceFlag::kGPU,
+                                 DeviceFlag::kDSP})
+                    .AddWorkerCPUMasks({CPUMaskFlag::kAll, CPUMaskFlag::kAll,
+                                        CPUMaskFlag::kAll})
+                    .AddWorkerNumThreads({1, 1, 1})
+                    .AddOnline(true)
+                    .AddNumWarmups(1)
+                    .AddNumRuns(1)
+                    .Build();
+  ASSERT_EQ(config.status(), absl::OkStatus());
+  auto engine = Engine::Create(config.value());
+  ASSERT_TRUE(engine);
+
+  Model model;
+  ASSERT_EQ(model.FromPath(BackendType::kTfLite, "diamond"),
+            absl::OkStatus());
+  ASSERT_EQ(engine->RegisterModel(&model), absl::OkStatus());
+
+  std::unique_ptr<Tensor> input(engine->CreateTensor(
+      model.GetId(), engine->GetInputTensorIndices(model.GetId())[0]));
+  std::unique_ptr<Tensor> output(engine->CreateTensor(
+      model.GetId(), engine->GetOutputTensorIndices(model.GetId())[0]));
+  ASSERT_TRUE(input && output);
+
+  RequestOption option = RequestOption::GetDefaultOption();
+  option.completion_queue = engine->CreateCompletionQueue();
+  for (float value : {1.f, 2.f}) {
+    *reinterpret_cast<float*>(input->GetData()) = value;
+    auto job_id = engine->RequestAsync(model.GetId(), option, {input.get()});
+    ASSERT_EQ(job_id.status(), absl::OkStatus());
+    // A plan that never completes the request does not finish it in time
+    auto finished_job_id =
+        engine->WaitAny(option.completion_queue, 1000 * 1000);
+    ASSERT_EQ(finished_job_id.status(), absl::OkStatus());
+    EXPECT_EQ(finished_job_id.value(), job_id.value());
+    EXPECT_EQ(engine->Wait(job_id.value(), {output.get()}), absl::OkStatus());
+    EXPECT_EQ(*reinterpret_cast<float*>(output->GetData()),
+              (value + 1.f) * 5.f);
+  }
+}
+
+// Outputs are read once. Unread outputs are kept until a new request needs
+// the slot, the oldest first, and leased outputs until they are released.
+TEST_P(EngineSuite, KeepUnreadOutputs) {
+  RuntimeConfigBuilder b;
+  auto config = b.AddSchedulers({GetParam()})
+                    .AddMinimumSubgraphSize(1)
+                    .AddSubgraphPreparationType(
+                        SubgraphPreparationType::kUnitSubgraph)
+                    .AddWorkers({DeviceFlag::kCPU})
+                    .AddWorkerCPUMasks({CPUMaskFlag::kAll})
+                    .AddWorkerNumThreads({1})
+                    .AddOnline(true)
+                    .AddNumWarmups(1)
+                    .AddNumRuns(1)
+                    .AddTensorBufferInitialSize(1)
+                    .AddTensorBufferMaxSize(2)
+                    .Build();
+  ASSERT_EQ(config.status(), absl::OkStatus());
+  auto engine = Engine::Create(config.value());
+  ASSERT_TRUE(engine);
+
+  Model model;
+  ASSERT_EQ(model.FromPath(BackendType::kTfLite, "diamond"),
+            absl::OkStatus());
+  ASSERT_EQ(engine->RegisterModel(&model), absl::OkStatus());
+
+  std::unique_ptr<Tensor> input(engine->CreateTensor(
+      model.GetId(), engine->GetInputTensorIndices(model.GetId())[0]));
+  std::unique_ptr<Tensor> output(engine->CreateTensor(
+      model.GetId(), engine->GetOutputTensorIndices(model.GetId())[0]));
+  ASSERT_TRUE(input && output);
+
+  // Waits for the request without reading its outputs
+  RequestOption option = RequestOption::GetDefaultOption();
+  option.completion_queue = engine->CreateCompletionQueue();
+  auto request = [&](float value) {
+    *reinterpret_cast<float*>(input->GetData()) = value;
+    auto job_id = engine->RequestAsync(model.GetId(), option, {input.get()});
+    if (job_id.ok()) {
+      EXPECT_EQ(engine->WaitAny(option.completion_queue).status(),
+                absl::OkStatus());
+    }
+    return job_id;
+  };
+
+  auto first = request(1.f);
+  ASSERT_EQ(first.status(), absl::OkStatus());
+  EXPECT_EQ(engine->GetOutputTensors(first.value(), {output.get()}),
+            absl::OkStatus());
+  EXPECT_EQ(*reinterpret_cast<float*>(output->GetData()), 10.f);
+  EXPECT_FALSE(engine->GetOutputTensors(first.value(), {output.get()}).ok());
+
+  // The oldest unread outputs give way to a new request
+  auto second = request(2.f);
+  auto third = request(3.f);
+  auto fourth = request(4.f);
+  ASSERT_EQ(second.status(), absl::OkStatus());
+  ASSERT_EQ(third.status(), absl::OkStatus());
+  ASSERT_EQ(fourth.status(), absl::OkStatus());
+  EXPECT_FALSE(engine->GetOutputTensors(second.value(), {output.get()}).ok());
+  EXPECT_EQ(engine->GetOutputTensors(third.value(), {output.get()}),
+            absl::OkStatus());
+  EXPECT_EQ(*reinterpret_cast<float*>(output->GetData()), 20.f);
+
+  EXPECT_EQ(engine->DiscardOutputTensors(fourth.value()), absl::OkStatus());
+  EXPECT_FALSE(engine->DiscardOutputTensors(fourth.value()).ok());
+
+  // Leased outputs are never taken over
+  auto fifth = request(5.f);
+  auto sixth = request(6.f);
+  ASSERT_EQ(fifth.status(), absl::OkStatus());
+  ASSERT_EQ(sixth.status(), absl::OkStatus());
+  auto leased = engine->LeaseOutputTensors(fifth.value());
+  ASSERT_EQ(leased.status(), absl::OkStatus());
+  EXPECT_FALSE(engine->GetOutputTensors(fifth.value(), {output.get()}).ok());
+  ASSERT_EQ(engine->LeaseOutputTensors(sixth.value()).status(),
+            absl::OkStatus());
+  EXPECT_EQ(request(7.f).status().code(),
+            absl::StatusCode::kResourceExhausted);
+  EXPECT_EQ(*reinterpret_cast<const float*>(leased.value()[0]->GetData()),
+            30.f);
+
+  EXPECT_EQ(engine->ReleaseOutputTensors(fifth.value()), absl::OkStatus());
+  EXPECT_EQ(request(7.f).status(), absl::OkStatus());
+
+  // Waiting without outputs discards them
+  auto eighth = engine->RequestAsync(model.GetId(),
+                                     RequestOption::GetDefaultOption(),
+                                     {input.get()});
+  ASSERT_EQ(eighth.status(), absl::OkStatus());
+  EXPECT_EQ(engine->Wait(eighth.value()), absl::OkStatus());
+  EXPECT_FALSE(engine->DiscardOutputTensors(eighth.value()).ok());
+}
+
+// Requests whose outputs are never read do not use up the output slots.
+TEST_P(EngineSuite, UnreadOutputsDoNotBlockRequests) {
+  RuntimeConfigBuilder b;
+  auto config = b.AddSchedulers({GetParam()})
+                    .AddMinimumSubgraphSize(1)
+                    .AddSubgraphPreparationType(
+                        SubgraphPreparationType::kUnitSubgraph)
+                    .AddWorkers({DeviceFlag::kCPU})
+                    .AddWorkerCPUMasks({CPUMaskFlag::kAll})
+                    .AddWorkerNumThreads({1})
+                    .AddOnline(true)
+                    .AddNumWarmups(1)
+                    .AddNumRuns(1)
+                    .Build();
+  ASSERT_EQ(config.status(), absl::OkStatus());
+  auto engine = Engine::Create(config.value());
+  ASSERT_TRUE(engine);
+
+  Model model;
+  ASSERT_EQ(model.FromPath(BackendType::kTfLite, "diamond"),
+            absl::OkStatus());
+  ASSERT_EQ(engine->RegisterModel(&model), absl::OkStatus());
+
+  std::unique_ptr<Tensor> input(engine->CreateTensor(
+      model.GetId(), engine->GetInputTensorIndices(model.GetId())[0]));
+  ASSERT_TRUE(input);
+
+  // More requests than the default `tensor_buffer_max_size`
+  RequestOption option = RequestOption::GetDefaultOption();
+  option.completion_queue = engine->CreateCompletionQueue();
+  for (int i = 0; i < 300; i++) {
+    auto job_id = engine->RequestAsync(model.GetId(), option, {input.get()});
+    ASSERT_EQ(job_id.status(), absl::OkStatus()) << i;
+    ASSERT_EQ(engine->WaitAny(option.completion_queue).status(),
+              absl::OkStatus());
+  }
+  for (int i = 0; i < 300; i++) {
+    auto job_id = engine->RequestAsync(model.GetId(),
+                                       RequestOption::GetDefaultOption(),
+                                       {input.get()});
+    ASSERT_EQ(job_id.status(), absl::OkStatus()) << i;
+    ASSERT_EQ(engine->Wait(job_id.value()), absl::OkStatus());
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    LatencySchedulers, EngineSuite,
+    testing::Values(SchedulerType::kShortestExpectedLatency,
+                    SchedulerType::kHeterogeneousEarliestFinishTime,
+                    SchedulerType::kLeastSlackTimeFirst));
+
+}  // namespace test
+}  // namespace band
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,80 @@
+// Copyright 2023 Seoul National University
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "band/job_arena.h"
+
+#include <gtest/gtest.h>
+
+#include <set>
+#include <vector>
+
+namespace band {
+namespace test {
+
+TEST(JobArenaSuite, StaleHandle) {
+  JobArena arena;
+  JobHandle handle = arena.Allocate();
+  ASSERT_TRUE(handle.IsValid());
+  ASSERT_NE(arena.Get(handle), nullptr);
+  arena.Get(handle)->previous_subgraph_keys.push_back(SubgraphKey(0, 0));
+  EXPECT_EQ(arena.GetNumAllocated(), 1);
+
+  arena.Free(handle);
+  EXPECT_EQ(arena.Get(handle), nullptr);
+  EXPECT_EQ(arena.GetNumAllocated(), 0);
+  // Double free is ignored
+  arena.Free(handle);
+  EXPECT_EQ(arena.GetNumAllocated(), 0);
+
+  // The slot is reused with a new generation and a cleared state
+  JobHandle next_handle = arena.Allocate();
+  EXPECT_EQ(next_handle.index, handle.index);
+  EXPECT_NE(next_handle.generation, handle.generation);
+  EXPECT_EQ(arena.Get(handle), nullptr);
+  ASSERT_NE(arena.Get(next_handle), nullptr);
+  EXPECT_TRUE(arena.Get(next_handle)->previous_subgraph_keys.empty());
+
+  EXPECT_EQ(arena.Get(JobHandle()), nullptr);
+}
+
+TEST(JobArenaSuite, StableAddress) {
+  JobArena arena;
+  JobHandle first = arena.Allocate();
+  JobState* first_state = arena.Get(first);
+
+  // Grow over several chunks
+  std::vector<JobHandle> handles;
+  std::set<int32_t> indices = {first.index};
+  for (int i = 0; i < 1000; i++) {
+    handles.push_back(arena.Allocate());
+    indices.insert(handles.back().index);
+  }
+  EXPECT_EQ(indices.size(), 1001);
+  EXPECT_EQ(arena.Get(first), first_state);
+  EXPECT_EQ(arena.GetNumAllocated(), 1001);
+
+  for (const JobHandle& handle : handles) {
+    arena.Free(handle);
+  }
+  EXPECT_EQ(arena.GetNumAllocated(), 1);
+  EXPECT_EQ(arena.Get(first), first_state);
+}
+
+}  // namespace test
+}  // namespace band
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,84 @@
+// Copyright 2023 Seoul National University
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "band/job_completion_store.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace band {
+namespace test {
+
+Job CreateFinishedJob(JobId job_id) {
+  Job job(0);
+  job.job_id = job_id;
+  job.status = JobStatus::kSuccess;
+  return job;
+}
+
+TEST(JobCompletionStoreSuite, WaitForOwnJob) {
+  JobCompletionStore store;
+  store.Register(0);
+  store.Register(1);
+  EXPECT_EQ(store.GetFinishedJob(0).job_id, -1);
+  EXPECT_TRUE(store.IsPending(0));
+  EXPECT_FALSE(store.IsPending(2));
+
+  std::atomic<bool> woken(false);
+  std::thread waiter([&]() {
+    store.Wait(1);
+    woken = true;
+  });
+
+  // Completion of the other job does not release the waiter
+  store.Complete(CreateFinishedJob(0));
+  EXPECT_EQ(store.GetFinishedJob(0).job_id, 0);
+  EXPECT_FALSE(store.IsPending(0));
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_FALSE(woken);
+
+  store.Complete(CreateFinishedJob(1));
+  waiter.join();
+  EXPECT_TRUE(woken);
+  EXPECT_EQ(store.GetFinishedJob(1).job_id, 1);
+}
+
+TEST(JobCompletionStoreSuite, EvictOldestFinished) {
+  JobCompletionStore store(2);
+  for (JobId job_id = 0; job_id < 3; job_id++) {
+    store.Register(job_id);
+  }
+  EXPECT_EQ(store.Complete(CreateFinishedJob(1)), -1);
+  EXPECT_EQ(store.Complete(CreateFinishedJob(0)), -1);
+  EXPECT_EQ(store.Complete(CreateFinishedJob(2)), 1);
+
+  EXPECT_EQ(store.GetFinishedJob(1).job_id, -1);
+  EXPECT_EQ(store.GetFinishedJob(0).job_id, 0);
+  EXPECT_EQ(store.GetFinishedJob(2).job_id, 2);
+  // Unknown ids never alias other jobs
+  EXPECT_EQ(store.GetFinishedJob(1002).job_id, -1);
+  store.Wait(1);
+  store.Wait(1002);
+}
+
+}  // namespace test
+}  // namespace band
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -55,6 +55,15 @@ struct CustomInvokeMockEngine : public CustomWorkerMockEngine {
   }
 };
 
+struct TwoModelMockEngine : public CustomInvokeMockEngine {
+  using CustomInvokeMockEngine::CustomInvokeMockEngine;
+  void ForEachSubgraph(
+      std::function<void(const SubgraphKey&)> visitor) const override {
+    visitor(SubgraphKey(0, 0));
+    visitor(SubgraphKey(1, 0));
+  }
+};
+
 using WorkerTypeList = testing::Types<DeviceQueueWorker, GlobalQueueWorker>;
 template <class>
 struct WorkerTypesSuite : testing::Test {};
@@ -154,6 +163,48 @@ TEST(LatencyEstimatorSuite, OnlineLatencyProfile) {
   worker.End();
 }
 
+TEST(LatencyEstimatorSuite, ExpectedLatencyEpochs) {
+  CustomInvokeMockEngine engine([](const band::SubgraphKey& subgraph_key) {
+    std::this_thread::sleep_for(std::chrono::microseconds(1000));
+    return absl::OkStatus();
+  });
+
+  ProfileConfigBuilder b;
+  ProfileConfig config =
+      b.AddNumRuns(1).AddNumWarmups(1).AddOnline(true).Build().value();
+
+  DeviceQueueWorker worker(&engine, 0, DeviceFlag::kCPU);
+  engine.worker = &worker;
+  worker.Start();
+  SubgraphKey key(0, 0);
+
+  LatencyEstimator latency_estimator(&engine);
+  EXPECT_EQ(latency_estimator.Init(config), absl::OkStatus());
+  const uint64_t initial_epoch = latency_estimator.GetEpoch();
+  EXPECT_EQ(latency_estimator.ProfileModel(0), absl::OkStatus());
+  const uint64_t profiled_epoch = latency_estimator.GetEpoch();
+  EXPECT_NE(profiled_epoch, initial_epoch);
+
+  // Lookups do not change the epoch, and updates do
+  std::vector<int64_t> latencies;
+  latency_estimator.GetExpected({key, key}, latencies);
+  EXPECT_THAT(latencies, testing::ElementsAre(
+                             latency_estimator.GetExpected(key),
+                             latency_estimator.GetExpected(key)));
+  EXPECT_EQ(latency_estimator.GetEpoch(), profiled_epoch);
+
+  // The drift epoch ignores changes within the threshold
+  const int64_t expected = latency_estimator.GetExpected(key);
+  const uint64_t drift_epoch = latency_estimator.GetDriftEpoch();
+  latency_estimator.UpdateLatency(key, expected);
+  EXPECT_NE(latency_estimator.GetEpoch(), profiled_epoch);
+  EXPECT_EQ(latency_estimator.GetDriftEpoch(), drift_epoch);
+  latency_estimator.UpdateLatency(key, expected * 10);
+  EXPECT_NE(latency_estimator.GetDriftEpoch(), drift_epoch);
+
+  worker.End();
+}
+
 TEST(LatencyEstimatorSuite, OfflineSaveLoadSuccess) {
   CustomInvokeMockEngine engine([](const band::SubgraphKey& subgraph_key) {
     std::this_thread::sleep_for(std::chrono::microseconds(5000));
@@ -265,6 +316,46 @@ TEST(LatencyEstimatorSuite, OfflineSaveLoadFailure) {
   worker.End();
 }
 
+TEST(LatencyEstimatorSuite, BackgroundProfileOfReleasedModel) {
+  std::map<ModelId, int> num_invokes;
+  TwoModelMockEngine engine([&](const band::SubgraphKey& subgraph_key) {
+    num_invokes[subgraph_key.GetModelId()]++;
+    std::this_thread::sleep_for(std::chrono::microseconds(1000));
+    return absl::OkStatus();
+  });
+
+  ProfileConfigBuilder b;
+  ProfileConfig config = b.AddNumRuns(1)
+                             .AddNumWarmups(1)
+                             .AddOnline(true)
+                             .AddBackground(true)
+                             .Build()
+                             .value();
+
+  // Profiles are measured by the manual steps below
+  DeviceQueueWorker worker(&engine, 0, DeviceFlag::kCPU);
+  engine.worker = &worker;
+
+  LatencyEstimator latency_estimator(&engine);
+  EXPECT_EQ(latency_estimator.Init(config), absl::OkStatus());
+  EXPECT_EQ(latency_estimator.ProfileModel(0), absl::OkStatus());
+  while (latency_estimator.ProfileStep(0)) {
+  }
+  const int64_t measured = latency_estimator.GetProfiled(SubgraphKey(0, 0));
+  EXPECT_GT(measured, 0);
+
+  // A new model is estimated as the slowest measured subgraph of the worker
+  EXPECT_EQ(latency_estimator.ProfileModel(1), absl::OkStatus());
+  EXPECT_EQ(latency_estimator.GetExpected(SubgraphKey(1, 0)), measured);
+
+  // Releasing the model drops its pending profiles and estimates only
+  latency_estimator.OnModelReleased(1);
+  EXPECT_FALSE(latency_estimator.ProfileStep(0));
+  EXPECT_EQ(num_invokes[1], 0);
+  EXPECT_EQ(latency_estimator.GetProfiled(SubgraphKey(1, 0)), -1);
+  EXPECT_EQ(latency_estimator.GetProfiled(SubgraphKey(0, 0)), measured);
+}
+
 }  // namespace test
 }  // namespace band
 
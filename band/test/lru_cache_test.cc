@@ -0,0 +1,64 @@
+// Copyright 2023 Seoul National University
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "band/lru_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace band {
+namespace test {
+
+TEST(LruCacheSuite, EvictLeastRecentlyUsed) {
+  LruCache<int, std::string> cache(2);
+  cache.Put(0, "a");
+  cache.Put(1, "b");
+  // Reading 0 makes 1 the least recently used
+  ASSERT_NE(cache.Get(0), nullptr);
+  EXPECT_EQ(*cache.Get(0), "a");
+  cache.Put(2, "c");
+
+  EXPECT_EQ(cache.Size(), 2);
+  EXPECT_EQ(cache.Get(1), nullptr);
+  EXPECT_NE(cache.Get(0), nullptr);
+  EXPECT_NE(cache.Get(2), nullptr);
+}
+
+TEST(LruCacheSuite, OverwriteAndErase) {
+  LruCache<int, std::string> cache(3);
+  cache.Put(0, "a");
+  cache.Put(1, "b");
+  cache.Put(0, "c");
+  EXPECT_EQ(cache.Size(), 2);
+  EXPECT_EQ(*cache.Get(0), "c");
+
+  cache.Put(2, "d");
+  cache.EraseIf([](int key) { return key % 2 == 0; });
+  EXPECT_EQ(cache.Size(), 1);
+  EXPECT_EQ(cache.Get(0), nullptr);
+  EXPECT_NE(cache.Get(1), nullptr);
+
+  cache.Clear();
+  EXPECT_EQ(cache.Size(), 0);
+  EXPECT_EQ(cache.Get(1), nullptr);
+}
+
+}  // namespace test
+}  // namespace band
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,134 @@
+// Copyright 2023 Seoul National University
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Reports the scheduling decisions per second of the planner for each number
+// of shards. Every priority class is served by a real scheduler, and the
+// engine answers the latency queries of the schedulers right away, so that
+// the numbers show the cost of the planner and the schedulers only.
+// Not a test, as the numbers depend on the machine.
+//
+// Usage: planner_benchmark [num_jobs]
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+
+#include "band/planner.h"
+#include "band/test/test_util.h"
+#include "band/time.h"
+
+namespace band {
+namespace test {
+namespace {
+
+using ::testing::NiceMock;
+
+constexpr int kNumClasses = 4;
+constexpr int kNumWorkers = 4;
+constexpr int kScheduleWindowSize = 10;
+
+// Overrides the calls of the planner and the schedulers directly, as calls
+// to mocked methods are serialized by gMock
+struct BenchmarkEngine : public NiceMock<MockEngineBase> {
+  BenchmarkEngine() {
+    for (WorkerId worker_id = 0; worker_id < kNumWorkers; worker_id++) {
+      waiting[worker_id] = 0;
+      idle_workers.insert(worker_id);
+    }
+  }
+
+  void UpdateWorkersWaiting() const override {}
+  WorkerWaitingTime GetWorkerWaitingTime() const override { return waiting; }
+  std::set<WorkerId> GetIdleWorkers() const override { return idle_workers; }
+  bool IsBegin(const SubgraphKey&) const override { return true; }
+  bool IsEnd(const SubgraphKey&) const override { return true; }
+  int64_t GetProfiled(const SubgraphKey&) const override { return 1000; }
+  int64_t GetExpected(const SubgraphKey&) const override { return 1000; }
+  uint64_t GetLatencyEpoch() const override { return 0; }
+  size_t GetNumWorkers() const override { return kNumWorkers; }
+
+  // Spread the models over the workers
+  std::pair<std::vector<SubgraphKey>, int64_t> GetSubgraphWithShortestLatency(
+      const Job& job, const WorkerWaitingTime&) const override {
+    return {{SubgraphKey(job.model_id, job.model_id % kNumWorkers)}, 1000};
+  }
+
+  // Workers finish their jobs right away, and ask for the next ones
+  bool EnqueueToWorker(const ScheduleAction&) override {
+    num_decisions++;
+    planner->Trigger();
+    return true;
+  }
+
+  WorkerWaitingTime waiting;
+  std::set<WorkerId> idle_workers;
+  Planner* planner = nullptr;
+  std::atomic<int> num_decisions{0};
+};
+
+double GetDecisionsPerSec(SchedulerType scheduler_type, int num_shards,
+                          int num_jobs) {
+  BenchmarkEngine engine;
+  Planner planner(engine);
+  engine.planner = &planner;
+  PlannerConfig config;
+  config.schedule_window_size = kScheduleWindowSize;
+  config.schedulers.assign(kNumClasses, scheduler_type);
+  config.num_shards = num_shards;
+  auto status = planner.Init(config);
+  if (!status.ok()) {
+    fprintf(stderr, "%s\n", status.ToString().c_str());
+    return 0;
+  }
+
+  std::vector<Job> jobs;
+  for (int i = 0; i < num_jobs; i++) {
+    Job job(i % (2 * kNumWorkers));
+    job.priority_class = i % kNumClasses;
+    jobs.push_back(job);
+  }
+  const int64_t begin = time::NowMicros();
+  planner.EnqueueBatch(jobs);
+  while (engine.num_decisions < num_jobs) {
+    time::SleepForMicros(100);
+  }
+  return num_jobs * 1000000.0 / (time::NowMicros() - begin);
+}
+
+}  // anonymous namespace
+}  // namespace test
+}  // namespace band
+
+int main(int argc, char** argv) {
+  const int num_jobs = argc > 1 ? atoi(argv[1]) : 100000;
+  if (num_jobs <= 0) {
+    fprintf(stderr, "Usage: %s [num_jobs]\n", argv[0]);
+    return 1;
+  }
+
+  for (band::SchedulerType scheduler_type :
+       {band::SchedulerType::kShortestExpectedLatency,
+        band::SchedulerType::kHeterogeneousEarliestFinishTime,
+        band::SchedulerType::kLeastSlackTimeFirst,
+        band::SchedulerType::kEarliestDeadlineFirst}) {
+    for (int num_shards = 1; num_shards <= band::test::kNumClasses;
+         num_shards++) {
+      printf("%s, %d shards: %.0f decisions/sec\n",
+             band::ToString(scheduler_type), num_shards,
+             band::test::GetDecisionsPerSec(scheduler_type, num_shards,
+                                            num_jobs));
+    }
+  }
+  return 0;
+}
@@ -17,6 +17,10 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <condition_variable>
+#include <thread>
+
+#include "band/model_spec.h"
 #include "band/scheduler/scheduler.h"
 #include "band/test/test_util.h"
 #include "band/time.h"
@@ -40,6 +44,7 @@ struct MockEngine : public MockEngineBase {
 };
 
 class MockScheduler : public IScheduler {
+ public:
   using IScheduler::IScheduler;
 
   MOCK_METHOD1(Schedule, bool(JobQueue&));
@@ -65,6 +70,342 @@ TEST(PlannerSuite, SingleQueue) {
   EXPECT_TRUE(true);
 }
 
+TEST(PlannerSuite, DynamicBatching) {
+  MockEngine engine;
+  Planner planner(engine);
+  auto scheduler = std::make_unique<MockScheduler>(engine);
+
+  std::mutex batch_sizes_mtx;
+  std::vector<size_t> batch_sizes;
+  EXPECT_CALL(*scheduler, Schedule(testing::_))
+      .WillRepeatedly(testing::Invoke([&](JobQueue& jobs) {
+        std::lock_guard<std::mutex> lock(batch_sizes_mtx);
+        for (const Job& job : jobs) {
+          batch_sizes.push_back(job.batch_size);
+        }
+        jobs.clear();
+        return true;
+      }));
+  EXPECT_EQ(planner.AddScheduler(std::move(scheduler)), absl::OkStatus());
+  EXPECT_EQ(planner.SetBatchingConfig(0, {3, 1000}), absl::OkStatus());
+
+  // A full batch is dispatched at once, and the others after the delay
+  planner.EnqueueBatch({Job(0), Job(0), Job(0), Job(0), Job(1)});
+  for (int i = 0; i < 100; i++) {
+    {
+      std::lock_guard<std::mutex> lock(batch_sizes_mtx);
+      if (batch_sizes.size() == 3) {
+        break;
+      }
+    }
+    time::SleepForMicros(1000);
+  }
+
+  std::lock_guard<std::mutex> lock(batch_sizes_mtx);
+  EXPECT_THAT(batch_sizes, testing::UnorderedElementsAre(1, 1, 3));
+}
+
+TEST(PlannerSuite, CancelQueuedJob) {
+  MockEngine engine;
+  Planner planner(engine);
+  auto scheduler = std::make_unique<MockScheduler>(engine);
+  // Jobs stay in the local queue until they are cancelled
+  EXPECT_CALL(*scheduler, Schedule(testing::_))
+      .WillRepeatedly(testing::Return(true));
+  EXPECT_EQ(planner.AddScheduler(std::move(scheduler)), absl::OkStatus());
+
+  std::vector<JobId> job_ids = planner.EnqueueBatch({Job(0), Job(0)});
+  EXPECT_EQ(planner.Cancel({job_ids[0]}), absl::OkStatus());
+  planner.Wait({job_ids[0]});
+  EXPECT_EQ(planner.GetFinishedJob(job_ids[0]).status, JobStatus::kCancelled);
+  EXPECT_EQ(planner.GetFinishedJob(job_ids[1]).job_id, -1);
+
+  // Unknown or finished jobs are reported, and the others are cancelled
+  EXPECT_EQ(planner.Cancel({job_ids[0], job_ids[1]}).code(),
+            absl::StatusCode::kNotFound);
+  planner.Wait({job_ids[1]});
+  EXPECT_EQ(planner.GetFinishedJob(job_ids[1]).status, JobStatus::kCancelled);
+  EXPECT_EQ(planner.Cancel({100}).code(), absl::StatusCode::kNotFound);
+}
+
+TEST(PlannerSuite, AdmissionQuotaNeedsSheddingPolicy) {
+  MockEngine engine;
+  Planner planner(engine);
+  EXPECT_EQ(planner.AddScheduler(std::make_unique<MockScheduler>(engine)),
+            absl::OkStatus());
+  EXPECT_EQ(planner.SetAdmissionQuota(0, 1).code(),
+            absl::StatusCode::kFailedPrecondition);
+}
+
+TEST(PlannerSuite, PriorityClasses) {
+  std::mutex mtx;
+  // Index of the scheduler of each call
+  std::vector<size_t> calls;
+  std::map<JobId, size_t> dispatched;
+
+  MockEngine engine;
+  Planner planner(engine);
+  for (size_t i = 0; i < 3; i++) {
+    auto scheduler = std::make_unique<MockScheduler>(engine);
+    EXPECT_CALL(*scheduler, Schedule(testing::_))
+        .WillRepeatedly(testing::Invoke([&, i](JobQueue& jobs) {
+          std::lock_guard<std::mutex> lock(mtx);
+          // The first class never dispatches, until the last class is
+          // scheduled ahead of it
+          const size_t round_begin = calls.size() - calls.size() % 3;
+          const bool is_first_class_scheduled =
+              std::find(calls.begin() + round_begin, calls.end(), 0) !=
+              calls.end();
+          calls.push_back(i);
+          if (i == 0 || (i == 2 && is_first_class_scheduled)) {
+            return true;
+          }
+          for (const Job& job : jobs) {
+            dispatched[job.job_id] = i;
+          }
+          jobs.clear();
+          return true;
+        }));
+    EXPECT_EQ(planner.AddScheduler(std::move(scheduler)), absl::OkStatus());
+  }
+  EXPECT_EQ(planner.GetNumPriorityClasses(), 3);
+  EXPECT_EQ(planner.SetPriorityArbitration(PriorityArbitration::kStrict, {},
+                                           2000),
+            absl::OkStatus());
+
+  Job interactive(0, 1000);
+  Job background(0);
+  background.priority_class = 1;
+  Job batch(0);
+  std::vector<JobId> job_ids = planner.EnqueueBatch({batch, background});
+  time::SleepForMicros(500);
+  job_ids.push_back(planner.EnqueueRequest(interactive));
+
+  // The batch job waits for the starvation timeout, and then goes ahead of
+  // the newer interactive job
+  for (int i = 0; i < 100; i++) {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      if (dispatched.size() == 2) {
+        break;
+      }
+    }
+    time::SleepForMicros(1000);
+    planner.Trigger();
+  }
+
+  std::lock_guard<std::mutex> lock(mtx);
+  EXPECT_EQ(dispatched, (std::map<JobId, size_t>{{job_ids[0], 2},
+                                                 {job_ids[1], 1}}));
+}
+
+// Unit subgraph 1 and 2 depend on 0, and 3 depends on both 1 and 2
+struct DagMockEngine : public MockEngine {
+  DagMockEngine()
+      : model_spec(4, 5, {}, {0}, {4}, {{0}, {1}, {1}, {2, 3}},
+                   {{1}, {2}, {3}, {4}}, {}, {}) {
+    EXPECT_EQ(model_spec.SetUnitSubgraphs({{0}, {1}, {2}, {3}}),
+              absl::OkStatus());
+  }
+
+  const ModelSpec* GetModelSpec(ModelId) const override {
+    return &model_spec;
+  }
+  bool IsEnd(const SubgraphKey& key) const override {
+    return key.GetUnitIndices().test(3);
+  }
+
+  ModelSpec model_spec;
+};
+
+TEST(PlannerSuite, ParallelUnitSubgraphs) {
+  std::mutex mtx;
+  std::vector<Job> scheduled;
+
+  DagMockEngine engine;
+  Planner planner(engine);
+  planner.SetParallelUnitSubgraphs(true);
+  auto scheduler = std::make_unique<MockScheduler>(engine);
+  EXPECT_CALL(*scheduler, Schedule(testing::_))
+      .WillRepeatedly(testing::Invoke([&](JobQueue& jobs) {
+        std::lock_guard<std::mutex> lock(mtx);
+        scheduled.insert(scheduled.end(), jobs.begin(), jobs.end());
+        jobs.clear();
+        return true;
+      }));
+  EXPECT_EQ(planner.AddScheduler(std::move(scheduler)), absl::OkStatus());
+
+  auto wait_scheduled = [&](size_t num_jobs) {
+    for (int i = 0; i < 100; i++) {
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (scheduled.size() >= num_jobs) {
+          std::vector<Job> jobs = std::move(scheduled);
+          scheduled.clear();
+          return jobs;
+        }
+      }
+      time::SleepForMicros(1000);
+    }
+    return std::vector<Job>();
+  };
+  // Runs the given unit subgraphs of the job on the worker
+  auto finish = [&](Job job, WorkerId worker_id, std::set<int> unit_indices) {
+    job.subgraph_key = SubgraphKey(0, worker_id, unit_indices);
+    job.resolved_unit_subgraphs |= job.subgraph_key.GetUnitIndices();
+    job.status = JobStatus::kSuccess;
+    planner.EnqueueFinishedJob(job);
+  };
+
+  JobId job_id = planner.EnqueueRequest(Job(0));
+  std::vector<Job> jobs = wait_scheduled(1);
+  ASSERT_EQ(jobs.size(), 1);
+  finish(jobs[0], 0, {0});
+
+  // 1 and 2 run in parallel, and the join waits for both of them
+  jobs = wait_scheduled(2);
+  ASSERT_EQ(jobs.size(), 2);
+  std::sort(jobs.begin(), jobs.end(), [](const Job& lhs, const Job& rhs) {
+    return lhs.branch_unit_subgraphs.to_ulong() <
+           rhs.branch_unit_subgraphs.to_ulong();
+  });
+  EXPECT_EQ(jobs[0].branch_unit_subgraphs, BitMask("0010"));
+  EXPECT_EQ(jobs[0].resolved_unit_subgraphs, BitMask("1101"));
+  EXPECT_EQ(jobs[1].branch_unit_subgraphs, BitMask("0100"));
+  EXPECT_EQ(jobs[1].resolved_unit_subgraphs, BitMask("1011"));
+  finish(jobs[1], 1, {2});
+  EXPECT_TRUE(wait_scheduled(1).empty());
+  finish(jobs[0], 0, {1});
+
+  jobs = wait_scheduled(1);
+  ASSERT_EQ(jobs.size(), 1);
+  EXPECT_TRUE(jobs[0].branch_unit_subgraphs.none());
+  EXPECT_EQ(jobs[0].resolved_unit_subgraphs, BitMask("0111"));
+  finish(jobs[0], 0, {3});
+
+  planner.Wait({job_id});
+  EXPECT_EQ(planner.GetFinishedJob(job_id).status, JobStatus::kSuccess);
+}
+
+TEST(PlannerSuite, Shards) {
+  std::mutex mtx;
+  // Thread of each class, and the classes of the dispatched jobs
+  std::map<size_t, std::set<std::thread::id>> threads;
+  std::vector<size_t> dispatched;
+
+  MockEngine engine;
+  Planner planner(engine);
+  for (size_t i = 0; i < 4; i++) {
+    auto scheduler = std::make_unique<MockScheduler>(engine);
+    EXPECT_CALL(*scheduler, Schedule(testing::_))
+        .WillRepeatedly(testing::Invoke([&, i](JobQueue& jobs) {
+          std::lock_guard<std::mutex> lock(mtx);
+          threads[i].insert(std::this_thread::get_id());
+          for (size_t j = 0; j < jobs.size(); j++) {
+            dispatched.push_back(i);
+          }
+          jobs.clear();
+          return true;
+        }));
+    EXPECT_EQ(planner.AddScheduler(std::move(scheduler)), absl::OkStatus());
+  }
+  EXPECT_EQ(planner.SetNumShards(5).code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(planner.SetNumShards(2), absl::OkStatus());
+  EXPECT_EQ(planner.GetNumShards(), 2);
+  EXPECT_EQ(planner.SetNumShards(3).code(),
+            absl::StatusCode::kFailedPrecondition);
+
+  std::vector<Job> jobs;
+  for (int i = 0; i < 8; i++) {
+    Job job(0);
+    job.priority_class = i % 4;
+    jobs.push_back(job);
+  }
+  planner.EnqueueBatch(jobs);
+  for (int i = 0; i < 100; i++) {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      if (dispatched.size() == jobs.size()) {
+        break;
+      }
+    }
+    time::SleepForMicros(1000);
+  }
+
+  // Every class is served by a single thread, which is shared by every
+  // other class
+  std::lock_guard<std::mutex> lock(mtx);
+  EXPECT_THAT(dispatched,
+              testing::UnorderedElementsAre(0, 0, 1, 1, 2, 2, 3, 3));
+  for (size_t i = 0; i < 4; i++) {
+    ASSERT_EQ(threads[i].size(), 1);
+  }
+  EXPECT_EQ(threads[0], threads[2]);
+  EXPECT_EQ(threads[1], threads[3]);
+  EXPECT_NE(threads[0], threads[1]);
+}
+
+// With a shard per class, every class is scheduled by its own thread while
+// the others are scheduling. Each scheduler waits inside `Schedule` until all
+// of them are there, which only happens if the shards run concurrently.
+TEST(PlannerSuite, ShardsScheduleConcurrently) {
+  const size_t kNumClasses = 4;
+  std::mutex mtx;
+  std::condition_variable all_scheduling;
+  size_t num_scheduling = 0;
+  std::map<size_t, std::thread::id> threads;
+  std::set<size_t> met;
+
+  MockEngine engine;
+  Planner planner(engine);
+  for (size_t i = 0; i < kNumClasses; i++) {
+    auto scheduler = std::make_unique<MockScheduler>(engine);
+    EXPECT_CALL(*scheduler, Schedule(testing::_))
+        .WillRepeatedly(testing::Invoke([&, i](JobQueue& jobs) {
+          if (jobs.empty()) {
+            return true;
+          }
+          jobs.clear();
+          std::unique_lock<std::mutex> lock(mtx);
+          threads[i] = std::this_thread::get_id();
+          num_scheduling++;
+          all_scheduling.notify_all();
+          if (all_scheduling.wait_for(lock, std::chrono::seconds(10), [&] {
+                return num_scheduling >= kNumClasses;
+              })) {
+            met.insert(i);
+            all_scheduling.notify_all();
+          }
+          return true;
+        }));
+    EXPECT_EQ(planner.AddScheduler(std::move(scheduler)), absl::OkStatus());
+  }
+  EXPECT_EQ(planner.SetNumShards(kNumClasses), absl::OkStatus());
+
+  std::vector<Job> jobs;
+  for (size_t i = 0; i < kNumClasses; i++) {
+    Job job(0);
+    job.priority_class = i;
+    jobs.push_back(job);
+  }
+  planner.EnqueueBatch(jobs);
+  {
+    std::unique_lock<std::mutex> lock(mtx);
+    all_scheduling.wait_for(lock, std::chrono::seconds(20), [&] {
+      return met.size() == kNumClasses;
+    });
+  }
+
+  std::lock_guard<std::mutex> lock(mtx);
+  EXPECT_EQ(met.size(), kNumClasses);
+  std::set<std::thread::id> distinct_threads;
+  for (const auto& thread : threads) {
+    distinct_threads.insert(thread.second);
+  }
+  EXPECT_EQ(distinct_threads.size(), kNumClasses);
+}
+
 }  // namespace test
 }  // namespace band
 
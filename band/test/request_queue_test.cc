@@ -0,0 +1,102 @@
+// Copyright 2023 Seoul National University
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "band/request_queue.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace band {
+namespace test {
+
+std::vector<Job> CreateJobs(int model_id, int begin, int end) {
+  std::vector<Job> jobs;
+  for (int i = begin; i < end; i++) {
+    Job job(model_id);
+    job.job_id = i;
+    jobs.push_back(job);
+  }
+  return jobs;
+}
+
+TEST(RequestQueueSuite, KeepOrderOfPush) {
+  RequestQueue queue;
+  EXPECT_TRUE(queue.IsEmpty());
+  queue.Push(CreateJobs(0, 0, 3));
+  queue.Push(CreateJobs(0, 3, 5));
+  EXPECT_FALSE(queue.IsEmpty());
+
+  JobQueue jobs;
+  queue.PopAll(jobs);
+  EXPECT_TRUE(queue.IsEmpty());
+  ASSERT_EQ(jobs.size(), 5);
+  for (int i = 0; i < 5; i++) {
+    EXPECT_EQ(jobs[i].job_id, i);
+  }
+}
+
+TEST(RequestQueueSuite, HighPriorityFirst) {
+  RequestQueue queue;
+  queue.Push(CreateJobs(0, 0, 2));
+  queue.Push(CreateJobs(0, 2, 4), true);
+
+  JobQueue jobs;
+  queue.PopAll(jobs);
+  ASSERT_EQ(jobs.size(), 4);
+  EXPECT_EQ(jobs[0].job_id, 2);
+  EXPECT_EQ(jobs[1].job_id, 3);
+  EXPECT_EQ(jobs[2].job_id, 0);
+  EXPECT_EQ(jobs[3].job_id, 1);
+}
+
+TEST(RequestQueueSuite, MultipleProducers) {
+  const int num_producers = 8;
+  const int num_jobs = 1000;
+  RequestQueue queue;
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < num_producers; p++) {
+    producers.emplace_back([&queue, p]() {
+      for (int i = 0; i < num_jobs; i++) {
+        queue.Push(CreateJobs(p, i, i + 1));
+      }
+    });
+  }
+
+  JobQueue jobs;
+  while (jobs.size() < num_producers * num_jobs) {
+    queue.PopAll(jobs);
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+
+  // Jobs from the same producer are in the order of push
+  std::vector<int> last_job_ids(num_producers, -1);
+  for (const Job& job : jobs) {
+    EXPECT_GT(job.job_id, last_job_ids[job.model_id]);
+    last_job_ids[job.model_id] = job.job_id;
+  }
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
+}  // namespace test
+}  // namespace band
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -17,14 +17,21 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <random>
+
 #include "band/config.h"
 #include "band/model.h"
+#include "band/scheduler/earliest_deadline_first_scheduler.h"
+#include "band/scheduler/fair_share_scheduler.h"
 #include "band/scheduler/fixed_worker_scheduler.h"
 #include "band/scheduler/least_slack_first_scheduler.h"
+#include "band/scheduler/pipeline_scheduler.h"
 #include "band/scheduler/round_robin_scheduler.h"
 #include "band/scheduler/shortest_expected_latency_scheduler.h"
+#include "band/scheduler/slo_satisfying_scheduler.h"
 #include "band/scheduler/heterogeneous_earliest_finish_time_scheduler.h"
 #include "band/test/test_util.h"
+#include "band/time.h"
 
 namespace band {
 namespace test {
@@ -266,6 +273,113 @@ TEST_P(ConfigLevelTestsFixture, FixedDeviceFixedWorkerEngineRequestTest) {
   }
 }
 
+TEST(FixedWorkerGlobalQueueSchedulerTest, NoHeadOfLineBlocking) {
+  MockEngine engine({0, 1});
+  FixedWorkerGlobalQueueScheduler scheduler(engine);
+
+  Job busy_job(0);
+  busy_job.target_worker_id = 1;
+  busy_job.expected_latency = 10;
+  engine.action_.push_back({busy_job, SubgraphKey(0, 1, {0})});
+
+  Job pinned_job(1);
+  pinned_job.target_worker_id = 1;
+  std::deque<Job> requests = {pinned_job, Job(0)};
+  scheduler.Schedule(requests);
+
+  // Worker 1 is busy, but the job for worker 0 is not blocked behind it
+  ASSERT_EQ(engine.action_.size(), 2);
+  EXPECT_EQ(engine.action_.back().second.GetWorkerId(), 0);
+  ASSERT_EQ(requests.size(), 1);
+  EXPECT_EQ(requests.front().model_id, 1);
+}
+
+// Runs each worker's jobs back to back on a simulated clock
+struct SimulatedEngine : public MockEngineBase {
+  std::map<ModelId, WorkerId> model_worker;
+  std::map<WorkerId, int64_t> service_time;
+  std::map<WorkerId, int64_t> busy_until;
+  std::map<JobId, int64_t> end_time;
+  int64_t now = 0;
+
+  std::set<WorkerId> GetIdleWorkers() const override {
+    std::set<WorkerId> idle_workers;
+    for (auto& worker : busy_until) {
+      if (worker.second <= now) {
+        idle_workers.insert(worker.first);
+      }
+    }
+    return idle_workers;
+  }
+  void UpdateWorkersWaiting() const override {}
+  WorkerId GetModelWorker(ModelId model_id) const override {
+    return model_worker.at(model_id);
+  }
+  SubgraphKey GetLargestSubgraphKey(ModelId model_id,
+                                    WorkerId worker_id) const override {
+    return SubgraphKey(model_id, worker_id, {0});
+  }
+  int64_t GetExpected(const SubgraphKey& key) const override {
+    return service_time.at(key.GetWorkerId());
+  }
+  bool EnqueueToWorker(const ScheduleAction& action) override {
+    const WorkerId worker_id = action.second.GetWorkerId();
+    busy_until[worker_id] =
+        std::max(now, busy_until[worker_id]) + service_time[worker_id];
+    end_time[action.first.job_id] = busy_until[worker_id];
+    return true;
+  }
+};
+
+// Returns the 99th percentile latency of a bursty workload
+int64_t SimulateTailLatency(SimulatedEngine& engine, IScheduler& scheduler) {
+  engine.model_worker = {{0, 0}, {1, 1}, {2, 0}};
+  engine.service_time = {{0, 7}, {1, 3}};
+  engine.busy_until = {{0, 0}, {1, 0}};
+
+  std::map<JobId, int64_t> enqueue_time;
+  std::deque<Job> requests;
+  JobId next_job_id = 0;
+  for (engine.now = 0; engine.now < 4000; engine.now++) {
+    // A burst of jobs every 100 time units, some pinned to a worker
+    if (engine.now % 100 == 0 && engine.now < 3000) {
+      for (int i = 0; i < 6; i++) {
+        Job job(i % 3);
+        job.job_id = next_job_id++;
+        if (i == 5) {
+          job.target_worker_id = 1;
+        }
+        enqueue_time[job.job_id] = engine.now;
+        requests.push_back(job);
+      }
+    }
+    scheduler.Schedule(requests);
+  }
+  EXPECT_TRUE(requests.empty());
+
+  std::vector<int64_t> latencies;
+  for (auto& job : engine.end_time) {
+    latencies.push_back(job.second - enqueue_time[job.first]);
+  }
+  std::sort(latencies.begin(), latencies.end());
+  return latencies[latencies.size() * 99 / 100];
+}
+
+TEST(FixedWorkerGlobalQueueSchedulerTest, TailLatency) {
+  SimulatedEngine device_queue_engine;
+  FixedWorkerScheduler device_queue_scheduler(device_queue_engine);
+  const int64_t device_queue_tail =
+      SimulateTailLatency(device_queue_engine, device_queue_scheduler);
+
+  SimulatedEngine global_queue_engine;
+  FixedWorkerGlobalQueueScheduler global_queue_scheduler(global_queue_engine);
+  const int64_t global_queue_tail =
+      SimulateTailLatency(global_queue_engine, global_queue_scheduler);
+
+  EXPECT_GT(device_queue_tail, 0);
+  EXPECT_LE(global_queue_tail, device_queue_tail);
+}
+
 TEST_P(ModelLevelWithLatencyTestsFixture, ShortestExepectedLatencyRequestTests) {
   std::deque<int64_t> model_latencies = std::get<0>(GetParam());
   std::set<int> available_workers = std::get<1>(GetParam());
@@ -351,6 +465,538 @@ TEST_P(HeftFixture, HEFTRequestTests) {
   }
 }
 
+Job CreateTenantJob(JobId job_id, int tenant_id) {
+  Job job(0);
+  job.job_id = job_id;
+  job.tenant_id = tenant_id;
+  return job;
+}
+
+TEST(FairShareSchedulerTest, WeightedShare) {
+  MockEngine engine({0});
+  FairShareConfig heavy_config;
+  heavy_config.weight = 3;
+  FairShareScheduler scheduler(engine, {{1, heavy_config}});
+
+  std::deque<Job> requests;
+  for (int i = 0; i < 4; i++) {
+    requests.push_back(CreateTenantJob(i, 0));
+  }
+  for (int i = 4; i < 8; i++) {
+    requests.push_back(CreateTenantJob(i, 1));
+  }
+
+  // A single worker, and each job takes 100 us
+  std::vector<int> tenants;
+  for (int i = 0; i < 4; i++) {
+    scheduler.Schedule(requests);
+    ASSERT_EQ(engine.action_.size(), i + 1);
+    const Job& job = engine.action_.back().first;
+    tenants.push_back(job.tenant_id);
+    scheduler.OnJobFinished(job, 100);
+  }
+  EXPECT_EQ(tenants, std::vector<int>({0, 1, 1, 1}));
+  EXPECT_DOUBLE_EQ(scheduler.GetVirtualTime(0), 100);
+  EXPECT_DOUBLE_EQ(scheduler.GetVirtualTime(1), 100);
+
+  // Untagged requests belong to their model
+  EXPECT_EQ(FairShareScheduler::GetTenantId(Job(5)),
+            FairShareScheduler::GetTenantId(Job(5)));
+  EXPECT_NE(FairShareScheduler::GetTenantId(Job(5)),
+            FairShareScheduler::GetTenantId(Job(4)));
+}
+
+// Tenant 0 and the untagged requests of model 0 are accounted apart
+TEST(FairShareSchedulerTest, UntaggedModelIsNotTenant) {
+  MockEngine engine({0});
+  FairShareConfig limited_config;
+  limited_config.rate_limit_us = 1000;
+  limited_config.burst_us = 100;
+  FairShareScheduler scheduler(engine, {{0, limited_config}});
+
+  Job untagged(0);
+  untagged.job_id = 0;
+  EXPECT_NE(FairShareScheduler::GetTenantId(untagged),
+            FairShareScheduler::GetTenantId(CreateTenantJob(1, 0)));
+
+  // The untagged request is not limited by the config of tenant 0
+  std::deque<Job> requests = {untagged};
+  scheduler.Schedule(requests);
+  ASSERT_EQ(engine.action_.size(), 1);
+  scheduler.OnJobFinished(engine.action_.back().first, 200);
+  EXPECT_DOUBLE_EQ(scheduler.GetVirtualTime(0), 0);
+
+  // Nor does tenant 0 pay for it
+  requests = {CreateTenantJob(1, 0)};
+  scheduler.Schedule(requests);
+  ASSERT_EQ(engine.action_.size(), 2);
+  EXPECT_EQ(engine.action_.back().first.job_id, 1);
+}
+
+TEST(FairShareSchedulerTest, RateLimit) {
+  MockEngine engine({0});
+  FairShareConfig limited_config;
+  limited_config.rate_limit_us = 1000;
+  limited_config.burst_us = 100;
+  FairShareScheduler scheduler(engine, {{0, limited_config}});
+
+  std::deque<Job> requests = {CreateTenantJob(0, 0), CreateTenantJob(1, 0)};
+  scheduler.Schedule(requests);
+  ASSERT_EQ(engine.action_.size(), 1);
+  // Spends more than the bucket holds
+  scheduler.OnJobFinished(engine.action_.back().first, 200);
+
+  scheduler.Schedule(requests);
+  EXPECT_EQ(engine.action_.size(), 1);
+  EXPECT_EQ(requests.size(), 1);
+  // Refills 100 us in 100 ms
+  EXPECT_GT(scheduler.GetRetryTimeout(), 90000);
+
+  // The others are not limited
+  requests.push_back(CreateTenantJob(2, 1));
+  scheduler.Schedule(requests);
+  ASSERT_EQ(engine.action_.size(), 2);
+  EXPECT_EQ(engine.action_.back().first.job_id, 2);
+}
+
+// Plans two subgraphs for a fresh job, and one for a continuation
+struct EdfMockEngine : public MockEngine {
+  EdfMockEngine(std::set<WorkerId> idle_workers) : MockEngine(idle_workers) {}
+
+  std::pair<std::vector<SubgraphKey>, int64_t> GetSubgraphWithShortestLatency(
+      const Job& job, const WorkerWaitingTime& worker_waiting) const override {
+    std::vector<SubgraphKey> keys = {SubgraphKey(job.model_id, 0, {0})};
+    if (job.resolved_unit_subgraphs.none()) {
+      keys.push_back(SubgraphKey(job.model_id, 0, {1}));
+    }
+    return {keys, 0};
+  }
+};
+
+Job CreateDeadlineJob(JobId job_id, int64_t enqueue_time, int slo_us) {
+  Job job(0);
+  job.job_id = job_id;
+  job.enqueue_time = enqueue_time;
+  job.slo_us = slo_us;
+  return job;
+}
+
+TEST(EarliestDeadlineFirstSchedulerTest, DeadlineOrder) {
+  EdfMockEngine engine({0});
+  EarliestDeadlineFirstScheduler scheduler(engine, 10);
+
+  const int64_t now = time::NowMicros();
+  std::deque<Job> requests = {
+      CreateDeadlineJob(0, now, 0), CreateDeadlineJob(1, now, 300000),
+      CreateDeadlineJob(2, now, 100000), CreateDeadlineJob(3, now, 200000)};
+
+  // A single worker takes a job at a time
+  std::vector<JobId> job_ids;
+  for (int i = 0; i < 4; i++) {
+    scheduler.Schedule(requests);
+    ASSERT_EQ(engine.action_.size(), i + 1);
+    job_ids.push_back(engine.action_.back().first.job_id);
+  }
+  EXPECT_EQ(job_ids, std::vector<JobId>({2, 3, 1, 0}));
+  EXPECT_TRUE(requests.empty());
+}
+
+TEST(EarliestDeadlineFirstSchedulerTest, SubDeadline) {
+  EdfMockEngine engine({0});
+  EarliestDeadlineFirstScheduler scheduler(engine, 10);
+
+  const int64_t now = time::NowMicros();
+  // The last subgraph of a job due in 200 ms
+  Job continuation = CreateDeadlineJob(0, now, 200000);
+  continuation.resolved_unit_subgraphs.set(0);
+  // Half of 300 ms for the first of two subgraphs
+  Job fresh = CreateDeadlineJob(1, now, 300000);
+  std::deque<Job> requests = {continuation, fresh};
+
+  scheduler.Schedule(requests);
+  ASSERT_EQ(engine.action_.size(), 1);
+  EXPECT_EQ(engine.action_.back().first.job_id, 1);
+  scheduler.Schedule(requests);
+  ASSERT_EQ(engine.action_.size(), 2);
+  EXPECT_EQ(engine.action_.back().first.job_id, 0);
+}
+
+// Worker 1 is slow, and only meets a loose SLO
+struct SLOMockEngine : public MockEngine {
+  SLOMockEngine(std::set<WorkerId> idle_workers) : MockEngine(idle_workers) {}
+
+  SubgraphKey GetSubgraphIdxSatisfyingSLO(
+      const Job& job, const WorkerWaitingTime& worker_waiting,
+      const std::set<WorkerId>& idle_workers) const override {
+    if (job.slo_us >= 200000 && idle_workers.count(1)) {
+      return SubgraphKey(job.model_id, 1, {0});
+    }
+    return {};
+  }
+};
+
+TEST(SLOSatisfyingSchedulerTest, SlowWorkerForLooseSLO) {
+  SLOMockEngine engine({0, 1});
+  SLOSatisfyingScheduler scheduler(engine, 10);
+
+  const int64_t now = time::NowMicros();
+  std::deque<Job> requests = {CreateDeadlineJob(0, now, 0),
+                              CreateDeadlineJob(1, now, 300000),
+                              CreateDeadlineJob(2, now, 100000)};
+
+  scheduler.Schedule(requests);
+  ASSERT_EQ(engine.action_.size(), 2);
+  // The tight job takes the fastest plan, and the loose one the slow worker
+  EXPECT_EQ(engine.action_[0].first.job_id, 2);
+  EXPECT_EQ(engine.action_[0].second.GetWorkerId(), 0);
+  EXPECT_EQ(engine.action_[1].first.job_id, 1);
+  EXPECT_EQ(engine.action_[1].second.GetWorkerId(), 1);
+  // The fastest worker is taken
+  ASSERT_EQ(requests.size(), 1);
+  EXPECT_EQ(requests.front().job_id, 0);
+}
+
+// The fastest plan runs unit 0 on worker 1, and unit 1 on worker 0, or the
+// other way around once swapped
+struct PipelineMockEngine : public MockEngine {
+  PipelineMockEngine(std::set<WorkerId> idle_workers)
+      : MockEngine(idle_workers) {}
+
+  uint64_t GetLatencyEpoch() const override { return latency_epoch; }
+  std::pair<std::vector<SubgraphKey>, int64_t> GetSubgraphWithShortestLatency(
+      const Job& job, const WorkerWaitingTime& worker_waiting) const override {
+    std::vector<SubgraphKey> keys;
+    if (job.resolved_unit_subgraphs.none()) {
+      keys.push_back(SubgraphKey(job.model_id, swapped ? 0 : 1, {0}));
+    }
+    keys.push_back(SubgraphKey(job.model_id, swapped ? 1 : 0, {1}));
+    return {keys, 0};
+  }
+
+  bool IsEnd(const SubgraphKey& key) const override {
+    return key.GetUnitIndices().test(1);
+  }
+
+  uint64_t latency_epoch = 0;
+  bool swapped = false;
+};
+
+TEST(PipelineSchedulerTest, OverlapStages) {
+  PipelineMockEngine engine({0, 1});
+  PipelineScheduler scheduler(engine, 2);
+
+  std::deque<Job> requests;
+  for (JobId job_id = 0; job_id < 3; job_id++) {
+    Job job(0);
+    job.job_id = job_id;
+    requests.push_back(job);
+  }
+
+  // The first stage takes up to two requests
+  scheduler.Schedule(requests);
+  ASSERT_EQ(engine.action_.size(), 2);
+  EXPECT_EQ(engine.action_[0].second.GetWorkerId(), 1);
+  EXPECT_EQ(engine.action_[1].second.GetWorkerId(), 1);
+  EXPECT_EQ(requests.size(), 1);
+  EXPECT_EQ(scheduler.GetStages(0).size(), 2);
+
+  // The first request moves on to the second stage
+  Job finished = engine.action_[0].first;
+  finished.subgraph_key = engine.action_[0].second;
+  scheduler.OnJobFinished(finished, 10);
+  Job remaining_ops = finished;
+  remaining_ops.resolved_unit_subgraphs.set(0);
+  requests.push_front(remaining_ops);
+
+  // Its tail overlaps with the first stage of the third request
+  scheduler.Schedule(requests);
+  ASSERT_EQ(engine.action_.size(), 4);
+  EXPECT_EQ(engine.action_[2].first.job_id, 0);
+  EXPECT_EQ(engine.action_[2].second.GetWorkerId(), 0);
+  EXPECT_EQ(engine.action_[3].first.job_id, 2);
+  EXPECT_EQ(engine.action_[3].second.GetWorkerId(), 1);
+  EXPECT_TRUE(requests.empty());
+}
+
+// A job frees its stage even if it finishes on another worker, or comes back
+// to the queue without finishing
+TEST(PipelineSchedulerTest, ReleaseStolenAndReenqueuedJobs) {
+  PipelineMockEngine engine({0, 1});
+  PipelineScheduler scheduler(engine, 1);
+
+  std::deque<Job> requests;
+  for (JobId job_id = 0; job_id < 3; job_id++) {
+    Job job(0);
+    job.job_id = job_id;
+    requests.push_back(job);
+  }
+
+  scheduler.Schedule(requests);
+  ASSERT_EQ(engine.action_.size(), 1);
+  EXPECT_EQ(requests.size(), 2);
+
+  // Stolen by worker 0
+  Job stolen = engine.action_[0].first;
+  stolen.subgraph_key = SubgraphKey(0, 0, {0});
+  scheduler.OnJobFinished(stolen, 10);
+  scheduler.Schedule(requests);
+  ASSERT_EQ(engine.action_.size(), 2);
+  EXPECT_EQ(engine.action_[1].first.job_id, 1);
+  EXPECT_EQ(requests.size(), 1);
+
+  // Re-enqueued without finishing
+  requests.push_front(engine.action_[1].first);
+  scheduler.Schedule(requests);
+  ASSERT_EQ(engine.action_.size(), 3);
+  EXPECT_EQ(engine.action_[2].first.job_id, 1);
+  EXPECT_EQ(requests.size(), 1);
+}
+
+TEST(PipelineSchedulerTest, RepinStagesOnLatencyDrift) {
+  PipelineMockEngine engine({0, 1});
+  PipelineScheduler scheduler(engine, 1);
+
+  std::deque<Job> requests;
+  for (JobId job_id = 0; job_id < 3; job_id++) {
+    Job job(0);
+    job.job_id = job_id;
+    requests.push_back(job);
+  }
+
+  scheduler.Schedule(requests);
+  ASSERT_EQ(engine.action_.size(), 1);
+  EXPECT_EQ(engine.action_[0].second.GetWorkerId(), 1);
+
+  // Same epoch, the stages stay pinned
+  engine.swapped = true;
+  scheduler.Schedule(requests);
+  EXPECT_EQ(engine.action_.size(), 1);
+  EXPECT_EQ(scheduler.GetStages(0).front().GetWorkerId(), 1);
+
+  // The first stage moves to worker 0, and the job in flight on the previous
+  // one does not hold it
+  engine.latency_epoch++;
+  scheduler.Schedule(requests);
+  ASSERT_EQ(engine.action_.size(), 2);
+  EXPECT_EQ(engine.action_[1].second.GetWorkerId(), 0);
+  EXPECT_EQ(scheduler.GetStages(0).front().GetWorkerId(), 0);
+
+  // Finishing the job of the previous stages frees nothing
+  Job finished = engine.action_[0].first;
+  finished.subgraph_key = engine.action_[0].second;
+  scheduler.OnJobFinished(finished, 10);
+  scheduler.Schedule(requests);
+  EXPECT_EQ(engine.action_.size(), 2);
+  EXPECT_EQ(requests.size(), 1);
+}
+
+TEST(PipelineSchedulerTest, DropStagesOfReleasedModel) {
+  PipelineMockEngine engine({0, 1});
+  PipelineScheduler scheduler(engine, 1);
+
+  std::deque<Job> requests;
+  for (JobId job_id = 0; job_id < 2; job_id++) {
+    Job job(0);
+    job.job_id = job_id;
+    requests.push_back(job);
+  }
+  scheduler.Schedule(requests);
+  ASSERT_EQ(engine.action_.size(), 1);
+  EXPECT_EQ(scheduler.GetStages(0).size(), 2);
+
+  scheduler.OnModelReleased(0);
+  EXPECT_TRUE(scheduler.GetStages(0).empty());
+
+  // A model registered again under the id starts with free stages
+  scheduler.Schedule(requests);
+  ASSERT_EQ(engine.action_.size(), 2);
+  EXPECT_EQ(engine.action_[1].first.job_id, 1);
+  EXPECT_TRUE(requests.empty());
+}
+
+// Every plan starts on worker 1 and takes as long as its waiting time plus
+// the model id
+struct LsfMockEngine : public MockEngine {
+  LsfMockEngine() : MockEngine({0, 1}) { map[1] = 10; }
+
+  void UpdateWorkersWaiting() const override {}
+  uint64_t GetLatencyEpoch() const override { return latency_epoch; }
+  std::pair<std::vector<SubgraphKey>, int64_t> GetSubgraphWithShortestLatency(
+      const Job& job, const WorkerWaitingTime& worker_waiting) const override {
+    num_searches++;
+    return {{SubgraphKey(job.model_id, 1, {0})},
+            worker_waiting.at(1) + job.model_id};
+  }
+
+  mutable int num_searches = 0;
+  uint64_t latency_epoch = 0;
+};
+
+TEST(LeastSlackFirstSchedulerTest, ReuseExpectedLatency) {
+  LsfMockEngine engine;
+  LeastSlackFirstScheduler scheduler(engine, 500);
+
+  std::deque<Job> requests;
+  const int64_t enqueue_time = time::NowMicros();
+  for (JobId job_id = 0; job_id < 300; job_id++) {
+    Job job(job_id % 2, 1000000);
+    job.job_id = job_id;
+    job.enqueue_time = enqueue_time;
+    requests.push_back(job);
+  }
+
+  // One search per model, while worker 1 is busy
+  scheduler.Schedule(requests);
+  EXPECT_EQ(engine.num_searches, 2);
+  EXPECT_EQ(requests.size(), 300);
+  EXPECT_EQ(requests[0].expected_latency, 10);
+  EXPECT_EQ(requests[1].expected_latency, 11);
+
+  // Nothing changed
+  scheduler.Schedule(requests);
+  EXPECT_EQ(engine.num_searches, 2);
+
+  // Worker 1 takes more work
+  engine.map[1] = 20;
+  scheduler.Schedule(requests);
+  EXPECT_EQ(engine.num_searches, 4);
+  EXPECT_EQ(requests[0].expected_latency, 20);
+
+  // The expected latencies drift
+  engine.latency_epoch++;
+  scheduler.Schedule(requests);
+  EXPECT_EQ(engine.num_searches, 6);
+
+  // Plans of a released model are dropped
+  scheduler.OnModelReleased(0);
+  scheduler.Schedule(requests);
+  EXPECT_EQ(engine.num_searches, 7);
+
+  // Worker 1 becomes idle, and takes the job with the least slack
+  engine.map[1] = 0;
+  scheduler.Schedule(requests);
+  ASSERT_FALSE(engine.action_.empty());
+  EXPECT_EQ(engine.action_[0].first.model_id, 1);
+}
+
+// Each model runs as a whole on any worker, which takes a fixed time per
+// (model, worker)
+struct HeftMockEngine : public MockEngineBase {
+  std::set<WorkerId> GetIdleWorkers() const override {
+    std::set<WorkerId> idle_workers;
+    for (auto& worker_waiting : waiting) {
+      if (worker_waiting.second == 0) {
+        idle_workers.insert(worker_waiting.first);
+      }
+    }
+    return idle_workers;
+  }
+  WorkerWaitingTime GetWorkerWaitingTime() const override { return waiting; }
+  void UpdateWorkersWaiting() const override {}
+  int64_t GetExpected(const SubgraphKey& key) const override {
+    return latencies.at({key.GetModelId(), key.GetWorkerId()});
+  }
+
+  std::pair<std::vector<SubgraphKey>, int64_t> GetSubgraphWithShortestLatency(
+      const Job& job, const WorkerWaitingTime& worker_waiting) const override {
+    std::pair<std::vector<SubgraphKey>, int64_t> best = {{}, -1};
+    for (auto& worker_waiting_time : worker_waiting) {
+      const SubgraphKey key(job.model_id, worker_waiting_time.first, {0});
+      const int64_t latency = worker_waiting_time.second + GetExpected(key);
+      if (best.second == -1 || latency < best.second) {
+        best = {{key}, latency};
+      }
+    }
+    return best;
+  }
+
+  bool EnqueueToWorker(const ScheduleAction& action) override {
+    actions.push_back({action.first.job_id, action.second.GetWorkerId()});
+    waiting[action.second.GetWorkerId()] += GetExpected(action.second);
+    return true;
+  }
+
+  std::map<std::pair<ModelId, WorkerId>, int64_t> latencies;
+  mutable WorkerWaitingTime waiting;
+  // (job id, worker id)
+  std::vector<std::pair<JobId, WorkerId>> actions;
+};
+
+// HEFT that rescans the whole window after every yielded job
+void ScheduleWithFullRescan(HeftMockEngine& engine, JobQueue& requests) {
+  while (!requests.empty()) {
+    std::set<WorkerId> idle_workers = engine.GetIdleWorkers();
+    if (idle_workers.empty()) {
+      return;
+    }
+    WorkerWaitingTime waiting_time = engine.GetWorkerWaitingTime();
+    std::set<JobId> jobs_to_yield;
+    while (true) {
+      int64_t largest_shortest_latency = -1;
+      int target_job_index = -1;
+      SubgraphKey target_key;
+      std::set<ModelId> searched_models;
+      for (int i = 0; i < requests.size(); i++) {
+        if (jobs_to_yield.count(requests[i].job_id) ||
+            !searched_models.insert(requests[i].model_id).second) {
+          continue;
+        }
+        auto best =
+            engine.GetSubgraphWithShortestLatency(requests[i], waiting_time);
+        if (largest_shortest_latency < best.second) {
+          largest_shortest_latency = best.second;
+          target_job_index = i;
+          target_key = best.first.front();
+        }
+      }
+      if (target_job_index < 0) {
+        return;
+      }
+      if (!idle_workers.count(target_key.GetWorkerId())) {
+        waiting_time[target_key.GetWorkerId()] +=
+            engine.GetExpected(target_key);
+        jobs_to_yield.insert(requests[target_job_index].job_id);
+        continue;
+      }
+      engine.EnqueueToWorker({requests[target_job_index], target_key});
+      requests.erase(requests.begin() + target_job_index);
+      break;
+    }
+  }
+}
+
+TEST(HEFTSchedulerTest, SameDecisionsAsFullRescan) {
+  std::mt19937 random(0);
+  for (int round = 0; round < 200; round++) {
+    HeftMockEngine engine;
+    HeftMockEngine reference_engine;
+    const int num_workers = 3;
+    const int num_models = 4;
+    for (WorkerId worker_id = 0; worker_id < num_workers; worker_id++) {
+      engine.waiting[worker_id] = random() % 2 ? 0 : random() % 30;
+      for (ModelId model_id = 0; model_id < num_models; model_id++) {
+        engine.latencies[{model_id, worker_id}] = 1 + random() % 20;
+      }
+    }
+    reference_engine.waiting = engine.waiting;
+    reference_engine.latencies = engine.latencies;
+    JobQueue requests;
+    for (JobId job_id = 0; job_id < 8; job_id++) {
+      Job job(random() % num_models);
+      job.job_id = job_id;
+      requests.push_back(job);
+    }
+
+    JobQueue reference_requests = requests;
+    ScheduleWithFullRescan(reference_engine, reference_requests);
+
+    HEFTScheduler scheduler(engine, requests.size(), false);
+    scheduler.Schedule(requests);
+    EXPECT_EQ(engine.actions, reference_engine.actions) << "round " << round;
+    EXPECT_EQ(requests.size(), reference_requests.size());
+  }
+}
+
 INSTANTIATE_TEST_SUITE_P(
     LSTTests, LSTTestsFixture,
     testing::Values(
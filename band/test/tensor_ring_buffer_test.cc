@@ -0,0 +1,161 @@
+// Copyright 2023 Seoul National University
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "band/tensor_ring_buffer.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "band/tensor.h"
+
+namespace band {
+namespace test {
+
+// A single int32 tensor
+struct IntTensor : public interface::ITensor {
+  DataType GetType() const override { return DataType::kInt32; }
+  void SetType(DataType type) override {}
+  const char* GetData() const override {
+    return reinterpret_cast<const char*>(&value);
+  }
+  char* GetData() override { return reinterpret_cast<char*>(&value); }
+  const int* GetDims() const override { return dims.data(); }
+  size_t GetNumDims() const override { return dims.size(); }
+  void SetDims(const std::vector<int>& dims) override {}
+  const char* GetName() const override { return "int"; }
+  Quantization GetQuantization() const override {
+    return {QuantizationType::kNoQuantization, nullptr};
+  }
+  absl::Status SetQuantization(Quantization quantization) override {
+    return absl::OkStatus();
+  }
+
+  int value = 0;
+  std::vector<int> dims = {1};
+};
+
+int Read(const interface::ITensor* tensor) {
+  return *reinterpret_cast<const int*>(tensor->GetData());
+}
+
+TEST(TensorRingBufferSuite, LeaseWithoutCopy) {
+  TensorRingBuffer buffer({std::make_shared<IntTensor>()}, {0}, 2, 2);
+  IntTensor src;
+  src.value = 7;
+  std::vector<interface::ITensor*> srcs = {&src};
+
+  const int handle = buffer.Alloc().value();
+  EXPECT_TRUE(buffer.PutTensorsToHandle(srcs, handle).ok());
+
+  auto status_or_tensors = buffer.Lease(handle);
+  ASSERT_TRUE(status_or_tensors.ok());
+  ASSERT_EQ(status_or_tensors.value().size(), 1);
+  EXPECT_EQ(Read(status_or_tensors.value()[0]), 7);
+  // The lease keeps the slot after the owner lets it go
+  EXPECT_TRUE(buffer.Release(handle).ok());
+
+  // The leased slot is never reused, so the data stays intact
+  for (int i = 0; i < 4; i++) {
+    auto next_handle = buffer.Alloc();
+    ASSERT_TRUE(next_handle.ok());
+    EXPECT_NE(next_handle.value() % 2, handle % 2);
+    src.value = i;
+    EXPECT_TRUE(buffer.PutTensorsToHandle(srcs, next_handle.value()).ok());
+    EXPECT_TRUE(buffer.Release(next_handle.value()).ok());
+  }
+  EXPECT_EQ(Read(status_or_tensors.value()[0]), 7);
+
+  EXPECT_TRUE(buffer.Release(handle).ok());
+  EXPECT_FALSE(buffer.IsHandleValid(handle));
+}
+
+TEST(TensorRingBufferSuite, AllocFailsWhenAllInUse) {
+  TensorRingBuffer buffer({std::make_shared<IntTensor>()}, {0}, 2, 2);
+  const int first = buffer.Alloc().value();
+  const int second = buffer.Alloc().value();
+  EXPECT_EQ(buffer.Alloc().status().code(),
+            absl::StatusCode::kResourceExhausted);
+  EXPECT_EQ(buffer.GetNumInUse(), 2);
+
+  EXPECT_TRUE(buffer.Release(first).ok());
+  EXPECT_EQ(buffer.GetNumInUse(), 1);
+  EXPECT_FALSE(buffer.Release(first).ok());
+  EXPECT_EQ(buffer.Alloc().value() % 2, first % 2);
+  EXPECT_FALSE(buffer.Alloc().ok());
+  EXPECT_TRUE(buffer.Release(second).ok());
+}
+
+TEST(TensorRingBufferSuite, GrowOnDemand) {
+  TensorRingBuffer buffer({std::make_shared<IntTensor>()}, {0}, 2, 5);
+  EXPECT_EQ(buffer.GetCapacity(), 2);
+
+  std::vector<int> handles;
+  for (int i = 0; i < 5; i++) {
+    auto handle = buffer.Alloc();
+    ASSERT_TRUE(handle.ok());
+    handles.push_back(handle.value());
+  }
+  EXPECT_EQ(buffer.GetCapacity(), 5);
+  EXPECT_EQ(buffer.GetPeakUsage(), 5);
+  EXPECT_FALSE(buffer.Alloc().ok());
+
+  for (int handle : handles) {
+    EXPECT_TRUE(buffer.Release(handle).ok());
+  }
+  // Freed slots are reused before growing
+  EXPECT_TRUE(buffer.Alloc().ok());
+  EXPECT_EQ(buffer.GetCapacity(), 5);
+  EXPECT_EQ(buffer.GetPeakUsage(), 5);
+}
+
+TEST(TensorRingBufferSuite, KeepUnreadSlots) {
+  TensorRingBuffer buffer({std::make_shared<IntTensor>()}, {0}, 2, 2);
+  IntTensor src;
+  src.value = 7;
+  IntTensor dst;
+  std::vector<interface::ITensor*> srcs = {&src};
+  std::vector<interface::ITensor*> dsts = {&dst};
+
+  const int first = buffer.Alloc().value();
+  const int second = buffer.Alloc().value();
+  EXPECT_TRUE(buffer.PutTensorsToHandle(srcs, first).ok());
+
+  // A full pool fails instead of taking over a slot that is not read yet
+  EXPECT_FALSE(buffer.Alloc().ok());
+  EXPECT_TRUE(buffer.GetTensorsFromHandle(dsts, first).ok());
+  EXPECT_EQ(dst.value, 7);
+  // Reading does not free the slot
+  EXPECT_TRUE(buffer.GetTensorsFromHandle(dsts, first).ok());
+
+  EXPECT_TRUE(buffer.Release(first).ok());
+  const int third = buffer.Alloc().value();
+  EXPECT_EQ(third % 2, first % 2);
+  EXPECT_NE(third, first);
+
+  // The handle of a reused slot is stale
+  EXPECT_FALSE(buffer.IsHandleValid(first));
+  EXPECT_FALSE(buffer.GetTensorsFromHandle(dsts, first).ok());
+  EXPECT_FALSE(buffer.Release(first).ok());
+  EXPECT_TRUE(buffer.GetTensorsFromHandle(dsts, second).ok());
+}
+
+}  // namespace test
+}  // namespace band
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
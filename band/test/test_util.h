@@ -66,8 +66,10 @@ struct MockEngineBase : public IEngine {
 
   /* profiler */
   MOCK_METHOD2(UpdateLatency, void(const SubgraphKey&, int64_t));
+  MOCK_METHOD1(ProfileStep, bool(WorkerId));
   MOCK_CONST_METHOD1(GetProfiled, int64_t(const SubgraphKey&));
   MOCK_CONST_METHOD1(GetExpected, int64_t(const SubgraphKey&));
+  MOCK_CONST_METHOD0(GetLatencyEpoch, uint64_t());
 
   /* planner */
   MOCK_METHOD0(Trigger, void());
@@ -86,6 +88,8 @@ struct MockEngineBase : public IEngine {
   /* tensor communication */
   MOCK_METHOD1(TryCopyInputTensors, absl::Status(const Job&));
   MOCK_METHOD1(TryCopyOutputTensors, absl::Status(const Job&));
+  MOCK_METHOD1(ReleaseJobTensors, void(const Job&));
+  MOCK_METHOD1(DiscardOutputTensors, absl::Status(JobId));
 };
 
 }  // namespace test
@@ -17,6 +17,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <future>
 
 #include "band/test/test_util.h"
@@ -88,6 +89,149 @@ TYPED_TEST(WorkerSuite, Wait) {
   worker.End();
 }
 
+TYPED_TEST(WorkerSuite, ProfileWhileIdle) {
+  MockEngine engine;
+  std::promise<void> profiled;
+  EXPECT_CALL(engine, ProfileStep(0))
+      .WillOnce(testing::Return(true))
+      .WillOnce(testing::Invoke([&](WorkerId) {
+        profiled.set_value();
+        return false;
+      }));
+
+  TypeParam worker(&engine, 0, DeviceFlag::kCPU);
+  worker.Start();
+  worker.NotifyPendingProfile();
+  EXPECT_EQ(profiled.get_future().wait_for(std::chrono::seconds(1)),
+            std::future_status::ready);
+  worker.End();
+}
+
+// Worker 0 is slow, and worker 1 runs a stolen job in `thief_latency`
+struct WorkStealEngine : public MockEngine {
+  Worker* GetWorker(WorkerId id) override { return workers[id]; }
+  size_t GetNumWorkers() const override { return workers.size(); }
+  bool HasSubgraph(const SubgraphKey& key) const override { return true; }
+  int64_t GetExpected(const SubgraphKey& key) const override {
+    return key.GetWorkerId() == 0 ? 1000 : thief_latency.load();
+  }
+  int64_t GetProfiled(const SubgraphKey& key) const override {
+    return GetExpected(key);
+  }
+  void EnqueueFinishedJob(Job& job) override {
+    std::lock_guard<std::mutex> lock(mtx);
+    MockEngine::EnqueueFinishedJob(job);
+    finished_jobs[job.job_id] = job;
+  }
+  std::vector<Worker*> workers;
+  std::atomic<int64_t> thief_latency{5000};
+  std::mutex mtx;
+  std::map<JobId, Job> finished_jobs;
+};
+
+TEST(WorkerTest, WorkSteal) {
+  WorkStealEngine engine;
+  DeviceQueueWorker victim(&engine, 0, DeviceFlag::kCPU);
+  DeviceQueueWorker thief(&engine, 1, DeviceFlag::kGPU);
+  engine.workers = {&victim, &thief};
+  thief.AllowWorkSteal();
+
+  // The victim starts last, so its jobs stay queued
+  for (JobId job_id = 0; job_id < 3; job_id++) {
+    Job job = GetEmptyJob();
+    job.job_id = job_id;
+    std::lock_guard<std::mutex> lock(victim.GetDeviceMtx());
+    victim.EnqueueJob(job);
+  }
+
+  auto wait_for = [&thief](std::function<bool(const WorkStealStats&)> pred) {
+    const int64_t deadline = time::NowMicros() + 1000000;
+    while (!pred(thief.GetWorkStealStats()) && time::NowMicros() < deadline) {
+      time::SleepForMicros(100);
+    }
+  };
+
+  thief.Start();
+  Job job = GetEmptyJob();
+  job.job_id = 3;
+  job.subgraph_key = SubgraphKey(0, 1);
+  {
+    std::lock_guard<std::mutex> lock(thief.GetDeviceMtx());
+    thief.EnqueueJob(job);
+  }
+  // Slower than the whole queue of the victim
+  wait_for([](const WorkStealStats& stats) { return stats.num_rejected > 0; });
+  EXPECT_EQ(thief.GetWorkStealStats().num_stolen, 0);
+
+  engine.thief_latency = 10;
+  job.job_id = 4;
+  {
+    std::lock_guard<std::mutex> lock(thief.GetDeviceMtx());
+    thief.EnqueueJob(job);
+  }
+  // Takes all but the front job of the victim
+  wait_for([](const WorkStealStats& stats) { return stats.num_stolen == 2; });
+  thief.Wait();
+  thief.End();
+
+  const WorkStealStats stats = thief.GetWorkStealStats();
+  EXPECT_EQ(stats.num_stolen, 2);
+  EXPECT_EQ(stats.latency_gain_us, (3000 - 10) + (2000 - 10));
+  EXPECT_EQ(victim.GetDeviceRequests().size(), 1);
+  EXPECT_EQ(engine.finished, std::set<int>({1, 2, 3, 4}));
+
+  victim.Start();
+  victim.Wait();
+  victim.End();
+  EXPECT_EQ(engine.finished, std::set<int>({0, 1, 2, 3, 4}));
+}
+
+// An idle worker is woken up to steal once the queue of another worker grows,
+// and the stolen jobs take the latency of the new worker.
+TEST(WorkerTest, IdleWorkerSteals) {
+  WorkStealEngine engine;
+  engine.thief_latency = 10;
+  DeviceQueueWorker victim(&engine, 0, DeviceFlag::kCPU);
+  DeviceQueueWorker thief(&engine, 1, DeviceFlag::kGPU);
+  engine.workers = {&victim, &thief};
+  thief.AllowWorkSteal();
+  thief.Start();
+
+  // The victim is not started, as if it is busy with a long job
+  for (JobId job_id = 0; job_id < 3; job_id++) {
+    Job job = GetEmptyJob();
+    job.job_id = job_id;
+    job.expected_execution_time = 1000;
+    job.profiled_execution_time = 1000;
+    std::lock_guard<std::mutex> lock(victim.GetDeviceMtx());
+    victim.EnqueueJob(job);
+  }
+
+  const int64_t deadline = time::NowMicros() + 1000000;
+  while (thief.GetWorkStealStats().num_stolen < 2 &&
+         time::NowMicros() < deadline) {
+    time::SleepForMicros(100);
+  }
+  thief.Wait();
+  thief.End();
+  EXPECT_EQ(thief.GetWorkStealStats().num_stolen, 2);
+
+  {
+    std::lock_guard<std::mutex> lock(engine.mtx);
+    EXPECT_EQ(engine.finished, std::set<int>({1, 2}));
+    for (JobId job_id : {1, 2}) {
+      const Job& job = engine.finished_jobs[job_id];
+      EXPECT_EQ(job.subgraph_key.GetWorkerId(), 1);
+      EXPECT_EQ(job.expected_execution_time, 10);
+      EXPECT_EQ(job.profiled_execution_time, 10);
+    }
+  }
+
+  victim.Start();
+  victim.Wait();
+  victim.End();
+}
+
 // TODO: throttling test
 }  // namespace test
 }  // namespace band
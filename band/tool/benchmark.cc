@@ -171,6 +171,13 @@ bool Benchmark::LoadBenchmarkConfigs(const Json::Value& root) {
     json::AssignIfValid(model.worker_id, model_json_value, "worker_id");
     json::AssignIfValid(model.slo_us, model_json_value, "slo_us");
     json::AssignIfValid(model.slo_scale, model_json_value, "slo_scale");
+    json::AssignIfValid(model.priority_class, model_json_value,
+                        "priority_class");
+    json::AssignIfValid(model.tenant_id, model_json_value, "tenant_id");
+    json::AssignIfValid(model.batching_config.max_batch_size,
+                        model_json_value, "max_batch_size");
+    json::AssignIfValid(model.batching_config.max_delay_us, model_json_value,
+                        "max_batch_delay_us");
 
     benchmark_config_.model_configs.push_back(model);
   }
@@ -197,6 +204,13 @@ bool tool::Benchmark::LoadRuntimeConfigs(const Json::Value& root) {
     if (root["profile_data_path"].isString()) {
       builder.AddProfileDataPath(root["profile_data_path"].asCString());
     }
+    if (root["profile_background"].isBool()) {
+      builder.AddProfileBackground(root["profile_background"].asBool());
+    }
+    if (root["profile_drift_threshold"].isNumeric()) {
+      builder.AddProfileDriftThreshold(
+          root["profile_drift_threshold"].asFloat());
+    }
   }
 
   // Planner config
@@ -204,6 +218,53 @@ bool tool::Benchmark::LoadRuntimeConfigs(const Json::Value& root) {
     if (root["schedule_window_size"].isInt()) {
       builder.AddScheduleWindowSize(root["schedule_window_size"].asInt());
     }
+    if (root["shedding_policy"].isString()) {
+      builder.AddSheddingPolicy(
+          FromString<SheddingPolicy>(root["shedding_policy"].asCString()));
+    }
+    if (root["max_pending_jobs_per_model"].isInt()) {
+      builder.AddMaxPendingJobsPerModel(
+          root["max_pending_jobs_per_model"].asInt());
+    }
+
+    if (root["priority_arbitration"].isString()) {
+      builder.AddPriorityArbitration(FromString<PriorityArbitration>(
+          root["priority_arbitration"].asCString()));
+    }
+    if (root["priority_weights"].isArray()) {
+      std::vector<int> priority_weights;
+      for (auto weight : root["priority_weights"]) {
+        priority_weights.push_back(weight.asInt());
+      }
+      builder.AddPriorityWeights(priority_weights);
+    }
+    if (root["starvation_timeout_us"].isNumeric()) {
+      builder.AddStarvationTimeout(root["starvation_timeout_us"].asInt64());
+    }
+    if (root["pipeline_depth"].isInt()) {
+      builder.AddPipelineDepth(root["pipeline_depth"].asInt());
+    }
+    if (root["parallel_unit_subgraphs"].isBool()) {
+      builder.AddParallelUnitSubgraphs(
+          root["parallel_unit_subgraphs"].asBool());
+    }
+    if (root["planner_num_shards"].isInt()) {
+      builder.AddPlannerNumShards(root["planner_num_shards"].asInt());
+    }
+    for (auto tenant : root["fair_share"]) {
+      if (!tenant["tenant_id"].isInt()) {
+        BAND_LOG(LogSeverity::kError,
+                 "Please check if `tenant_id` of fair share is given");
+        return false;
+      }
+      FairShareConfig fair_share_config;
+      json::AssignIfValid(fair_share_config.weight, tenant, "weight");
+      json::AssignIfValid(fair_share_config.rate_limit_us, tenant,
+                          "rate_limit_us");
+      json::AssignIfValid(fair_share_config.burst_us, tenant, "burst_us");
+      builder.AddFairShareConfig(tenant["tenant_id"].asInt(),
+                                 fair_share_config);
+    }
 
     std::vector<SchedulerType> schedulers;
     for (auto scheduler : root["schedulers"]) {
@@ -221,6 +282,15 @@ bool tool::Benchmark::LoadRuntimeConfigs(const Json::Value& root) {
           FromString<CPUMaskFlag>(root["cpu_masks"].asCString()));
     }
 
+    if (root["tensor_buffer_initial_size"].isInt()) {
+      builder.AddTensorBufferInitialSize(
+          root["tensor_buffer_initial_size"].asInt());
+    }
+
+    if (root["tensor_buffer_max_size"].isInt()) {
+      builder.AddTensorBufferMaxSize(root["tensor_buffer_max_size"].asInt());
+    }
+
     if (root["log_path"].isString()) {
       builder.AddPlannerLogPath(root["log_path"].asCString());
     }
@@ -327,6 +397,14 @@ absl::Status Benchmark::Initialize(int argc, const char** argv) {
     }
 
     const int model_id = engine->model.GetId();
+    if (benchmark_model.batching_config.max_batch_size > 1) {
+      auto status = engine_->SetBatchingConfig(
+          model_id, benchmark_model.batching_config);
+      if (!status.ok()) {
+        return status;
+      }
+    }
+
     const auto input_indices = engine_->GetInputTensorIndices(model_id);
     const auto output_indices = engine_->GetOutputTensorIndices(model_id);
 
@@ -537,6 +615,8 @@ absl::Status Benchmark::LogResults() {
     PrintLine("Request period (ms)", model_config.period_ms, 2);
     PrintLine("SLO (us)", model_config.slo_us, 2);
     PrintLine("SLO scale", model_config.slo_scale, 2);
+    PrintLine("Max batch size", model_config.batching_config.max_batch_size,
+              2);
   }
 
   auto print_profiler = [](const std::string& prefix,
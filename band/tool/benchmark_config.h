@@ -31,6 +31,9 @@ struct ModelConfig {
   int worker_id = -1;
   int slo_us = -1;
   float slo_scale = -1.f;
+  int priority_class = -1;
+  int tenant_id = -1;
+  BatchingConfig batching_config;
 
   const RequestOption GetRequestOption() const {
     RequestOption option = RequestOption::GetDefaultOption();
@@ -43,6 +46,12 @@ struct ModelConfig {
     if (slo_scale >= 0) {
       option.slo_scale = slo_scale;
     }
+    if (priority_class >= 0) {
+      option.priority_class = priority_class;
+    }
+    if (tenant_id >= 0) {
+      option.tenant_id = tenant_id;
+    }
     return option;
   }
 };
@@ -14,6 +14,8 @@
 
 #include "band/worker.h"
 
+#include <chrono>
+
 #include "absl/strings/str_format.h"
 #include "band/common.h"
 #include "band/job_tracer.h"
@@ -121,6 +123,40 @@ void Worker::Wait() {
   wait_cv_.wait(lock, [&]() { return !HasJob(); });
 }
 
+void Worker::NotifyPendingProfile() {
+  {
+    std::lock_guard<std::mutex> lock(device_mtx_);
+    has_pending_profile_ = true;
+  }
+  request_cv_.notify_all();
+}
+
+void Worker::NotifyWorkSteal() {
+  if (!IsWorkStealAllowed()) {
+    return;
+  }
+  has_work_steal_request_ = true;
+  request_cv_.notify_all();
+}
+
+void Worker::CancelJobs(const std::set<JobId>& job_ids) {
+  std::vector<Job> cancelled_jobs;
+  {
+    std::lock_guard<std::mutex> lock(device_mtx_);
+    cancelled_jobs = RemoveQueuedJobs(job_ids);
+  }
+  if (cancelled_jobs.empty()) {
+    return;
+  }
+
+  wait_cv_.notify_all();
+  for (Job& job : cancelled_jobs) {
+    job.end_time = time::NowMicros();
+    job.status = JobStatus::kCancelled;
+    engine_->EnqueueFinishedJob(job);
+  }
+}
+
 const CpuSet& Worker::GetWorkerThreadAffinity() const { return cpu_set_; }
 
 int Worker::GetNumThreads() const { return num_threads_; }
@@ -167,13 +203,46 @@ void Worker::Work() {
     }
 
     std::unique_lock<std::mutex> lock(device_mtx_);
-    request_cv_.wait(
-        lock, [this]() { return (kill_worker_ || HasJob()) && !is_paused_; });
+    auto is_ready = [this]() {
+      return (kill_worker_ || HasJob() || has_pending_profile_ ||
+              has_work_steal_request_) &&
+             !is_paused_;
+    };
+    if (IsWorkStealAllowed()) {
+      if (!request_cv_.wait_for(
+              lock, std::chrono::milliseconds(kWorkStealCheckIntervalMs),
+              is_ready)) {
+        continue;
+      }
+    } else {
+      request_cv_.wait(lock, is_ready);
+    }
 
     if (kill_worker_) {
       break;
     }
 
+    if (!HasJob() && has_work_steal_request_.exchange(false)) {
+      lock.unlock();
+      TryWorkSteal();
+      continue;
+    }
+
+    if (!HasJob()) {
+      // Profile one invocation at a time, so that a new request waits for
+      // at most a single run
+      has_pending_profile_ = false;
+      lock.unlock();
+      if (!TryUpdateWorkerThread().ok()) {
+        BAND_LOG(LogSeverity::kError, "Worker %d failed to update thread",
+                 worker_id_);
+      }
+      const bool has_pending_profile = engine_->ProfileStep(worker_id_);
+      lock.lock();
+      has_pending_profile_ |= has_pending_profile;
+      continue;
+    }
+
     Job* current_job = GetCurrentJob();
     lock.unlock();
 
@@ -210,10 +279,10 @@ void Worker::Work() {
         // end_time is never read/written by any other thread as long as
         // is_busy == true, so it's safe to update it w/o grabbing the lock
         current_job->end_time = time::NowMicros();
-        engine_->UpdateLatency(
-            subgraph_key, (current_job->end_time - current_job->invoke_time));
-        if (current_job->following_jobs.size() != 0) {
-          engine_->EnqueueBatch(current_job->following_jobs, true);
+        // Latency of a batch does not represent a single request
+        if (current_job->batch_size == 1) {
+          engine_->UpdateLatency(
+              subgraph_key, (current_job->end_time - current_job->invoke_time));
         }
         {
           auto status = engine_->TryCopyOutputTensors(*current_job);
@@ -248,6 +317,7 @@ void Worker::Work() {
     EndEnqueue();
     lock.unlock();
 
+    TryWorkSteal();
     engine_->Trigger();
     BAND_LOG(LogSeverity::kInternal, "Worker %d finished job %d", worker_id_,
              current_job->job_id);
@@ -17,9 +17,11 @@
 #ifndef BAND_WORKER_H_
 #define BAND_WORKER_H_
 
+#include <atomic>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
+#include <set>
 #include <thread>
 
 #include "band/config.h"
@@ -30,6 +32,14 @@ namespace band {
 
 class Planner;
 
+struct WorkStealStats {
+  int64_t num_stolen = 0;
+  // Candidates left to their worker, for no latency gain or a lost race
+  int64_t num_rejected = 0;
+  // Sum of the expected latency saved by the stolen jobs
+  int64_t latency_gain_us = 0;
+};
+
 class Worker {
  public:
   explicit Worker(IEngine* engine, WorkerId worker_id,
@@ -53,6 +63,14 @@ class Worker {
   void Resume();
   // Wait until the end of current requests
   void Wait();
+  // Wake up the worker to run pending background profiles while idle.
+  void NotifyPendingProfile();
+  // Wake up the worker to steal a job from its peers while idle. Does not
+  // take the lock of the worker, so a peer may call it under its own lock.
+  void NotifyWorkSteal();
+  // Drop the queued jobs among `job_ids` and finish them as cancelled. The
+  // job in progress is left to the planner.
+  void CancelJobs(const std::set<JobId>& job_ids);
 
   const CpuSet& GetWorkerThreadAffinity() const;
   int GetNumThreads() const;
@@ -71,6 +89,12 @@ class Worker {
   virtual Job* GetCurrentJob() = 0;
   virtual void EndEnqueue() = 0;
   virtual void HandleDeviceError(Job& current_job) = 0;
+  // Removes the queued jobs that are not started yet.
+  virtual std::vector<Job> RemoveQueuedJobs(const std::set<JobId>& job_ids) = 0;
+  // Called without the lock after a job ends, or while idle once a peer
+  // has jobs to steal.
+  virtual void TryWorkSteal() {}
+  virtual bool IsWorkStealAllowed() const { return false; }
 
   IEngine* const engine_;
 
@@ -82,6 +106,12 @@ class Worker {
   bool kill_worker_ = false;
   bool is_throttling_ = false;
   bool is_paused_ = false;
+  bool has_pending_profile_ = false;
+  // Set without the lock by `NotifyWorkSteal`. The notification may reach
+  // the worker right before it sleeps, so an idle worker that may steal also
+  // checks every `kWorkStealCheckIntervalMs`.
+  std::atomic<bool> has_work_steal_request_{false};
+  static constexpr int kWorkStealCheckIntervalMs = 10;
   int availability_check_interval_ms_;
   WorkerId worker_id_ = -1;
 
@@ -106,17 +136,24 @@ class DeviceQueueWorker : public Worker {
   bool HasJob() override;
   JobQueue& GetDeviceRequests();
   void AllowWorkSteal();
+  WorkStealStats GetWorkStealStats() const;
 
  protected:
   Job* GetCurrentJob() override;
   void EndEnqueue() override;
   void HandleDeviceError(Job& current_job) override;
+  std::vector<Job> RemoveQueuedJobs(const std::set<JobId>& job_ids) override;
+  // Takes the last queued job of another worker once this worker runs out of
+  // jobs, if the job is expected to finish earlier here.
+  void TryWorkSteal() override;
+  bool IsWorkStealAllowed() const override { return allow_work_steal_; }
 
  private:
-  void TryWorkSteal();
-
   JobQueue requests_;
   bool allow_work_steal_ = false;
+  std::atomic<int64_t> num_stolen_{0};
+  std::atomic<int64_t> num_rejected_{0};
+  std::atomic<int64_t> latency_gain_us_{0};
 };
 
 class GlobalQueueWorker : public Worker {
@@ -134,6 +171,7 @@ class GlobalQueueWorker : public Worker {
   Job* GetCurrentJob() override;
   void EndEnqueue() override;
   void HandleDeviceError(Job& current_job) override;
+  std::vector<Job> RemoveQueuedJobs(const std::set<JobId>& job_ids) override;
 
  private:
   Job current_job_{-1};
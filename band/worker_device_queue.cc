@@ -66,6 +66,16 @@ bool DeviceQueueWorker::EnqueueJob(Job& job) {
   }
   requests_.push_back(job);
   request_cv_.notify_one();
+  // Jobs behind the front one can be stolen by idle peers
+  if (requests_.size() >= 2) {
+    for (WorkerId worker_id = 0; worker_id < engine_->GetNumWorkers();
+         worker_id++) {
+      Worker* worker = engine_->GetWorker(worker_id);
+      if (worker_id != worker_id_ && worker != nullptr) {
+        worker->NotifyWorkSteal();
+      }
+    }
+  }
   return true;
 }
 
@@ -73,15 +83,7 @@ Job* DeviceQueueWorker::GetCurrentJob() {
   return HasJob() ? &requests_.front() : nullptr;
 }
 
-void DeviceQueueWorker::EndEnqueue() {
-  requests_.pop_front();
-
-  if (allow_work_steal_ && requests_.empty()) {
-    // TODO: call this function once we re-implement
-    // and test TryWorkSteal()
-    // TryWorkSteal();
-  }
-}
+void DeviceQueueWorker::EndEnqueue() { requests_.pop_front(); }
 
 void DeviceQueueWorker::HandleDeviceError(Job& current_job) {
   std::unique_lock<std::mutex> lock(device_mtx_);
@@ -100,100 +102,136 @@ void DeviceQueueWorker::HandleDeviceError(Job& current_job) {
   lock.unlock();
 }
 
-void DeviceQueueWorker::TryWorkSteal() {
-  // Note: Due to the removal of attribute `Worker::worker_id_`,
-  // `target_worker->GetWorkerId() == worker_id_` should be updated to
-  // `target_worker == this`, and the type of `max_latency_gain_worker` should
-  // be changed from `int` to `Worker*`.
-
-  BAND_NOT_IMPLEMENTED;
-  /*
-    std::shared_ptr<Planner> planner_ptr = planner_.lock();
-    if (!planner_ptr) {
-      TFLITE_LOG(ERROR) << "Worker " << worker_id_
-                        << " TryWorkSteal() Failed to acquire pointer to
-    Planner"; return;
+std::vector<Job> DeviceQueueWorker::RemoveQueuedJobs(
+    const std::set<JobId>& job_ids) {
+  std::vector<Job> removed_jobs;
+  if (requests_.empty()) {
+    return removed_jobs;
+  }
+  // The front job is taken by the worker thread without the lock. Batches
+  // also carry the other requests, so they run and are cancelled per request
+  // on completion.
+  for (auto it = std::next(requests_.begin()); it != requests_.end();) {
+    if (it->batch_size == 1 && job_ids.find(it->job_id) != job_ids.end()) {
+      removed_jobs.push_back(*it);
+      it = requests_.erase(it);
+    } else {
+      ++it;
     }
+  }
+  return removed_jobs;
+}
 
-    Interpreter* interpreter_ptr = planner_ptr->GetModelExecutor();
-    int64_t max_latency_gain = -1;
-    int max_latency_gain_worker = -1;
-    int max_latency_gain_subgraph_idx = -1;
-    for (auto& worker : interpreter_ptr->GetWorkers()) {
-      Worker* target_worker = worker.get();
-      if (target_worker->GetWorkerId() == worker_id_) {
-        continue;
-      }
-
-      int64_t waiting_time = target_worker->GetWaitingTime();
+WorkStealStats DeviceQueueWorker::GetWorkStealStats() const {
+  WorkStealStats stats;
+  stats.num_stolen = num_stolen_;
+  stats.num_rejected = num_rejected_;
+  stats.latency_gain_us = latency_gain_us_;
+  return stats;
+}
 
-      std::unique_lock<std::mutex> lock(target_worker->GetDeviceMtx());
-      if (target_worker->GetDeviceRequests().size() < 2) {
-        // There is nothing to steal here or
-        // the job is being processed by the target worker,
-        // so leave it alone.
-        continue;
-      }
+void DeviceQueueWorker::TryWorkSteal() {
+  if (!allow_work_steal_) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(device_mtx_);
+    if (HasJob() || !IsAvailable()) {
+      return;
+    }
+  }
 
-      Job& job = target_worker->GetDeviceRequests().back();
-      lock.unlock();
+  int64_t max_latency_gain = 0;
+  DeviceQueueWorker* max_latency_gain_worker = nullptr;
+  JobId max_latency_gain_job_id = -1;
+  SubgraphKey max_latency_gain_key;
+  int64_t max_latency_gain_expected = 0;
+  for (WorkerId worker_id = 0; worker_id < engine_->GetNumWorkers();
+       worker_id++) {
+    if (worker_id == worker_id_) {
+      continue;
+    }
+    // The engine creates workers of a single type
+    DeviceQueueWorker* target_worker =
+        static_cast<DeviceQueueWorker*>(engine_->GetWorker(worker_id));
+    if (target_worker == nullptr) {
+      continue;
+    }
 
-      Subgraph* orig_subgraph = interpreter_ptr->subgraph(job.subgraph_idx);
-      SubgraphKey& orig_key = orig_subgraph->GetKey();
-      SubgraphKey new_key(job.model_id, device_flag_, orig_key.input_ops,
-                          orig_key.output_ops);
-      int64_t expected_latency = interpreter_ptr->GetExpectedLatency(new_key);
-      if (expected_latency == -1 || expected_latency > waiting_time) {
-        // no point in stealing this job, it's just going to take longer
+    const int64_t waiting_time = target_worker->GetWaitingTime();
+    Job job(-1);
+    {
+      std::lock_guard<std::mutex> lock(target_worker->GetDeviceMtx());
+      // The front job may be in progress, so leave it alone
+      if (target_worker->requests_.size() < 2) {
         continue;
       }
-
-      int64_t latency_gain = waiting_time - expected_latency;
-      if (latency_gain > max_latency_gain) {
-        max_latency_gain = latency_gain;
-        max_latency_gain_worker = target_worker->GetWorkerId();
-        max_latency_gain_subgraph_idx =
-    interpreter_ptr->GetSubgraphIdx(new_key);
-      }
+      job = target_worker->requests_.back();
     }
-
-    if (max_latency_gain < 0) {
-      // no viable job to steal -- do nothing
-      return;
+    // Batches and jobs pinned to a worker stay where they are
+    if (job.batch_size > 1 || job.target_worker_id != -1) {
+      continue;
     }
 
-    Worker* target_worker =
-    interpreter_ptr->GetWorker(max_latency_gain_worker);
-    std::unique_lock<std::mutex> lock(target_worker->GetDeviceMtx(),
-    std::defer_lock); std::unique_lock<std::mutex> my_lock(device_mtx_,
-    std::defer_lock); std::lock(lock, my_lock);
-
-    if (target_worker->GetDeviceRequests().empty()) {
-      // target worker has went on and finished all of its jobs
-      // while we were slacking off
-      return;
+    const SubgraphKey key(job.subgraph_key.GetModelId(), worker_id_,
+                          job.subgraph_key.GetUnitIndicesSet());
+    if (!engine_->HasSubgraph(key)) {
+      continue;
     }
-
-    // this must not be a reference,
-    // otherwise the pop_back() below will invalidate it
-    Job job = target_worker->GetDeviceRequests().back();
-    if (job.invoke_time > 0) {
-      // make sure the target worker hasn't started processing the job yet
-      return;
+    // The last job finishes after the whole queue of the target worker
+    const int64_t expected = engine_->GetExpected(key);
+    const int64_t latency_gain = waiting_time - expected;
+    if (latency_gain <= 0) {
+      num_rejected_++;
+      continue;
     }
-
-    if (!requests_.empty()) {
-      // make sure that I still don't have any work to do
-      return;
+    if (latency_gain > max_latency_gain) {
+      max_latency_gain = latency_gain;
+      max_latency_gain_worker = target_worker;
+      max_latency_gain_job_id = job.job_id;
+      max_latency_gain_key = key;
+      max_latency_gain_expected = expected;
     }
+  }
+
+  if (max_latency_gain_worker == nullptr) {
+    return;
+  }
+  const int64_t max_latency_gain_profiled =
+      engine_->GetProfiled(max_latency_gain_key);
+
+  std::unique_lock<std::mutex> target_lock(
+      max_latency_gain_worker->GetDeviceMtx(), std::defer_lock);
+  std::unique_lock<std::mutex> lock(device_mtx_, std::defer_lock);
+  std::lock(target_lock, lock);
+
+  // Either worker may have moved on while unlocked
+  JobQueue& target_requests = max_latency_gain_worker->requests_;
+  if (target_requests.size() < 2 ||
+      target_requests.back().job_id != max_latency_gain_job_id ||
+      HasJob() || !IsAvailable()) {
+    num_rejected_++;
+    return;
+  }
 
-    job.subgraph_idx = max_latency_gain_subgraph_idx;
-    job.device_id = device_flag_;
+  // Not a reference, pop_back() below invalidates it
+  Job job = target_requests.back();
+  target_requests.pop_back();
+  // The job runs here, with the latency of this worker
+  job.subgraph_key = max_latency_gain_key;
+  job.expected_execution_time = max_latency_gain_expected;
+  job.profiled_execution_time = max_latency_gain_profiled;
+  requests_.push_back(job);
+  num_stolen_++;
+  latency_gain_us_ += max_latency_gain;
+  lock.unlock();
+  target_lock.unlock();
 
-    // finally, we perform the swap
-    target_worker->GetDeviceRequests().pop_back();
-    requests_.push_back(job);
-  */
+  BAND_LOG(LogSeverity::kInternal,
+           "Worker %d stole job %d from worker %d (gain %lld us)", worker_id_,
+           job.job_id, max_latency_gain_worker->GetId(),
+           static_cast<long long>(max_latency_gain));
+  request_cv_.notify_one();
 }
 
 }  // namespace band
@@ -65,6 +65,12 @@ void GlobalQueueWorker::HandleDeviceError(Job& current_job) {
   lock.unlock();
 }
 
+std::vector<Job> GlobalQueueWorker::RemoveQueuedJobs(
+    const std::set<JobId>& job_ids) {
+  // The only job of the worker is always in progress
+  return {};
+}
+
 // This function returns the remaining time until this worker can start
 // processing another Job.
 //